@@ -0,0 +1,213 @@
+#include "syntheticSchemas.hpp"
+
+#include "protobuf_editor/messageTypeWidget.hpp"
+
+#include <google/protobuf/dynamic_message.h>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLineEdit>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace pb = google::protobuf;
+
+namespace {
+
+// Every allocation made through operator new, which is what the editor's own code and Qt's QObject/QWidget use
+std::atomic<size_t> allocationCount{0};
+std::atomic<size_t> allocatedBytes{0};
+
+constexpr int kEditCount = 1000;
+
+struct AllocationSnapshot {
+  size_t count{allocationCount.load()};
+  size_t bytes{allocatedBytes.load()};
+};
+
+double elapsedMilliseconds(const QElapsedTimer &timer) {
+  return timer.nsecsElapsed() / 1e6;
+}
+
+QJsonObject summarize(std::vector<double> samples) {
+  std::sort(samples.begin(), samples.end());
+  QJsonObject summary;
+  summary["min"] = samples.front();
+  summary["median"] = samples.at(samples.size()/2);
+  summary["max"] = samples.back();
+  return summary;
+}
+
+// Expands every nested message, one level at a time, down to `maxDepth` levels below the root
+void expandAll(protobuf_editor::MessageTypeWidget *root, int maxDepth) {
+  for (int depth=0; depth<maxDepth; ++depth) {
+    bool expandedAny = false;
+    for (protobuf_editor::MessageTypeWidget *widget : root->findChildren<protobuf_editor::MessageTypeWidget*>()) {
+      if (!widget->isExpanded()) {
+        widget->setExpanded(true);
+        expandedAny = true;
+      }
+    }
+    if (!expandedAny) {
+      break;
+    }
+  }
+}
+
+QJsonObject benchmarkSchema(const protobuf_editor::benchmark::SyntheticSchema &schema, pb::DynamicMessageFactory *factory, int repetitions, int expandDepth) {
+  std::unique_ptr<pb::Message> message(factory->GetPrototype(schema.descriptor)->New());
+  protobuf_editor::benchmark::fillMessage(message.get(), expandDepth);
+
+  std::vector<double> constructionSamples, expandSamples, setMessageSamples;
+  QJsonObject counts;
+  for (int repetition=0; repetition<repetitions; ++repetition) {
+    const AllocationSnapshot beforeConstruction;
+    QElapsedTimer timer;
+    timer.start();
+    auto widget = std::make_unique<protobuf_editor::MessageTypeWidget>(schema.descriptor);
+    constructionSamples.push_back(elapsedMilliseconds(timer));
+
+    timer.restart();
+    expandAll(widget.get(), expandDepth);
+    expandSamples.push_back(elapsedMilliseconds(timer));
+    const AllocationSnapshot afterConstruction;
+
+    timer.restart();
+    widget->setMessage(message.get());
+    setMessageSamples.push_back(elapsedMilliseconds(timer));
+
+    if (repetition == 0) {
+      // The same on every repetition, no need to walk the widget tree again
+      const qsizetype fieldWidgetCount = widget->findChildren<protobuf_editor::ProtobufFieldWidget*>().size();
+      const qsizetype objectCount = widget->findChildren<QObject*>().size() + 1;
+      const double perField = (fieldWidgetCount > 0 ? 1.0/fieldWidgetCount : 0.0);
+      counts["field_widgets"] = static_cast<qint64>(fieldWidgetCount);
+      counts["qobjects"] = static_cast<qint64>(objectCount);
+      counts["qobjects_per_field"] = objectCount * perField;
+      counts["heap_allocations"] = static_cast<qint64>(afterConstruction.count - beforeConstruction.count);
+      counts["heap_allocations_per_field"] = (afterConstruction.count - beforeConstruction.count) * perField;
+      counts["heap_bytes"] = static_cast<qint64>(afterConstruction.bytes - beforeConstruction.bytes);
+      counts["heap_bytes_per_field"] = (afterConstruction.bytes - beforeConstruction.bytes) * perField;
+    }
+  }
+
+  QJsonObject result;
+  result["schema"] = QString::fromStdString(schema.name);
+  result["message_type"] = QString::fromStdString(schema.descriptor->full_name());
+  result["top_level_fields"] = schema.descriptor->field_count();
+  result["construction_ms"] = summarize(constructionSamples);
+  result["expand_ms"] = summarize(expandSamples);
+  result["set_message_ms"] = summarize(setMessageSamples);
+  result["counts"] = counts;
+
+  // A user typing into a line edit: each keystroke parses the text, writes it to the message and reports the change
+  protobuf_editor::MessageTypeWidget widget(schema.descriptor);
+  expandAll(&widget, expandDepth);
+  widget.setMessage(message.get());
+  QLineEdit *lineEdit = widget.findChild<QLineEdit*>();
+  if (lineEdit == nullptr) {
+    result["edit_us"] = QJsonValue::Null;
+  } else {
+    QElapsedTimer timer;
+    timer.start();
+    for (int edit=0; edit<kEditCount; ++edit) {
+      lineEdit->setText(edit % 2 == 0 ? QStringLiteral("12") : QStringLiteral("21"));
+    }
+    result["edit_us"] = timer.nsecsElapsed() / 1e3 / kEditCount;
+  }
+  return result;
+}
+
+} // anonymous namespace
+
+void* operator new(std::size_t size) {
+  ++allocationCount;
+  allocatedBytes += size;
+  if (void *pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+int main(int argc, char *argv[]) {
+  // No display is needed, or wanted, for measuring
+  if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  }
+  QApplication application(argc, argv);
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Measures how long the protobuf editor widgets take to build, populate and edit, and writes the results as JSON.");
+  parser.addHelpOption();
+  const QCommandLineOption outputOption("output", "Write the results to <file> instead of stdout.", "file");
+  const QCommandLineOption repetitionsOption("repetitions", "Measure each schema <count> times.", "count", "5");
+  const QCommandLineOption expandDepthOption("expand-depth", "Expand nested messages <depth> levels deep.", "depth", "4");
+  const QCommandLineOption wideFieldsOption("wide-fields", "Number of fields in the wide message.", "count", "1000");
+  parser.addOptions({outputOption, repetitionsOption, expandDepthOption, wideFieldsOption});
+  parser.process(application);
+
+  const int repetitions = std::max(1, parser.value(repetitionsOption).toInt());
+  const int expandDepth = std::max(0, parser.value(expandDepthOption).toInt());
+  protobuf_editor::benchmark::SyntheticSchemaOptions schemaOptions;
+  schemaOptions.wideFieldCount = std::max(1, parser.value(wideFieldsOption).toInt());
+
+  pb::DescriptorPool pool;
+  const std::vector<protobuf_editor::benchmark::SyntheticSchema> schemas = protobuf_editor::benchmark::buildSyntheticSchemas(&pool, schemaOptions);
+  pb::DynamicMessageFactory factory(&pool);
+
+  QJsonArray results;
+  for (const protobuf_editor::benchmark::SyntheticSchema &schema : schemas) {
+    results.append(benchmarkSchema(schema, &factory, repetitions, expandDepth));
+  }
+
+  QJsonObject report;
+  report["qt_version"] = QString(qVersion());
+  report["platform"] = QApplication::platformName();
+  report["repetitions"] = repetitions;
+  report["expand_depth"] = expandDepth;
+  report["results"] = results;
+  const QByteArray json = QJsonDocument(report).toJson();
+
+  if (!parser.isSet(outputOption)) {
+    std::cout << json.toStdString();
+    return 0;
+  }
+  QFile outputFile(parser.value(outputOption));
+  if (!outputFile.open(QIODevice::WriteOnly)) {
+    std::cerr << "Failed to open " << outputFile.fileName().toStdString() << " for writing" << std::endl;
+    return 1;
+  }
+  outputFile.write(json);
+  return 0;
+}
\ No newline at end of file
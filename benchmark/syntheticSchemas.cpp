@@ -0,0 +1,193 @@
+#include "syntheticSchemas.hpp"
+
+#include <google/protobuf/descriptor.pb.h>
+
+#include <stdexcept>
+
+namespace pb = google::protobuf;
+
+namespace {
+
+constexpr char kPackage[] = "protobuf_editor.benchmark";
+constexpr int kElementsPerRepeatedField = 3;
+
+pb::FieldDescriptorProto* addField(pb::DescriptorProto *message, const std::string &name, pb::FieldDescriptorProto::Type type, const std::string &typeName="") {
+  pb::FieldDescriptorProto *field = message->add_field();
+  field->set_name(name);
+  field->set_number(message->field_size());
+  field->set_label(pb::FieldDescriptorProto::LABEL_OPTIONAL);
+  field->set_type(type);
+  if (!typeName.empty()) {
+    field->set_type_name(std::string(".")+kPackage+"."+typeName);
+  }
+  return field;
+}
+
+// Gives the field explicit presence, like the "optional" keyword in a .proto file
+void makeProto3Optional(pb::DescriptorProto *message, pb::FieldDescriptorProto *field) {
+  message->add_oneof_decl()->set_name("_"+field->name());
+  field->set_oneof_index(message->oneof_decl_size()-1);
+  field->set_proto3_optional(true);
+}
+
+void addEnum(pb::FileDescriptorProto *file, const std::string &name, int valueCount) {
+  pb::EnumDescriptorProto *enumProto = file->add_enum_type();
+  enumProto->set_name(name);
+  for (int valueIndex=0; valueIndex<valueCount; ++valueIndex) {
+    pb::EnumValueDescriptorProto *value = enumProto->add_value();
+    // Enum values are scoped to the file, so they need to be unique across enums
+    value->set_name(name+"_VALUE_"+std::to_string(valueIndex));
+    value->set_number(valueIndex);
+  }
+}
+
+void addWideMessage(pb::FileDescriptorProto *file, int fieldCount) {
+  // Every built-in type, one after the other, with every fourth field optional
+  constexpr pb::FieldDescriptorProto::Type kTypes[] = {
+    pb::FieldDescriptorProto::TYPE_INT32,
+    pb::FieldDescriptorProto::TYPE_INT64,
+    pb::FieldDescriptorProto::TYPE_UINT32,
+    pb::FieldDescriptorProto::TYPE_UINT64,
+    pb::FieldDescriptorProto::TYPE_FLOAT,
+    pb::FieldDescriptorProto::TYPE_DOUBLE,
+    pb::FieldDescriptorProto::TYPE_BOOL,
+    pb::FieldDescriptorProto::TYPE_STRING,
+    pb::FieldDescriptorProto::TYPE_ENUM
+  };
+  constexpr int kTypeCount = sizeof(kTypes)/sizeof(kTypes[0]);
+  addEnum(file, "SmallEnum", 4);
+  pb::DescriptorProto *message = file->add_message_type();
+  message->set_name("Wide");
+  for (int fieldIndex=0; fieldIndex<fieldCount; ++fieldIndex) {
+    const pb::FieldDescriptorProto::Type type = kTypes[fieldIndex % kTypeCount];
+    pb::FieldDescriptorProto *field = addField(message, "field_"+std::to_string(fieldIndex), type, type == pb::FieldDescriptorProto::TYPE_ENUM ? "SmallEnum" : "");
+    if (fieldIndex % 4 == 3) {
+      makeProto3Optional(message, field);
+    }
+  }
+}
+
+void addDeepMessage(pb::FileDescriptorProto *file, int levelCount) {
+  // Deep0 { Deep1 child; ... } down to the last level, which has no child
+  for (int level=0; level<levelCount; ++level) {
+    pb::DescriptorProto *message = file->add_message_type();
+    message->set_name("Deep"+std::to_string(level));
+    addField(message, "value", pb::FieldDescriptorProto::TYPE_INT32);
+    addField(message, "name", pb::FieldDescriptorProto::TYPE_STRING);
+    if (level+1 < levelCount) {
+      addField(message, "child", pb::FieldDescriptorProto::TYPE_MESSAGE, "Deep"+std::to_string(level+1));
+    }
+  }
+}
+
+void addEnumHeavyMessage(pb::FileDescriptorProto *file, int fieldCount, int valueCount) {
+  addEnum(file, "BigEnum", valueCount);
+  pb::DescriptorProto *message = file->add_message_type();
+  message->set_name("EnumHeavy");
+  for (int fieldIndex=0; fieldIndex<fieldCount; ++fieldIndex) {
+    addField(message, "enum_"+std::to_string(fieldIndex), pb::FieldDescriptorProto::TYPE_ENUM, "BigEnum");
+  }
+}
+
+void addRecursiveMessage(pb::FileDescriptorProto *file) {
+  pb::DescriptorProto *message = file->add_message_type();
+  message->set_name("Node");
+  addField(message, "value", pb::FieldDescriptorProto::TYPE_INT32);
+  addField(message, "label", pb::FieldDescriptorProto::TYPE_STRING);
+  makeProto3Optional(message, addField(message, "left", pb::FieldDescriptorProto::TYPE_MESSAGE, "Node"));
+  makeProto3Optional(message, addField(message, "right", pb::FieldDescriptorProto::TYPE_MESSAGE, "Node"));
+  addField(message, "children", pb::FieldDescriptorProto::TYPE_MESSAGE, "Node")->set_label(pb::FieldDescriptorProto::LABEL_REPEATED);
+}
+
+void setValue(pb::Message *message, const pb::FieldDescriptor *fieldDescriptor, int seed) {
+  const pb::Reflection *reflection = message->GetReflection();
+  const bool repeated = fieldDescriptor->is_repeated();
+  switch (fieldDescriptor->cpp_type()) {
+    case pb::FieldDescriptor::CppType::CPPTYPE_STRING:
+      repeated ? reflection->AddString(message, fieldDescriptor, "value "+std::to_string(seed)) : reflection->SetString(message, fieldDescriptor, "value "+std::to_string(seed));
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_FLOAT:
+      repeated ? reflection->AddFloat(message, fieldDescriptor, seed+0.5f) : reflection->SetFloat(message, fieldDescriptor, seed+0.5f);
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_DOUBLE:
+      repeated ? reflection->AddDouble(message, fieldDescriptor, seed+0.25) : reflection->SetDouble(message, fieldDescriptor, seed+0.25);
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT32:
+      repeated ? reflection->AddInt32(message, fieldDescriptor, -seed) : reflection->SetInt32(message, fieldDescriptor, -seed);
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT32:
+      repeated ? reflection->AddUInt32(message, fieldDescriptor, seed) : reflection->SetUInt32(message, fieldDescriptor, seed);
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT64:
+      repeated ? reflection->AddInt64(message, fieldDescriptor, -seed) : reflection->SetInt64(message, fieldDescriptor, -seed);
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT64:
+      repeated ? reflection->AddUInt64(message, fieldDescriptor, seed) : reflection->SetUInt64(message, fieldDescriptor, seed);
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_BOOL:
+      repeated ? reflection->AddBool(message, fieldDescriptor, seed % 2 == 0) : reflection->SetBool(message, fieldDescriptor, seed % 2 == 0);
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_ENUM: {
+      const pb::EnumDescriptor *enumDescriptor = fieldDescriptor->enum_type();
+      const int number = enumDescriptor->value(seed % enumDescriptor->value_count())->number();
+      repeated ? reflection->AddEnumValue(message, fieldDescriptor, number) : reflection->SetEnumValue(message, fieldDescriptor, number);
+      break;
+    }
+    case pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE:
+      throw std::runtime_error("Messages are filled recursively");
+  }
+}
+
+} // anonymous namespace
+
+namespace protobuf_editor::benchmark {
+
+std::vector<SyntheticSchema> buildSyntheticSchemas(pb::DescriptorPool *pool, const SyntheticSchemaOptions &options) {
+  pb::FileDescriptorProto file;
+  file.set_name("protobuf_editor_benchmark.proto");
+  file.set_package(kPackage);
+  file.set_syntax("proto3");
+  addWideMessage(&file, options.wideFieldCount);
+  addDeepMessage(&file, options.deepLevelCount);
+  addEnumHeavyMessage(&file, options.enumFieldCount, options.enumValueCount);
+  addRecursiveMessage(&file);
+
+  const pb::FileDescriptor *fileDescriptor = pool->BuildFile(file);
+  if (fileDescriptor == nullptr) {
+    throw std::runtime_error("Failed to build the synthetic schemas");
+  }
+  const std::string prefix = std::string(kPackage)+".";
+  return {
+    {"wide", pool->FindMessageTypeByName(prefix+"Wide")},
+    {"deep", pool->FindMessageTypeByName(prefix+"Deep0")},
+    {"enum_heavy", pool->FindMessageTypeByName(prefix+"EnumHeavy")},
+    {"recursive", pool->FindMessageTypeByName(prefix+"Node")}
+  };
+}
+
+void fillMessage(pb::Message *message, int maxDepth) {
+  const pb::Descriptor *descriptor = message->GetDescriptor();
+  const pb::Reflection *reflection = message->GetReflection();
+  for (int fieldIndex=0; fieldIndex<descriptor->field_count(); ++fieldIndex) {
+    const pb::FieldDescriptor *fieldDescriptor = descriptor->field(fieldIndex);
+    if (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE) {
+      if (maxDepth <= 0) {
+        continue;
+      }
+      if (fieldDescriptor->is_repeated()) {
+        for (int element=0; element<kElementsPerRepeatedField; ++element) {
+          fillMessage(reflection->AddMessage(message, fieldDescriptor), maxDepth-1);
+        }
+      } else {
+        fillMessage(reflection->MutableMessage(message, fieldDescriptor), maxDepth-1);
+      }
+      continue;
+    }
+    const int elementCount = (fieldDescriptor->is_repeated() ? kElementsPerRepeatedField : 1);
+    for (int element=0; element<elementCount; ++element) {
+      setValue(message, fieldDescriptor, fieldIndex+element+1);
+    }
+  }
+}
+
+} // namespace protobuf_editor::benchmark
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef PROTOBUF_EDITOR_BENCHMARK_SYNTHETIC_SCHEMAS_HPP_
+#define PROTOBUF_EDITOR_BENCHMARK_SYNTHETIC_SCHEMAS_HPP_
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+
+#include <string>
+#include <vector>
+
+namespace protobuf_editor::benchmark {
+
+struct SyntheticSchemaOptions {
+  // Number of fields in the "wide" message, which cycles through every built-in type
+  int wideFieldCount{1000};
+  // Number of levels of nested messages in the "deep" message
+  int deepLevelCount{32};
+  // Number of enum fields, and values per enum, in the "enum_heavy" message
+  int enumFieldCount{200};
+  int enumValueCount{256};
+};
+
+struct SyntheticSchema {
+  std::string name;
+  const google::protobuf::Descriptor *descriptor{nullptr};
+};
+
+// Builds message types which each stress a different part of the editor: "wide", "deep", "enum_heavy" and
+//  "recursive". The descriptors are owned by `pool`.
+std::vector<SyntheticSchema> buildSyntheticSchemas(google::protobuf::DescriptorPool *pool, const SyntheticSchemaOptions &options);
+
+// Gives every field a non-default value, so that populating an editor has something to show. Nested messages are only
+//  filled `maxDepth` levels deep, which keeps recursive types finite.
+void fillMessage(google::protobuf::Message *message, int maxDepth);
+
+} // namespace protobuf_editor::benchmark
+
+#endif // PROTOBUF_EDITOR_BENCHMARK_SYNTHETIC_SCHEMAS_HPP_
@@ -1,10 +1,160 @@
 #include "mainwindow.h"
+#include "proto/test.pb.h"
+#include "protobuf_editor/batchEdit.hpp"
+#include "protobuf_editor/dynamicSchema.hpp"
+#include "protobuf_editor/instrumentation.hpp"
+#include "protobuf_editor/protobufEditor.hpp"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+namespace {
+
+std::vector<std::string> toStdStrings(const QStringList &strings) {
+  std::vector<std::string> result;
+  for (const QString &string : strings) {
+    result.push_back(string.toStdString());
+  }
+  return result;
+}
+
+// Batch mode runs without a display, so this has to be known before the application object is created
+bool isBatchMode(int argc, char *argv[]) {
+  for (int argumentIndex=1; argumentIndex<argc; ++argumentIndex) {
+    if (std::strcmp(argv[argumentIndex], "--batch") == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int runBatch(const google::protobuf::Message &prototype, const QStringList &editExpressions, const QStringList &paths, const protobuf_editor::BatchEditOptions &options) {
+  if (editExpressions.isEmpty() || paths.isEmpty()) {
+    std::cerr << "--batch needs at least one --edit and at least one file" << std::endl;
+    return 1;
+  }
+  // Every edit is checked against the message type before any file is touched
+  std::vector<protobuf_editor::BatchEdit> edits;
+  try {
+    for (const QString &expression : editExpressions) {
+      edits.push_back(protobuf_editor::BatchEdit::parse(prototype, expression.toStdString()));
+    }
+  } catch (const std::exception &ex) {
+    std::cerr << ex.what() << std::endl;
+    return 1;
+  }
+
+  const protobuf_editor::BatchEditReport report = protobuf_editor::runBatchEdit(prototype, edits, paths, options, [&paths](int filesDone){
+    std::cerr << "\r" << filesDone << "/" << paths.size() << " files" << std::flush;
+  });
+  std::cerr << std::endl;
+  for (const protobuf_editor::BatchEditFailure &failure : report.failures) {
+    std::cerr << failure.path.toStdString() << ": " << failure.error.toStdString() << std::endl;
+  }
+  const double seconds = std::max<qint64>(report.elapsedMilliseconds, 1)/1000.0;
+  std::cout << "Edited " << report.fileCount-report.failures.size() << " of " << report.fileCount << " files in " << seconds << " s: "
+            << report.fileCount/seconds << " files/s, " << report.bytesRead/seconds/(1 << 20) << " MiB/s read, "
+            << report.bytesWritten/seconds/(1 << 20) << " MiB/s written" << std::endl;
+  return (report.failures.empty() ? 0 : 1);
+}
+
+} // anonymous namespace
 
 int main(int argc, char *argv[]) {
-  QApplication a(argc, argv);
+  const bool batchMode = isBatchMode(argc, argv);
+  std::unique_ptr<QCoreApplication> application;
+  if (batchMode) {
+    application = std::make_unique<QCoreApplication>(argc, argv);
+  } else {
+    application = std::make_unique<QApplication>(argc, argv);
+  }
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Edits protobuf messages. Without any options, the message type which is compiled into the application is edited.");
+  parser.addHelpOption();
+  const QCommandLineOption protoOption("proto", "Load the message types in <file>, and everything it imports. Can be given more than once.", "file");
+  const QCommandLineOption protoPathOption(QStringList{"I", "proto-path"}, "Look for .proto files and their imports in <dir>. Can be given more than once.", "dir");
+  const QCommandLineOption descriptorSetOption("descriptor-set", "Load the message types in a serialized FileDescriptorSet <file>, as written by protoc --include_imports --descriptor_set_out.", "file");
+  const QCommandLineOption messageOption("message", "The fully qualified name of the message type to edit.", "type");
+  const QCommandLineOption noCacheOption("no-schema-cache", "Always parse the .proto files, rather than using descriptors cached by a previous run.");
+  const QCommandLineOption logLevelOption("log-level", "Log messages of at least <level>: debug, info, warning or error. Defaults to warning.", "level");
+  const QCommandLineOption batchOption("batch", "Apply the --edit expressions to every <file> and write them back in place, without opening a window.");
+  const QCommandLineOption editOption("edit", "In batch mode, an edit to make to every file: \"path=value\", \"path+=delta\" or \"-path\" to clear. Can be given more than once, edits are made in order.", "expression");
+  const QCommandLineOption threadsOption("threads", "In batch mode, the number of files to work on at once. Defaults to one per core.", "count");
+  const QCommandLineOption maxInFlightOption("max-in-flight-mb", "In batch mode, how many megabytes of files may be worked on at once. Defaults to 256.", "megabytes");
+  parser.addOptions({protoOption, protoPathOption, descriptorSetOption, messageOption, noCacheOption, logLevelOption, batchOption, editOption, threadsOption, maxInFlightOption});
+  parser.addPositionalArgument("files", "In batch mode, the message files to edit. The format of each is guessed from its extension.", "[files...]");
+  parser.process(*application);
+
+  // Must outlive the window, which edits messages of its types
+  std::unique_ptr<protobuf_editor::DynamicSchema> schema;
+  try {
+    if (parser.isSet(logLevelOption)) {
+      protobuf_editor::setLogLevel(protobuf_editor::parseLogLevel(parser.value(logLevelOption)));
+    }
+    if (parser.isSet(protoOption)) {
+      QStringList importPaths = parser.values(protoPathOption);
+      if (importPaths.isEmpty()) {
+        importPaths.append(QDir::currentPath());
+      }
+      QString cacheDirectory;
+      if (!parser.isSet(noCacheOption)) {
+        cacheDirectory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/schemas";
+      }
+      schema = protobuf_editor::DynamicSchema::fromProtoFiles(toStdStrings(parser.values(protoOption)), toStdStrings(importPaths), cacheDirectory.toStdString());
+    } else if (parser.isSet(descriptorSetOption)) {
+      schema = protobuf_editor::DynamicSchema::fromDescriptorSetFile(parser.value(descriptorSetOption).toStdString());
+    }
+    if (schema != nullptr && !parser.isSet(messageOption)) {
+      throw std::runtime_error("--message is required along with --proto or --descriptor-set");
+    }
+  } catch (const std::exception &ex) {
+    std::cerr << ex.what() << std::endl;
+    return 1;
+  }
+
+  if (batchMode) {
+    const google::protobuf::Message *prototype = &proto::test::Test::default_instance();
+    protobuf_editor::BatchEditOptions options;
+    try {
+      if (schema != nullptr) {
+        prototype = schema->prototype(schema->findMessageType(parser.value(messageOption).toStdString()));
+      }
+      bool success = true;
+      if (parser.isSet(threadsOption)) {
+        options.threadCount = parser.value(threadsOption).toInt(&success);
+      }
+      if (success && parser.isSet(maxInFlightOption)) {
+        options.maxBytesInFlight = parser.value(maxInFlightOption).toLongLong(&success) << 20;
+      }
+      if (!success || options.threadCount < 0 || options.maxBytesInFlight <= 0) {
+        throw std::runtime_error("--threads and --max-in-flight-mb must be positive numbers");
+      }
+    } catch (const std::exception &ex) {
+      std::cerr << ex.what() << std::endl;
+      return 1;
+    }
+    return runBatch(*prototype, parser.values(editOption), parser.positionalArguments(), options);
+  }
+
   MainWindow w;
+  if (schema != nullptr) {
+    try {
+      const google::protobuf::Descriptor *descriptor = schema->findMessageType(parser.value(messageOption).toStdString());
+      w.protobufEditor()->setMessageType(*schema->prototype(descriptor));
+    } catch (const std::exception &ex) {
+      std::cerr << ex.what() << std::endl;
+      return 1;
+    }
+  }
   w.show();
-  return a.exec();
+  return application->exec();
 }
@@ -1,11 +1,251 @@
 #include "mainwindow.h"
 #include "./ui_mainwindow.h"
+#include "protobuf_editor/diffView.hpp"
+#include "protobuf_editor/editHistory.hpp"
+#ifdef PROTOBUF_EDITOR_INSTRUMENTATION
+#include "protobuf_editor/instrumentationPanel.hpp"
+#endif
+#include "protobuf_editor/liveTailWidget.hpp"
+#include "protobuf_editor/messageFile.hpp"
+#include "protobuf_editor/recordBrowser.hpp"
+#include "protobuf_editor/recordGrid.hpp"
+#include "protobuf_editor/recordLog.hpp"
+
+#include <QFileDialog>
+#include <QInputDialog>
+#include <QMenu>
+#include <QMessageBox>
+
+namespace {
+
+constexpr int kProgressBarRange = 1000;
+
+// The format is picked from the extension, see messageFormatForPath
+QString fileFilters() {
+  return MainWindow::tr("Binary protobuf (*.pb *.bin *.binpb);;Text format (*.txtpb *.textproto *.pbtxt *.txt);;JSON (*.json);;All files (*)");
+}
+
+} // anonymous namespace
 
 MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWindow) {
   ui->setupUi(this);
+  buildFileMenu();
+  buildEditMenu();
+#ifdef PROTOBUF_EDITOR_INSTRUMENTATION
+  buildDebugMenu();
+#endif
+
+  // Shows how far along a file which is being opened or saved is
+  progressBar_ = new QProgressBar;
+  progressBar_->setRange(0, kProgressBarRange);
+  progressBar_->setVisible(false);
+  ui->statusbar->addPermanentWidget(progressBar_);
+
+  connect(ui->widget, &ProtobufEditor::fileProgress, [this](qint64 bytesProcessed, qint64 bytesTotal){
+    if (bytesTotal <= 0) {
+      // Unknown size, show that something is happening
+      progressBar_->setRange(0, 0);
+      return;
+    }
+    progressBar_->setRange(0, kProgressBarRange);
+    progressBar_->setValue(static_cast<int>(bytesProcessed * kProgressBarRange / bytesTotal));
+  });
+  connect(ui->widget, &ProtobufEditor::fileOperationFinished, [this](const QString &path, bool success, const QString &errorString){
+    progressBar_->setVisible(false);
+    if (!success) {
+      ui->statusbar->clearMessage();
+      QMessageBox::warning(this, windowTitle(), errorString);
+      return;
+    }
+    currentPath_ = path;
+    ui->statusbar->showMessage(tr("Finished with %1").arg(path));
+  });
 }
 
 MainWindow::~MainWindow() {
   delete ui;
 }
 
+ProtobufEditor* MainWindow::protobufEditor() const {
+  return ui->widget;
+}
+
+void MainWindow::buildFileMenu() {
+  QMenu *fileMenu = ui->menubar->addMenu(tr("&File"));
+  QAction *newAction = fileMenu->addAction(tr("&New"), this, &MainWindow::newMessage);
+  newAction->setShortcut(QKeySequence::New);
+  QAction *openAction = fileMenu->addAction(tr("&Open..."), this, &MainWindow::open);
+  openAction->setShortcut(QKeySequence::Open);
+  QAction *saveAction = fileMenu->addAction(tr("&Save"), this, &MainWindow::save);
+  saveAction->setShortcut(QKeySequence::Save);
+  QAction *saveAsAction = fileMenu->addAction(tr("Save &As..."), this, &MainWindow::saveAs);
+  saveAsAction->setShortcut(QKeySequence::SaveAs);
+  fileMenu->addSeparator();
+  fileMenu->addAction(tr("&Compare With..."), this, &MainWindow::compareWith);
+  fileMenu->addAction(tr("Open &Record Log..."), this, &MainWindow::openRecordLog);
+  fileMenu->addAction(tr("Open Record Log as &Grid..."), this, &MainWindow::openRecordGrid);
+  fileMenu->addAction(tr("&Tail File..."), this, &MainWindow::tailFile);
+  fileMenu->addAction(tr("Tail Local &Socket..."), this, &MainWindow::tailLocalSocket);
+}
+
+void MainWindow::buildEditMenu() {
+  QMenu *editMenu = ui->menubar->addMenu(tr("&Edit"));
+  QAction *undoAction = editMenu->addAction(tr("&Undo"), ui->widget, &ProtobufEditor::undo);
+  undoAction->setShortcut(QKeySequence::Undo);
+  QAction *redoAction = editMenu->addAction(tr("&Redo"), ui->widget, &ProtobufEditor::redo);
+  redoAction->setShortcut(QKeySequence::Redo);
+  protobuf_editor::EditHistory *editHistory = ui->widget->editHistory();
+  auto updateActions = [undoAction, redoAction, editHistory]{
+    undoAction->setEnabled(editHistory->canUndo());
+    redoAction->setEnabled(editHistory->canRedo());
+  };
+  connect(editHistory, &protobuf_editor::EditHistory::changed, this, updateActions);
+  updateActions();
+}
+
+#ifdef PROTOBUF_EDITOR_INSTRUMENTATION
+void MainWindow::buildDebugMenu() {
+  QMenu *debugMenu = ui->menubar->addMenu(tr("&Debug"));
+  debugMenu->addAction(tr("&Instrumentation..."), this, [this]{
+    protobuf_editor::InstrumentationPanel *panel = new protobuf_editor::InstrumentationPanel;
+    panel->setAttribute(Qt::WA_DeleteOnClose);
+    panel->setWindowTitle(tr("Instrumentation"));
+    panel->resize(size());
+    panel->show();
+  });
+}
+#endif
+
+void MainWindow::newMessage() {
+  if (ui->widget->clearMessage()) {
+    currentPath_.clear();
+    ui->statusbar->clearMessage();
+  }
+}
+
+void MainWindow::open() {
+  const QString path = QFileDialog::getOpenFileName(this, tr("Open Message"), currentPath_, fileFilters());
+  if (path.isEmpty()) {
+    return;
+  }
+  if (ui->widget->openFile(path)) {
+    progressBar_->setValue(0);
+    progressBar_->setVisible(true);
+    ui->statusbar->showMessage(tr("Opening %1").arg(path));
+  }
+}
+
+void MainWindow::save() {
+  if (currentPath_.isEmpty()) {
+    saveAs();
+    return;
+  }
+  if (ui->widget->saveFile(currentPath_)) {
+    progressBar_->setValue(0);
+    progressBar_->setVisible(true);
+    ui->statusbar->showMessage(tr("Saving %1").arg(currentPath_));
+  }
+}
+
+void MainWindow::saveAs() {
+  const QString path = QFileDialog::getSaveFileName(this, tr("Save Message"), currentPath_, fileFilters());
+  if (path.isEmpty()) {
+    return;
+  }
+  if (ui->widget->saveFile(path)) {
+    progressBar_->setValue(0);
+    progressBar_->setVisible(true);
+    ui->statusbar->showMessage(tr("Saving %1").arg(path));
+  }
+}
+
+void MainWindow::compareWith() {
+  const QString path = QFileDialog::getOpenFileName(this, tr("Compare With"), currentPath_, fileFilters());
+  if (path.isEmpty()) {
+    return;
+  }
+  // The message being edited is on the left, the file on the right. The file is read as the type being edited.
+  const google::protobuf::Message &current = *ui->widget->message();
+  std::unique_ptr<google::protobuf::Message> lhs(current.New());
+  lhs->CopyFrom(current);
+  std::unique_ptr<google::protobuf::Message> rhs(current.New());
+  try {
+    protobuf_editor::readMessageFile(path, protobuf_editor::messageFormatForPath(path), rhs.get());
+  } catch (const std::exception &ex) {
+    QMessageBox::warning(this, windowTitle(), QString::fromStdString(ex.what()));
+    return;
+  }
+  protobuf_editor::DiffView *diffView = new protobuf_editor::DiffView;
+  diffView->setMessages(std::move(lhs), std::move(rhs));
+  diffView->setAttribute(Qt::WA_DeleteOnClose);
+  diffView->setWindowTitle(tr("Differences from %1").arg(path));
+  diffView->resize(size());
+  diffView->show();
+}
+
+void MainWindow::openRecordLog() {
+  const QString path = QFileDialog::getOpenFileName(this, tr("Open Record Log"), currentPath_, tr("Length-delimited records (*.pbl *.pbs *.log *.bin);;All files (*)"));
+  if (path.isEmpty()) {
+    return;
+  }
+  // The records are of the type currently being edited
+  std::unique_ptr<protobuf_editor::RecordLog> log;
+  try {
+    log = std::make_unique<protobuf_editor::RecordLog>(path, *ui->widget->message());
+  } catch (const std::exception &ex) {
+    QMessageBox::warning(this, windowTitle(), QString::fromStdString(ex.what()));
+    return;
+  }
+  protobuf_editor::RecordBrowser *browser = new protobuf_editor::RecordBrowser(std::move(log));
+  browser->setAttribute(Qt::WA_DeleteOnClose);
+  browser->setWindowTitle(path);
+  browser->resize(size());
+  browser->show();
+}
+
+void MainWindow::openRecordGrid() {
+  const QString path = QFileDialog::getOpenFileName(this, tr("Open Record Log as Grid"), currentPath_, tr("Length-delimited records (*.pbl *.pbs *.log *.bin);;All files (*)"));
+  if (path.isEmpty()) {
+    return;
+  }
+  // The records are of the type currently being edited
+  std::unique_ptr<protobuf_editor::RecordLog> log;
+  try {
+    log = std::make_unique<protobuf_editor::RecordLog>(path, *ui->widget->message());
+  } catch (const std::exception &ex) {
+    QMessageBox::warning(this, windowTitle(), QString::fromStdString(ex.what()));
+    return;
+  }
+  protobuf_editor::RecordGrid *grid = new protobuf_editor::RecordGrid(std::move(log));
+  grid->setAttribute(Qt::WA_DeleteOnClose);
+  grid->setWindowTitle(path);
+  grid->resize(size());
+  grid->show();
+}
+
+void MainWindow::tailFile() {
+  const QString path = QFileDialog::getOpenFileName(this, tr("Tail File"), currentPath_, tr("Length-delimited records (*.pbl *.pbs *.log *.bin);;All files (*)"));
+  if (path.isEmpty()) {
+    return;
+  }
+  showLiveTail(protobuf_editor::LiveTail::Source::kFile, path);
+}
+
+void MainWindow::tailLocalSocket() {
+  const QString name = QInputDialog::getText(this, tr("Tail Local Socket"), tr("Server name or socket path:"));
+  if (name.isEmpty()) {
+    return;
+  }
+  showLiveTail(protobuf_editor::LiveTail::Source::kLocalSocket, name);
+}
+
+void MainWindow::showLiveTail(protobuf_editor::LiveTail::Source source, const QString &path) {
+  // The messages are of the type currently being edited
+  const google::protobuf::Message &prototype = *ui->widget->message();
+  auto tail = std::make_unique<protobuf_editor::LiveTail>(source, path, prototype);
+  protobuf_editor::LiveTailWidget *tailWidget = new protobuf_editor::LiveTailWidget(std::move(tail), prototype);
+  tailWidget->setAttribute(Qt::WA_DeleteOnClose);
+  tailWidget->setWindowTitle(tr("Tail of %1").arg(path));
+  tailWidget->resize(size());
+  tailWidget->show();
+}
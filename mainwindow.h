@@ -2,6 +2,11 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include <QProgressBar>
+
+#include "protobuf_editor/liveTail.hpp"
+
+class ProtobufEditor;
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -16,7 +21,26 @@ class MainWindow : public QMainWindow {
 public:
   MainWindow(QWidget *parent=nullptr);
   ~MainWindow();
+  ProtobufEditor* protobufEditor() const;
 private:
   Ui::MainWindow *ui;
+  QProgressBar *progressBar_{nullptr};
+  // The file which was last opened or saved, where Save writes to
+  QString currentPath_;
+  void buildFileMenu();
+  void buildEditMenu();
+#ifdef PROTOBUF_EDITOR_INSTRUMENTATION
+  void buildDebugMenu();
+#endif
+  void newMessage();
+  void open();
+  void save();
+  void saveAs();
+  void compareWith();
+  void openRecordLog();
+  void openRecordGrid();
+  void tailFile();
+  void tailLocalSocket();
+  void showLiveTail(protobuf_editor::LiveTail::Source source, const QString &path);
 };
 #endif // MAINWINDOW_H
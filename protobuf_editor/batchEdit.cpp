@@ -0,0 +1,272 @@
+#include "batchEdit.hpp"
+#include "fieldValue.hpp"
+#include "instrumentation.hpp"
+#include "messageFile.hpp"
+
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+namespace pb = google::protobuf;
+
+namespace {
+
+// How often the progress callback is called
+constexpr int kProgressIntervalMilliseconds = 1000;
+// The in-flight budget is counted in blocks of this many bytes, so that it fits in a QSemaphore
+constexpr qint64 kBudgetUnitBytes = 1024;
+
+std::string trimmed(const std::string &string) {
+  const size_t begin = string.find_first_not_of(" \t");
+  if (begin == std::string::npos) {
+    return std::string();
+  }
+  const size_t end = string.find_last_not_of(" \t");
+  return string.substr(begin, end-begin+1);
+}
+
+bool isIntegral(const pb::FieldDescriptor *fieldDescriptor) {
+  switch (fieldDescriptor->cpp_type()) {
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT32:
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT32:
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT64:
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT64:
+    case pb::FieldDescriptor::CppType::CPPTYPE_ENUM:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Adds `delta` to an integral value, throwing if the result doesn't fit the field
+QVariant addToIntegral(const pb::FieldDescriptor *fieldDescriptor, const QVariant &value, qint64 delta) {
+  if (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_UINT64) {
+    const quint64 current = value.toULongLong();
+    const quint64 magnitude = (delta < 0 ? 0-static_cast<quint64>(delta) : static_cast<quint64>(delta));
+    if ((delta < 0 && magnitude > current) || (delta >= 0 && magnitude > std::numeric_limits<quint64>::max()-current)) {
+      throw std::runtime_error("\""+fieldDescriptor->name()+"\" would be out of range");
+    }
+    return static_cast<qulonglong>(delta < 0 ? current-magnitude : current+magnitude);
+  }
+  qint64 minimum = std::numeric_limits<qint64>::min();
+  qint64 maximum = std::numeric_limits<qint64>::max();
+  if (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_UINT32) {
+    minimum = 0;
+    maximum = std::numeric_limits<quint32>::max();
+  } else if (fieldDescriptor->cpp_type() != pb::FieldDescriptor::CppType::CPPTYPE_INT64) {
+    minimum = std::numeric_limits<qint32>::min();
+    maximum = std::numeric_limits<qint32>::max();
+  }
+  const qint64 current = value.toLongLong();
+  if ((delta < 0 && current < minimum-delta) || (delta > 0 && current > maximum-delta)) {
+    throw std::runtime_error("\""+fieldDescriptor->name()+"\" would be out of range");
+  }
+  return static_cast<qlonglong>(current+delta);
+}
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+BatchEdit BatchEdit::parse(const pb::Message &prototype, const std::string &expression) {
+  BatchEdit edit;
+  edit.expression_ = expression;
+  std::string pathString;
+  std::string valueString;
+  const std::string trimmedExpression = trimmed(expression);
+  size_t separator;
+  if (!trimmedExpression.empty() && trimmedExpression.front() == '-') {
+    edit.operation_ = Operation::kClear;
+    pathString = trimmed(trimmedExpression.substr(1));
+  } else if ((separator = trimmedExpression.find("+=")) != std::string::npos) {
+    edit.operation_ = Operation::kAdd;
+    pathString = trimmed(trimmedExpression.substr(0, separator));
+    valueString = trimmed(trimmedExpression.substr(separator+2));
+  } else if ((separator = trimmedExpression.find('=')) != std::string::npos) {
+    edit.operation_ = Operation::kSet;
+    pathString = trimmed(trimmedExpression.substr(0, separator));
+    valueString = trimmed(trimmedExpression.substr(separator+1));
+  } else {
+    throw std::runtime_error("Edit \""+expression+"\" is not of the form \"path=value\", \"path+=delta\" or \"-path\"");
+  }
+
+  edit.path_ = FieldPath::parse(prototype.GetDescriptor(), pathString);
+  const pb::FieldDescriptor *fieldDescriptor = edit.path_.back().fieldDescriptor;
+  const int index = edit.path_.back().index;
+  if (edit.operation_ == Operation::kClear) {
+    if (index != -1) {
+      throw std::runtime_error("Edit \""+expression+"\" clears a single element, only whole fields can be cleared");
+    }
+    return edit;
+  }
+  if (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE) {
+    throw std::runtime_error("Edit \""+expression+"\" writes to a message, which can only be cleared");
+  }
+  if (fieldDescriptor->is_repeated() && index == -1) {
+    throw std::runtime_error("Edit \""+expression+"\" writes to a whole repeated field, give the index of an element");
+  }
+
+  if (edit.operation_ == Operation::kAdd) {
+    bool success = false;
+    if (isIntegral(fieldDescriptor)) {
+      edit.integerDelta_ = QString::fromStdString(valueString).toLongLong(&success);
+    } else if (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_FLOAT || fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_DOUBLE) {
+      edit.floatingPointDelta_ = QString::fromStdString(valueString).toDouble(&success);
+    } else {
+      throw std::runtime_error("Edit \""+expression+"\" adds to \""+fieldDescriptor->name()+"\", which is not a number or an enum");
+    }
+    if (!success) {
+      throw std::runtime_error("Edit \""+expression+"\" has an invalid delta \""+valueString+"\"");
+    }
+    return edit;
+  }
+
+  // Convert the value once, by writing it to a message of the type which contains the field and reading it back
+  QVariant value = QString::fromStdString(valueString);
+  if (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_STRING) {
+    if (valueString.size() >= 2 && valueString.front() == '"' && valueString.back() == '"') {
+      value = QString::fromStdString(valueString.substr(1, valueString.size()-2));
+    }
+  } else if (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_ENUM) {
+    const pb::EnumValueDescriptor *enumValueDescriptor = fieldDescriptor->enum_type()->FindValueByName(valueString);
+    if (enumValueDescriptor != nullptr) {
+      value = enumValueDescriptor->number();
+    }
+  } else if (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_BOOL) {
+    // QVariant takes anything other than "false" and "0" to be true
+    if (valueString != "true" && valueString != "false" && valueString != "1" && valueString != "0") {
+      throw std::runtime_error("Edit \""+expression+"\" has an invalid value \""+valueString+"\" for \""+fieldDescriptor->name()+"\"");
+    }
+  }
+  const pb::Message *containingPrototype = prototype.GetReflection()->GetMessageFactory()->GetPrototype(fieldDescriptor->containing_type());
+  std::unique_ptr<pb::Message> scratch(containingPrototype->New());
+  const int scratchIndex = (fieldDescriptor->is_repeated() ? 0 : -1);
+  if (fieldDescriptor->is_repeated()) {
+    appendDefaultFieldValue(scratch.get(), fieldDescriptor);
+  }
+  if (!writeFieldValue(scratch.get(), fieldDescriptor, value, scratchIndex)) {
+    throw std::runtime_error("Edit \""+expression+"\" has an invalid value \""+valueString+"\" for \""+fieldDescriptor->name()+"\"");
+  }
+  edit.value_ = readFieldValue(*scratch, fieldDescriptor, scratchIndex);
+  return edit;
+}
+
+void BatchEdit::apply(pb::Message *message) const {
+  const pb::FieldDescriptor *fieldDescriptor = path_.back().fieldDescriptor;
+  const int index = path_.back().index;
+  if (operation_ == Operation::kClear) {
+    if (path_.resolveContainingMessage(*message) == nullptr) {
+      // Something along the way isn't there, so neither is the field
+      return;
+    }
+    pb::Message *containingMessage = path_.resolveMutableContainingMessage(message);
+    containingMessage->GetReflection()->ClearField(containingMessage, fieldDescriptor);
+    return;
+  }
+
+  pb::Message *containingMessage = path_.resolveMutableContainingMessage(message);
+  if (index != -1 && index >= containingMessage->GetReflection()->FieldSize(*containingMessage, fieldDescriptor)) {
+    throw std::runtime_error("\""+path_.toString()+"\" does not exist");
+  }
+  QVariant value = value_;
+  if (operation_ == Operation::kAdd) {
+    const QVariant current = readFieldValue(*containingMessage, fieldDescriptor, index);
+    if (isIntegral(fieldDescriptor)) {
+      value = addToIntegral(fieldDescriptor, current, integerDelta_);
+    } else {
+      value = current.toDouble()+floatingPointDelta_;
+    }
+  }
+  if (!writeFieldValue(containingMessage, fieldDescriptor, value, index)) {
+    // Only an enum value which isn't defined gets here, everything else was checked already
+    throw std::runtime_error("\""+path_.toString()+"\" can't be set to "+value.toString().toStdString());
+  }
+}
+
+const std::string& BatchEdit::expression() const {
+  return expression_;
+}
+
+BatchEditReport runBatchEdit(const pb::Message &prototype, const std::vector<BatchEdit> &edits, const QStringList &paths, const BatchEditOptions &options, const BatchEditProgressCallback &progress) {
+  PROTOBUF_EDITOR_TIME_SCOPE("runBatchEdit");
+  QElapsedTimer timer;
+  timer.start();
+  BatchEditReport report;
+  report.fileCount = paths.size();
+
+  // Every file gets its own slot, so workers never need to lock to record what happened
+  std::vector<QString> errors(paths.size());
+  std::atomic<int> nextFile{0};
+  std::atomic<int> filesDone{0};
+  std::atomic<qint64> bytesRead{0};
+  std::atomic<qint64> bytesWritten{0};
+  const int budgetUnits = static_cast<int>(std::clamp<qint64>(options.maxBytesInFlight/kBudgetUnitBytes, 1, std::numeric_limits<int>::max()));
+  QSemaphore budget(budgetUnits);
+
+  auto work = [&]{
+    // Reused for every file this worker takes, so the allocations of one file are still around for the next
+    std::unique_ptr<pb::Message> message(prototype.New());
+    for (int fileIndex=nextFile++; fileIndex<paths.size(); fileIndex=nextFile++) {
+      const QString &path = paths.at(fileIndex);
+      const qint64 fileSize = QFileInfo(path).size();
+      // Wait until enough of the files which are being worked on are done. A file larger than the whole budget waits
+      //  for all of them.
+      const int units = static_cast<int>(std::clamp<qint64>((fileSize+kBudgetUnitBytes-1)/kBudgetUnitBytes, 1, budgetUnits));
+      budget.acquire(units);
+      try {
+        const MessageFormat format = messageFormatForPath(path);
+        message->Clear();
+        readMessageFile(path, format, message.get());
+        bytesRead += fileSize;
+        for (const BatchEdit &edit : edits) {
+          try {
+            edit.apply(message.get());
+          } catch (const std::exception &ex) {
+            throw std::runtime_error("Edit \""+edit.expression()+"\": "+ex.what());
+          }
+        }
+        writeMessageFile(path, format, *message);
+        bytesWritten += QFileInfo(path).size();
+      } catch (const std::exception &ex) {
+        errors[fileIndex] = QString::fromStdString(ex.what());
+      }
+      budget.release(units);
+      ++filesDone;
+    }
+  };
+
+  const int threadCount = std::min(options.threadCount > 0 ? options.threadCount : QThread::idealThreadCount(), std::max<int>(paths.size(), 1));
+  QThreadPool pool;
+  pool.setMaxThreadCount(threadCount);
+  for (int threadIndex=0; threadIndex<threadCount; ++threadIndex) {
+    pool.start(work);
+  }
+  while (!pool.waitForDone(kProgressIntervalMilliseconds)) {
+    if (progress) {
+      progress(filesDone);
+    }
+  }
+  if (progress) {
+    progress(filesDone);
+  }
+
+  for (int fileIndex=0; fileIndex<paths.size(); ++fileIndex) {
+    if (!errors[fileIndex].isEmpty()) {
+      report.failures.push_back({paths.at(fileIndex), errors[fileIndex]});
+    }
+  }
+  report.bytesRead = bytesRead;
+  report.bytesWritten = bytesWritten;
+  report.elapsedMilliseconds = timer.elapsed();
+  return report;
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
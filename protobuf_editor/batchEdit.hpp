@@ -0,0 +1,86 @@
+#ifndef PROTOBUF_EDITOR_BATCH_EDIT_HPP_
+#define PROTOBUF_EDITOR_BATCH_EDIT_HPP_
+
+#include "fieldPath.hpp"
+
+#include <google/protobuf/message.h>
+
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace protobuf_editor {
+
+// One change to make to every message of a batch. It's resolved against the message type once, when it's parsed, so
+//  applying it to a message only walks the path and writes the value.
+class BatchEdit {
+public:
+  // Parses an edit expression:
+  //  "path=value" sets a field. Enums can be given by name or number. Surrounding double quotes are stripped from
+  //    string values, so that an empty string can be written as "".
+  //  "path+=delta" adds to a numeric field, or moves an enum to the value with the resulting number. A negative delta
+  //    subtracts.
+  //  "-path" clears a field, or a whole nested message.
+  // Only single fields can be set, so repeated fields need an element index, e.g. "rpt_nested[3].data=4". Throws if
+  //  the path doesn't name a field of `prototype`'s type, or the value doesn't fit the field.
+  static BatchEdit parse(const google::protobuf::Message &prototype, const std::string &expression);
+  // Throws if the edit can't be made to this message, e.g. because the repeated element it names doesn't exist or
+  //  the result is out of the field's range. The message may have been partially modified.
+  void apply(google::protobuf::Message *message) const;
+  const std::string& expression() const;
+private:
+  enum class Operation {
+    kSet,
+    kAdd,
+    kClear
+  };
+  BatchEdit() = default;
+  std::string expression_;
+  Operation operation_{Operation::kSet};
+  FieldPath path_;
+  // Already converted to the field's type, as readFieldValue returns it
+  QVariant value_;
+  // Whichever matches the field's type
+  qint64 integerDelta_{0};
+  double floatingPointDelta_{0};
+};
+
+struct BatchEditOptions {
+  // 0 for one per core
+  int threadCount{0};
+  // How many bytes of input may be being worked on at once. Each file counts with its size on disk, a file which is
+  //  larger than this on its own is worked on by itself.
+  qint64 maxBytesInFlight{256 << 20};
+};
+
+struct BatchEditFailure {
+  QString path;
+  QString error;
+};
+
+struct BatchEditReport {
+  int fileCount{0};
+  // In the order of the paths which were given
+  std::vector<BatchEditFailure> failures;
+  qint64 bytesRead{0};
+  qint64 bytesWritten{0};
+  qint64 elapsedMilliseconds{0};
+};
+
+// Called with the number of files which have been finished so far
+using BatchEditProgressCallback = std::function<void(int filesDone)>;
+
+// Reads each file, in the format guessed from its extension, applies every edit in order, and writes the file back
+//  in place, on a pool of worker threads. Workers take the next file as soon as they finish one, so a few large
+//  files don't hold up the rest. A file which fails to read, edit or write is left untouched and reported, the other
+//  files are still processed. Blocks until every file is done, calling `progress` from the calling thread every now
+//  and then.
+BatchEditReport runBatchEdit(const google::protobuf::Message &prototype, const std::vector<BatchEdit> &edits, const QStringList &paths, const BatchEditOptions &options=BatchEditOptions(), const BatchEditProgressCallback &progress=nullptr);
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_BATCH_EDIT_HPP_
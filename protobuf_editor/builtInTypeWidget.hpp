@@ -1,12 +1,17 @@
 #ifndef PROTOBUF_EDITOR_BUILT_IN_TYPE_WIDGET_HPP_
 #define PROTOBUF_EDITOR_BUILT_IN_TYPE_WIDGET_HPP_
 
+#include "fieldHandler.hpp"
 #include "protobufFieldWidget.hpp"
 
 #include <google/protobuf/message.h>
 
+#include <QCheckBox>
+#include <QLabel>
 #include <QWidget>
 
+#include <memory>
+
 namespace protobuf_editor {
 
 class BuiltInTypeWidget : public ProtobufFieldWidget {
@@ -15,10 +20,21 @@ public:
   explicit BuiltInTypeWidget(const google::protobuf::FieldDescriptor *fieldDescriptor, QWidget *parent=nullptr);
 private:
   QWidget *labelWidget_{nullptr};
+  // Only set when the field is optional, in which case it is also the label widget
+  QCheckBox *labelCheckBox_{nullptr};
   QWidget *dataWidget_{nullptr};
+  // Created the first time the sizes are shown
+  QLabel *byteSizeLabel_{nullptr};
+  std::unique_ptr<FieldHandler> fieldHandler_;
+  // Whether the text in the data widget doesn't parse, in which case it's shown in red and the message still holds
+  //  the last value which did
+  bool parseFailed_{false};
 
   void buildWidget();
+  void onDataEdited();
+  void setParseFailed(bool parseFailed);
   void setDataFromMessage() override;
+  void updateSizeOverlay() override;
 };
 
 } // namespace protobuf_editor
@@ -0,0 +1,41 @@
+#include "changeNotifier.hpp"
+
+namespace protobuf_editor {
+
+ChangeNotifier::ChangeNotifier(QObject *parent) : QObject(parent) {
+  timer_.setSingleShot(true);
+  connect(&timer_, &QTimer::timeout, this, &ChangeNotifier::flush);
+}
+
+ChangeNotifier::Mode ChangeNotifier::mode() const {
+  return mode_;
+}
+
+void ChangeNotifier::setMode(Mode mode, int debounceMilliseconds) {
+  // Don't lose anything which was collected under the previous mode
+  flush();
+  mode_ = mode;
+  timer_.setInterval(debounceMilliseconds);
+}
+
+void ChangeNotifier::fieldChanged(const FieldPath &path) {
+  if (mode_ == Mode::kImmediate) {
+    emit fieldsChanged({path});
+    return;
+  }
+  pendingPaths_.insert(path);
+  // (Re)starting the timer means that a burst of edits, like typing, is reported once it's over
+  timer_.start();
+}
+
+void ChangeNotifier::flush() {
+  timer_.stop();
+  if (pendingPaths_.empty()) {
+    return;
+  }
+  std::vector<FieldPath> paths(pendingPaths_.begin(), pendingPaths_.end());
+  pendingPaths_.clear();
+  emit fieldsChanged(paths);
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
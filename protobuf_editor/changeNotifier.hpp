@@ -0,0 +1,41 @@
+#ifndef PROTOBUF_EDITOR_CHANGE_NOTIFIER_HPP_
+#define PROTOBUF_EDITOR_CHANGE_NOTIFIER_HPP_
+
+#include "fieldPath.hpp"
+
+#include <QObject>
+#include <QTimer>
+
+#include <set>
+#include <vector>
+
+namespace protobuf_editor {
+
+// Collects the paths of fields which were edited and reports them.
+// In immediate mode, every change is reported as soon as it happens. In batched mode, changes are coalesced and
+//  reported together once no further change has been made for the debounce interval. A debounce interval of 0
+//  reports everything which changed during one iteration of the event loop.
+class ChangeNotifier : public QObject {
+  Q_OBJECT
+public:
+  enum class Mode {
+    kImmediate,
+    kBatched
+  };
+  explicit ChangeNotifier(QObject *parent=nullptr);
+  Mode mode() const;
+  void setMode(Mode mode, int debounceMilliseconds=0);
+  void fieldChanged(const FieldPath &path);
+  // Immediately reports any pending changes
+  void flush();
+private:
+  Mode mode_{Mode::kImmediate};
+  QTimer timer_;
+  std::set<FieldPath> pendingPaths_;
+signals:
+  void fieldsChanged(const std::vector<protobuf_editor::FieldPath> &paths);
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_CHANGE_NOTIFIER_HPP_
@@ -0,0 +1,79 @@
+#include "descriptorLayout.hpp"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace pb = google::protobuf;
+
+namespace {
+
+protobuf_editor::FieldLayout buildFieldLayout(const pb::FieldDescriptor *fieldDescriptor);
+
+std::unique_ptr<protobuf_editor::MessageLayout> buildMessageLayout(const pb::Descriptor *descriptor) {
+  auto layout = std::make_unique<protobuf_editor::MessageLayout>();
+  layout->fields.reserve(descriptor->field_count());
+  for (int fieldIndex=0; fieldIndex<descriptor->field_count(); ++fieldIndex) {
+    layout->fields.push_back(buildFieldLayout(descriptor->field(fieldIndex)));
+  }
+  return layout;
+}
+
+protobuf_editor::FieldLayout buildFieldLayout(const pb::FieldDescriptor *fieldDescriptor) {
+  using Kind = protobuf_editor::FieldLayout::Kind;
+  protobuf_editor::FieldLayout layout;
+  layout.fieldDescriptor = fieldDescriptor;
+  layout.label = QString::fromStdString(fieldDescriptor->full_name());
+
+  // Unhandled types are skipped for now. Map is also "repeated", so it must be checked first.
+  if (fieldDescriptor->real_containing_oneof() != nullptr) {
+    layout.kind = Kind::kOneof;
+  } else if (fieldDescriptor->is_map()) {
+    layout.kind = Kind::kMap;
+  } else if (fieldDescriptor->type() == pb::FieldDescriptor::Type::TYPE_GROUP) {
+    layout.kind = Kind::kSkipped;
+    layout.skipReason = "group";
+  } else if (fieldDescriptor->is_repeated()) {
+    layout.kind = Kind::kRepeated;
+  } else if (fieldDescriptor->type() == pb::FieldDescriptor::Type::TYPE_MESSAGE) {
+    layout.kind = Kind::kMessage;
+  } else {
+    layout.kind = Kind::kBuiltIn;
+  }
+
+  if (fieldDescriptor->type() == pb::FieldDescriptor::Type::TYPE_ENUM) {
+    const pb::EnumDescriptor *enumDescriptor = fieldDescriptor->enum_type();
+    layout.enumNumbers.reserve(enumDescriptor->value_count());
+    for (int enumValueIndex=0; enumValueIndex<enumDescriptor->value_count(); ++enumValueIndex) {
+      const pb::EnumValueDescriptor *enumValueDescriptor = enumDescriptor->value(enumValueIndex);
+      layout.enumNames.append(QString::fromStdString(enumValueDescriptor->name()));
+      layout.enumNumbers.push_back(enumValueDescriptor->number());
+    }
+  }
+  return layout;
+}
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+const MessageLayout& messageLayout(const pb::Descriptor *descriptor) {
+  static std::mutex mutex;
+  // Layouts are held by pointer so that references to them stay valid as the map grows
+  static std::unordered_map<const pb::Descriptor*, std::unique_ptr<MessageLayout>> layouts;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::unique_ptr<MessageLayout> &layout = layouts[descriptor];
+  if (layout == nullptr) {
+    // Only this message's own fields are computed. Nested message types get their own entry once a widget for them
+    //  is built, which keeps this bounded for recursive types.
+    layout = buildMessageLayout(descriptor);
+  }
+  return *layout;
+}
+
+const FieldLayout& fieldLayout(const pb::FieldDescriptor *fieldDescriptor) {
+  return messageLayout(fieldDescriptor->containing_type()).fields.at(fieldDescriptor->index());
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef PROTOBUF_EDITOR_DESCRIPTOR_LAYOUT_HPP_
+#define PROTOBUF_EDITOR_DESCRIPTOR_LAYOUT_HPP_
+
+#include <google/protobuf/descriptor.h>
+
+#include <QString>
+#include <QStringList>
+
+#include <vector>
+
+namespace protobuf_editor {
+
+// Everything the editor widgets need to know about a field in order to build themselves, so that the descriptor
+//  doesn't need to be walked, and its strings converted, every time another editor for the same type is opened
+struct FieldLayout {
+  enum class Kind {
+    kBuiltIn,
+    kMessage,
+    kRepeated,
+    kMap,
+    // A member of a oneof, edited by the oneof's widget along with the other members
+    kOneof,
+    // A type of field which is not yet supported, see `skipReason`
+    kSkipped
+  };
+  const google::protobuf::FieldDescriptor *fieldDescriptor{nullptr};
+  Kind kind{Kind::kSkipped};
+  // The field's full name
+  QString label;
+  // e.g. "group", only set for skipped fields
+  const char *skipReason{nullptr};
+  // The names and numbers of the enum's values in declaration order, only set for enum fields
+  QStringList enumNames;
+  std::vector<int> enumNumbers;
+};
+
+struct MessageLayout {
+  // Indexed the same as the descriptor's fields
+  std::vector<FieldLayout> fields;
+};
+
+// Returns the layout of a message type, which is computed the first time the type is seen and then shared by the
+//  whole process. Safe to call from any thread. Layouts are never freed, so the pool which owns the descriptor must
+//  outlive every editor which uses it.
+const MessageLayout& messageLayout(const google::protobuf::Descriptor *descriptor);
+// Shorthand for the entry of the field in its containing message's layout
+const FieldLayout& fieldLayout(const google::protobuf::FieldDescriptor *fieldDescriptor);
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_DESCRIPTOR_LAYOUT_HPP_
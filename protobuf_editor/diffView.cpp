@@ -0,0 +1,330 @@
+#include "diffView.hpp"
+#include "fieldValue.hpp"
+#include "messageTypeWidget.hpp"
+
+#include <QBrush>
+#include <QHeaderView>
+#include <QPointer>
+#include <QSplitter>
+#include <QTimer>
+#include <QVBoxLayout>
+
+#include <set>
+#include <stdexcept>
+
+namespace pb = google::protobuf;
+
+namespace {
+
+enum Column {
+  kFieldColumn = 0,
+  kLhsColumn,
+  kRhsColumn,
+  kColumnCount
+};
+
+// Longer values, such as whole messages which were added, are cut short in the tree
+constexpr int kMaximumValueLength = 200;
+
+QString elided(const QString &text) {
+  if (text.size() <= kMaximumValueLength) {
+    return text;
+  }
+  return text.left(kMaximumValueLength) + QStringLiteral("…");
+}
+
+// Appends `message` to `text` on a single line. Stops soon after the text is longer than kMaximumValueLength, so a
+//  large message costs no more than a small one.
+void appendMessageText(const pb::Message &message, QString &text) {
+  const pb::Reflection *reflection = message.GetReflection();
+  const pb::Descriptor *descriptor = message.GetDescriptor();
+  text += QStringLiteral("{ ");
+  for (int fieldIndex=0; fieldIndex<descriptor->field_count() && text.size()<=kMaximumValueLength; ++fieldIndex) {
+    const pb::FieldDescriptor *fieldDescriptor = descriptor->field(fieldIndex);
+    const bool repeated = fieldDescriptor->is_repeated();
+    const int count = (repeated ? reflection->FieldSize(message, fieldDescriptor) : (reflection->HasField(message, fieldDescriptor) ? 1 : 0));
+    for (int index=0; index<count && text.size()<=kMaximumValueLength; ++index) {
+      text += QString::fromStdString(fieldDescriptor->name()) + QStringLiteral(": ");
+      if (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE) {
+        appendMessageText(repeated ? reflection->GetRepeatedMessage(message, fieldDescriptor, index) : reflection->GetMessage(message, fieldDescriptor), text);
+      } else {
+        text += fieldValueToString(fieldDescriptor, readFieldValue(message, fieldDescriptor, repeated ? index : -1));
+      }
+      text += QLatin1Char(' ');
+    }
+  }
+  text += QLatin1Char('}');
+}
+
+// The message named by `path`, which is either empty or ends with a message field or an element of one
+const pb::Message* messageAtPath(const pb::Message &root, const protobuf_editor::FieldPath &path) {
+  if (path.empty()) {
+    return &root;
+  }
+  const pb::Message *containingMessage = path.resolveContainingMessage(root);
+  if (containingMessage == nullptr) {
+    return nullptr;
+  }
+  const pb::Reflection *reflection = containingMessage->GetReflection();
+  const protobuf_editor::FieldPath::Element &element = path.back();
+  if (element.fieldDescriptor->is_repeated()) {
+    if (element.index == -1 || element.index >= reflection->FieldSize(*containingMessage, element.fieldDescriptor)) {
+      return nullptr;
+    }
+    return &reflection->GetRepeatedMessage(*containingMessage, element.fieldDescriptor, element.index);
+  }
+  if (!reflection->HasField(*containingMessage, element.fieldDescriptor)) {
+    return nullptr;
+  }
+  return &reflection->GetMessage(*containingMessage, element.fieldDescriptor);
+}
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+DiffView::DiffView(QWidget *parent) : QWidget(parent) {
+  buildWidget();
+}
+
+const std::vector<FieldDifference>& DiffView::differences() const {
+  return differences_;
+}
+
+void DiffView::buildWidget() {
+  treeWidget_ = new QTreeWidget;
+  treeWidget_->setColumnCount(kColumnCount);
+  treeWidget_->setHeaderLabels({tr("Field"), tr("Left"), tr("Right")});
+  treeWidget_->setUniformRowHeights(true);
+  treeWidget_->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+  connect(treeWidget_, &QTreeWidget::currentItemChanged, [this](QTreeWidgetItem *current){
+    revealItem(current);
+  });
+
+  summaryLabel_ = new QLabel;
+
+  QWidget *treePane = new QWidget;
+  QVBoxLayout *treeLayout = new QVBoxLayout(treePane);
+  treeLayout->setContentsMargins(0,0,0,0);
+  treeLayout->addWidget(treeWidget_, 1);
+  treeLayout->addWidget(summaryLabel_);
+
+  lhsScrollArea_ = new QScrollArea;
+  lhsScrollArea_->setWidgetResizable(true);
+  rhsScrollArea_ = new QScrollArea;
+  rhsScrollArea_->setWidgetResizable(true);
+  QSplitter *messagesSplitter = new QSplitter(Qt::Horizontal);
+  messagesSplitter->addWidget(lhsScrollArea_);
+  messagesSplitter->addWidget(rhsScrollArea_);
+
+  QSplitter *splitter = new QSplitter(Qt::Vertical);
+  splitter->addWidget(treePane);
+  splitter->addWidget(messagesSplitter);
+
+  QVBoxLayout *layout = new QVBoxLayout(this);
+  layout->addWidget(splitter);
+}
+
+DiffView::~DiffView() {
+  delete lhsScrollArea_->takeWidget();
+  delete rhsScrollArea_->takeWidget();
+}
+
+void DiffView::setMessages(std::unique_ptr<pb::Message> lhs, std::unique_ptr<pb::Message> rhs, const StructuralDiffOptions &options) {
+  if (lhs == nullptr || rhs == nullptr) {
+    throw std::runtime_error("Diff view was given a null message");
+  }
+  differences_ = structuralDiff(*lhs, *rhs, options);
+
+  // The old widgets point into the old messages, they have to go first
+  delete lhsScrollArea_->takeWidget();
+  delete rhsScrollArea_->takeWidget();
+  lhs_ = std::move(lhs);
+  rhs_ = std::move(rhs);
+  lhsWidget_ = new MessageTypeWidget(lhs_->GetDescriptor());
+  lhsWidget_->setReadOnlyMessage(lhs_.get());
+  lhsScrollArea_->setWidget(lhsWidget_);
+  rhsWidget_ = new MessageTypeWidget(rhs_->GetDescriptor());
+  rhsWidget_->setReadOnlyMessage(rhs_.get());
+  rhsScrollArea_->setWidget(rhsWidget_);
+
+  buildTree();
+  summaryLabel_->setText(tr("%n difference(s)", "", static_cast<int>(differences_.size())));
+}
+
+void DiffView::buildTree() {
+  treeWidget_->clear();
+  nodes_.clear();
+  childItems_.clear();
+  for (const FieldDifference &difference : differences_) {
+    addDifferenceItem(difference);
+  }
+  addUnchangedItems();
+  treeWidget_->expandAll();
+}
+
+QTreeWidgetItem* DiffView::childItem(QTreeWidgetItem *parent, const FieldPath &lhsPath, const FieldPath &rhsPath, const QString &text, bool isRepeatedField) {
+  auto key = std::make_pair(parent, lhsPath.toString()+"|"+rhsPath.toString());
+  auto it = childItems_.find(key);
+  if (it != childItems_.end()) {
+    return it->second;
+  }
+  QTreeWidgetItem *item = (parent != nullptr ? new QTreeWidgetItem(parent) : new QTreeWidgetItem(treeWidget_));
+  item->setText(kFieldColumn, text);
+  nodes_.emplace(item, Node{lhsPath, rhsPath, isRepeatedField});
+  childItems_.emplace(std::move(key), item);
+  return item;
+}
+
+void DiffView::addDifferenceItem(const FieldDifference &difference) {
+  // Both paths go through the same fields, only the indices of elements can differ
+  QTreeWidgetItem *parent = nullptr;
+  FieldPath lhsPath, rhsPath;
+  for (size_t position=0; position<difference.lhsPath.size(); ++position) {
+    const FieldPath::Element &lhsElement = difference.lhsPath.at(position);
+    const FieldPath::Element &rhsElement = difference.rhsPath.at(position);
+    const pb::FieldDescriptor *fieldDescriptor = lhsElement.fieldDescriptor;
+    if (!fieldDescriptor->is_repeated()) {
+      lhsPath.append(fieldDescriptor);
+      rhsPath.append(fieldDescriptor);
+      parent = childItem(parent, lhsPath, rhsPath, QString::fromStdString(fieldDescriptor->name()), false);
+      continue;
+    }
+    // A repeated field gets a row of its own, with its elements underneath
+    FieldPath lhsFieldPath = lhsPath;
+    lhsFieldPath.append(fieldDescriptor);
+    FieldPath rhsFieldPath = rhsPath;
+    rhsFieldPath.append(fieldDescriptor);
+    parent = childItem(parent, lhsFieldPath, rhsFieldPath, QString::fromStdString(fieldDescriptor->name()), true);
+
+    QString text;
+    if (lhsElement.index == -1) {
+      text = tr("[%1] added").arg(rhsElement.index);
+    } else if (rhsElement.index == -1) {
+      text = tr("[%1] removed").arg(lhsElement.index);
+    } else if (lhsElement.index == rhsElement.index) {
+      text = QStringLiteral("[%1]").arg(lhsElement.index);
+    } else {
+      text = QStringLiteral("[%1 → %2]").arg(lhsElement.index).arg(rhsElement.index);
+    }
+    lhsPath.append(fieldDescriptor, lhsElement.index);
+    rhsPath.append(fieldDescriptor, rhsElement.index);
+    parent = childItem(parent, lhsPath, rhsPath, text, false);
+  }
+
+  QTreeWidgetItem *item = parent;
+  item->setText(kLhsColumn, valueText(*lhs_, difference.lhsPath));
+  item->setText(kRhsColumn, valueText(*rhs_, difference.rhsPath));
+  QBrush brush;
+  switch (difference.kind) {
+    case FieldDifference::Kind::kChanged:
+      brush = QBrush(Qt::darkYellow);
+      break;
+    case FieldDifference::Kind::kAdded:
+      brush = QBrush(Qt::darkGreen);
+      break;
+    case FieldDifference::Kind::kRemoved:
+      brush = QBrush(Qt::red);
+      break;
+  }
+  for (int column=0; column<kColumnCount; ++column) {
+    item->setForeground(column, brush);
+  }
+}
+
+void DiffView::addUnchangedItems() {
+  // Everything which wasn't given a row is counted instead. Only the messages and repeated fields which contain a
+  //  difference are visited, so this is proportional to the size of the diff.
+  auto unchangedItem = [this](QTreeWidgetItem *parent, int count, const QString &text){
+    if (count <= 0) {
+      return;
+    }
+    QTreeWidgetItem *item = (parent != nullptr ? new QTreeWidgetItem(parent) : new QTreeWidgetItem(treeWidget_));
+    item->setText(kFieldColumn, text);
+    item->setFlags(Qt::ItemIsEnabled);
+    item->setForeground(kFieldColumn, QBrush(Qt::gray));
+  };
+  auto presentFieldCount = [](const pb::Message *lhs, const pb::Message *rhs){
+    std::set<int> fieldNumbers;
+    std::vector<const pb::FieldDescriptor*> fields;
+    for (const pb::Message *message : {lhs, rhs}) {
+      if (message == nullptr) {
+        continue;
+      }
+      fields.clear();
+      message->GetReflection()->ListFields(*message, &fields);
+      for (const pb::FieldDescriptor *fieldDescriptor : fields) {
+        fieldNumbers.insert(fieldDescriptor->number());
+      }
+    }
+    return static_cast<int>(fieldNumbers.size());
+  };
+
+  // The root message, whose differing fields are the top level rows
+  const int rootUnchangedCount = presentFieldCount(lhs_.get(), rhs_.get()) - treeWidget_->topLevelItemCount();
+  unchangedItem(nullptr, rootUnchangedCount, tr("… %n other field(s) unchanged", "", rootUnchangedCount));
+  for (const auto &[item, node] : nodes_) {
+    const int childCount = item->childCount();
+    if (childCount == 0) {
+      continue;
+    }
+    if (node.isRepeatedField) {
+      // Every element on the left is either unchanged, or has a row as changed or removed
+      const pb::Message *containingMessage = node.lhsPath.resolveContainingMessage(*lhs_);
+      const int lhsSize = (containingMessage != nullptr ? containingMessage->GetReflection()->FieldSize(*containingMessage, node.lhsPath.back().fieldDescriptor) : 0);
+      int lhsElementRows = 0;
+      for (int childIndex=0; childIndex<childCount; ++childIndex) {
+        if (nodes_.at(item->child(childIndex)).lhsPath.back().index != -1) {
+          ++lhsElementRows;
+        }
+      }
+      unchangedItem(item, lhsSize - lhsElementRows, tr("… %n other element(s) unchanged", "", lhsSize - lhsElementRows));
+    } else {
+      const int unchangedCount = presentFieldCount(messageAtPath(*lhs_, node.lhsPath), messageAtPath(*rhs_, node.rhsPath)) - childCount;
+      unchangedItem(item, unchangedCount, tr("… %n other field(s) unchanged", "", unchangedCount));
+    }
+  }
+}
+
+void DiffView::revealItem(QTreeWidgetItem *item) {
+  auto nodeIt = nodes_.find(item);
+  if (nodeIt == nodes_.end()) {
+    return;
+  }
+  const Node &node = nodeIt->second;
+  QPointer<ProtobufFieldWidget> lhsFieldWidget = lhsWidget_->revealField(node.lhsPath);
+  QPointer<ProtobufFieldWidget> rhsFieldWidget = rhsWidget_->revealField(node.rhsPath);
+  // Widgets which were just built haven't been laid out yet, so wait for that before scrolling to them
+  QTimer::singleShot(0, this, [this, lhsFieldWidget, rhsFieldWidget]{
+    if (lhsFieldWidget != nullptr) {
+      lhsScrollArea_->ensureWidgetVisible(lhsFieldWidget);
+    }
+    if (rhsFieldWidget != nullptr) {
+      rhsScrollArea_->ensureWidgetVisible(rhsFieldWidget);
+    }
+  });
+}
+
+QString DiffView::valueText(const pb::Message &root, const FieldPath &path) {
+  const pb::Message *containingMessage = path.resolveContainingMessage(root);
+  if (containingMessage == nullptr) {
+    return tr("(not set)");
+  }
+  const FieldPath::Element &element = path.back();
+  const pb::FieldDescriptor *fieldDescriptor = element.fieldDescriptor;
+  if (fieldDescriptor->is_repeated() && element.index == -1) {
+    // This side doesn't have the element
+    return QString();
+  }
+  if (!fieldDescriptor->is_repeated() && fieldDescriptor->has_presence() && !containingMessage->GetReflection()->HasField(*containingMessage, fieldDescriptor)) {
+    return tr("(not set)");
+  }
+  if (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE) {
+    QString text;
+    appendMessageText(*messageAtPath(root, path), text);
+    return elided(text);
+  }
+  return elided(fieldValueToString(fieldDescriptor, readFieldValue(*containingMessage, fieldDescriptor, element.index)));
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
@@ -0,0 +1,70 @@
+#ifndef PROTOBUF_EDITOR_DIFF_VIEW_HPP_
+#define PROTOBUF_EDITOR_DIFF_VIEW_HPP_
+
+#include "structuralDiff.hpp"
+
+#include <google/protobuf/message.h>
+
+#include <QLabel>
+#include <QScrollArea>
+#include <QTreeWidget>
+#include <QWidget>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace protobuf_editor {
+
+class MessageTypeWidget;
+
+// Shows the differences between two messages of the same type. The tree at the top only has rows for the fields
+//  which differ and the messages which contain them; everything else in a message is collapsed into one
+//  "unchanged" row, so the tree is as large as the diff rather than as large as the messages. Below it, both
+//  messages are shown side by side, read-only, and selecting a row reveals the field in both.
+class DiffView : public QWidget {
+  Q_OBJECT
+public:
+  explicit DiffView(QWidget *parent=nullptr);
+  // Deletes the message widgets before the messages they point into
+  ~DiffView();
+  // Takes ownership of both messages, they're displayed for as long as the view exists
+  void setMessages(std::unique_ptr<google::protobuf::Message> lhs, std::unique_ptr<google::protobuf::Message> rhs, const StructuralDiffOptions &options=StructuralDiffOptions());
+  const std::vector<FieldDifference>& differences() const;
+private:
+  struct Node {
+    FieldPath lhsPath;
+    FieldPath rhsPath;
+    // The row of a repeated field, whose children are its elements rather than fields
+    bool isRepeatedField{false};
+  };
+  // Child widgets are only deleted by ~QWidget, after these, so the destructor deletes the widgets which display them
+  std::unique_ptr<google::protobuf::Message> lhs_;
+  std::unique_ptr<google::protobuf::Message> rhs_;
+  std::vector<FieldDifference> differences_;
+  std::unordered_map<QTreeWidgetItem*, Node> nodes_;
+  // Finds the row of a field or element under a parent row, null being the top level
+  std::map<std::pair<QTreeWidgetItem*, std::string>, QTreeWidgetItem*> childItems_;
+  QTreeWidget *treeWidget_{nullptr};
+  QLabel *summaryLabel_{nullptr};
+  QScrollArea *lhsScrollArea_{nullptr};
+  QScrollArea *rhsScrollArea_{nullptr};
+  MessageTypeWidget *lhsWidget_{nullptr};
+  MessageTypeWidget *rhsWidget_{nullptr};
+  void buildWidget();
+  void buildTree();
+  QTreeWidgetItem* childItem(QTreeWidgetItem *parent, const FieldPath &lhsPath, const FieldPath &rhsPath, const QString &text, bool isRepeatedField);
+  void addDifferenceItem(const FieldDifference &difference);
+  void addUnchangedItems();
+  void revealItem(QTreeWidgetItem *item);
+  // The value of the field or element named by `path`, as shown in the tree
+  static QString valueText(const google::protobuf::Message &root, const FieldPath &path);
+signals:
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_DIFF_VIEW_HPP_
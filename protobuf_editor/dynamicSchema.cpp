@@ -0,0 +1,301 @@
+#include "dynamicSchema.hpp"
+
+#include <google/protobuf/compiler/importer.h>
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+namespace pb = google::protobuf;
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char kCacheManifestHeader[] = "protobuf_editor schema cache 1";
+
+class ErrorCollector : public pb::compiler::MultiFileErrorCollector {
+public:
+  void AddError(const std::string &filename, int line, int column, const std::string &message) override {
+    // Lines and columns are zero-based
+    errors_ << filename << ":" << line+1 << ":" << column+1 << ": " << message << "\n";
+  }
+  std::string errors() const {
+    return errors_.str();
+  }
+private:
+  std::ostringstream errors_;
+};
+
+// FNV-1a, which unlike std::hash is guaranteed to give the same result in every run
+class Hasher {
+public:
+  void add(const std::string &data) {
+    for (const unsigned char byte : data) {
+      hash_ = (hash_ ^ byte) * 0x100000001b3ull;
+    }
+    // Separate consecutive strings, so that {"ab", "c"} and {"a", "bc"} hash differently
+    hash_ = (hash_ ^ 0xff) * 0x100000001b3ull;
+  }
+  std::string hexDigest() const {
+    std::ostringstream stream;
+    stream << std::hex << hash_;
+    return stream.str();
+  }
+private:
+  uint64_t hash_{0xcbf29ce484222325ull};
+};
+
+// Identifies a file on disk as it was when it was parsed
+struct CachedSourceFile {
+  std::string path;
+  int64_t modificationTime{0};
+  uintmax_t size{0};
+};
+
+bool readSourceFileState(const std::string &path, CachedSourceFile *sourceFile) {
+  std::error_code error;
+  const fs::file_time_type modificationTime = fs::last_write_time(path, error);
+  if (error) {
+    return false;
+  }
+  const uintmax_t size = fs::file_size(path, error);
+  if (error) {
+    return false;
+  }
+  sourceFile->path = path;
+  sourceFile->modificationTime = modificationTime.time_since_epoch().count();
+  sourceFile->size = size;
+  return true;
+}
+
+// Every file is written after the files it imports, which is the order in which a pool must build them
+void appendWithDependencies(const pb::FileDescriptor *file, std::set<const pb::FileDescriptor*> *visited, pb::FileDescriptorSet *descriptorSet) {
+  if (!visited->insert(file).second) {
+    return;
+  }
+  for (int dependencyIndex=0; dependencyIndex<file->dependency_count(); ++dependencyIndex) {
+    appendWithDependencies(file->dependency(dependencyIndex), visited, descriptorSet);
+  }
+  file->CopyTo(descriptorSet->add_file());
+}
+
+// A cache entry is two files: the FileDescriptorSet, and a manifest listing every source file it was parsed from
+struct CacheEntry {
+  std::string descriptorSetPath;
+  std::string manifestPath;
+};
+
+CacheEntry cacheEntryFor(const std::vector<std::string> &protoFiles, const std::vector<std::string> &importPaths, const std::string &cacheDirectory) {
+  Hasher hasher;
+  for (const std::string &importPath : importPaths) {
+    hasher.add("-I"+fs::absolute(importPath).lexically_normal().string());
+  }
+  for (const std::string &protoFile : protoFiles) {
+    hasher.add(protoFile);
+  }
+  const fs::path base = fs::path(cacheDirectory) / hasher.hexDigest();
+  return {base.string()+".desc", base.string()+".manifest"};
+}
+
+// Returns false if there is no usable cache entry, e.g. because one of the source files changed
+bool readCacheEntry(const CacheEntry &entry, pb::FileDescriptorSet *descriptorSet) {
+  std::ifstream manifest(entry.manifestPath);
+  std::string header;
+  if (!manifest || !std::getline(manifest, header) || header != kCacheManifestHeader) {
+    return false;
+  }
+  CachedSourceFile cached;
+  while (manifest >> cached.modificationTime >> cached.size && std::getline(manifest >> std::ws, cached.path)) {
+    CachedSourceFile current;
+    if (!readSourceFileState(cached.path, &current) || current.modificationTime != cached.modificationTime || current.size != cached.size) {
+      return false;
+    }
+  }
+  if (!manifest.eof()) {
+    // Malformed
+    return false;
+  }
+  std::ifstream descriptorSetFile(entry.descriptorSetPath, std::ios::binary);
+  return descriptorSetFile && descriptorSet->ParseFromIstream(&descriptorSetFile);
+}
+
+// A temporary file next to `path` which no other writer, in this or any other instance, will also pick
+std::string uniqueTemporaryPath(const std::string &path) {
+  static std::atomic<uint64_t> counter{0};
+  std::random_device randomDevice;
+  const uint64_t suffix = ((static_cast<uint64_t>(randomDevice()) << 32) | randomDevice()) ^ counter++;
+  std::ostringstream temporaryPath;
+  temporaryPath << path << "." << std::hex << suffix << ".tmp";
+  return temporaryPath.str();
+}
+
+void writeFileAtomically(const std::string &path, const std::function<bool(std::ostream&)> &write) {
+  // Another instance starting at the same time must never see a half-written file. Each writer has its own temporary
+  //  file, so the one which is renamed into place last wins with a complete file.
+  const std::string temporaryPath = uniqueTemporaryPath(path);
+  bool written;
+  {
+    std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+    written = (file && write(file) && file.flush());
+  }
+  std::error_code error;
+  if (written) {
+    fs::rename(temporaryPath, path, error);
+  }
+  if (!written || error) {
+    fs::remove(temporaryPath, error);
+    throw std::runtime_error("Failed to write \""+path+"\"");
+  }
+}
+
+void writeCacheEntry(const CacheEntry &entry, const pb::FileDescriptorSet &descriptorSet, const std::vector<CachedSourceFile> &sourceFiles) {
+  fs::create_directories(fs::path(entry.descriptorSetPath).parent_path());
+  // The manifest is written last, an entry without one is never used
+  writeFileAtomically(entry.descriptorSetPath, [&](std::ostream &stream) {
+    return descriptorSet.SerializeToOstream(&stream);
+  });
+  writeFileAtomically(entry.manifestPath, [&](std::ostream &stream) {
+    stream << kCacheManifestHeader << "\n";
+    for (const CachedSourceFile &sourceFile : sourceFiles) {
+      stream << sourceFile.modificationTime << " " << sourceFile.size << " " << sourceFile.path << "\n";
+    }
+    return static_cast<bool>(stream);
+  });
+}
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+DynamicSchema::DynamicSchema() : factory_(&pool_) {
+  // Messages may contain types from any file in the pool, not only the one which they were declared in
+  factory_.SetDelegateToGeneratedFactory(false);
+}
+
+std::unique_ptr<DynamicSchema> DynamicSchema::fromProtoFiles(const std::vector<std::string> &protoFiles, const std::vector<std::string> &importPaths, const std::string &cacheDirectory) {
+  CacheEntry cacheEntry;
+  if (!cacheDirectory.empty()) {
+    cacheEntry = cacheEntryFor(protoFiles, importPaths, cacheDirectory);
+    pb::FileDescriptorSet cachedDescriptorSet;
+    if (readCacheEntry(cacheEntry, &cachedDescriptorSet)) {
+      std::unique_ptr<DynamicSchema> schema = fromDescriptorSet(cachedDescriptorSet);
+      schema->loadedFromCache_ = true;
+      return schema;
+    }
+  }
+
+  pb::compiler::DiskSourceTree sourceTree;
+  for (const std::string &importPath : importPaths) {
+    sourceTree.MapPath("", importPath);
+  }
+  ErrorCollector errorCollector;
+  pb::compiler::Importer importer(&sourceTree, &errorCollector);
+  pb::FileDescriptorSet descriptorSet;
+  std::set<const pb::FileDescriptor*> visited;
+  for (const std::string &protoFile : protoFiles) {
+    const pb::FileDescriptor *file = importer.Import(protoFile);
+    if (file == nullptr) {
+      throw std::runtime_error("Failed to load \""+protoFile+"\":\n"+errorCollector.errors());
+    }
+    appendWithDependencies(file, &visited, &descriptorSet);
+  }
+
+  // The importer's pool dies with it, so rebuild from the parsed files into a pool which the schema owns. This is
+  //  also exactly what loading from the cache does.
+  std::unique_ptr<DynamicSchema> schema = fromDescriptorSet(descriptorSet);
+
+  if (!cacheDirectory.empty()) {
+    std::vector<CachedSourceFile> sourceFiles;
+    for (const pb::FileDescriptorProto &file : descriptorSet.file()) {
+      std::string diskFile;
+      CachedSourceFile sourceFile;
+      if (!sourceTree.VirtualFileToDiskFile(file.name(), &diskFile) || !readSourceFileState(fs::absolute(diskFile).string(), &sourceFile)) {
+        // Can't tell if this file changes, so don't cache
+        return schema;
+      }
+      sourceFiles.push_back(std::move(sourceFile));
+    }
+    try {
+      writeCacheEntry(cacheEntry, descriptorSet, sourceFiles);
+    } catch (const std::exception &) {
+      // The cache is only an optimization, the schema itself loaded fine
+    }
+  }
+  return schema;
+}
+
+std::unique_ptr<DynamicSchema> DynamicSchema::fromDescriptorSetFile(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("Failed to open \""+path+"\"");
+  }
+  pb::FileDescriptorSet descriptorSet;
+  if (!descriptorSet.ParseFromIstream(&file)) {
+    throw std::runtime_error("\""+path+"\" is not a serialized FileDescriptorSet");
+  }
+  return fromDescriptorSet(descriptorSet);
+}
+
+std::unique_ptr<DynamicSchema> DynamicSchema::fromDescriptorSet(const pb::FileDescriptorSet &descriptorSet) {
+  std::unique_ptr<DynamicSchema> schema(new DynamicSchema);
+  schema->buildFiles(descriptorSet);
+  return schema;
+}
+
+void DynamicSchema::buildFiles(const pb::FileDescriptorSet &descriptorSet) {
+  // Files may be listed in any order, so build each one only after the files it imports
+  std::map<std::string, const pb::FileDescriptorProto*> filesByName;
+  for (const pb::FileDescriptorProto &file : descriptorSet.file()) {
+    filesByName.emplace(file.name(), &file);
+  }
+  std::function<void(const pb::FileDescriptorProto&)> build = [&](const pb::FileDescriptorProto &file) {
+    if (pool_.FindFileByName(file.name()) != nullptr) {
+      return;
+    }
+    for (const std::string &dependency : file.dependency()) {
+      auto it = filesByName.find(dependency);
+      if (it == filesByName.end()) {
+        throw std::runtime_error("\""+file.name()+"\" imports \""+dependency+"\", which is not in the descriptor set");
+      }
+      build(*it->second);
+    }
+    if (pool_.BuildFile(file) == nullptr) {
+      throw std::runtime_error("Failed to build \""+file.name()+"\"");
+    }
+  };
+  for (const pb::FileDescriptorProto &file : descriptorSet.file()) {
+    build(file);
+  }
+}
+
+const pb::DescriptorPool* DynamicSchema::pool() const {
+  return &pool_;
+}
+
+const pb::Descriptor* DynamicSchema::findMessageType(const std::string &fullName) const {
+  const pb::Descriptor *descriptor = pool_.FindMessageTypeByName(fullName);
+  if (descriptor == nullptr) {
+    throw std::runtime_error("No message type named \""+fullName+"\"");
+  }
+  return descriptor;
+}
+
+const pb::Message* DynamicSchema::prototype(const pb::Descriptor *descriptor) const {
+  if (descriptor->file()->pool() != &pool_) {
+    throw std::runtime_error("\""+descriptor->full_name()+"\" is not part of this schema");
+  }
+  return factory_.GetPrototype(descriptor);
+}
+
+bool DynamicSchema::loadedFromCache() const {
+  return loadedFromCache_;
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef PROTOBUF_EDITOR_DYNAMIC_SCHEMA_HPP_
+#define PROTOBUF_EDITOR_DYNAMIC_SCHEMA_HPP_
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/message.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace protobuf_editor {
+
+// Message types which are only known at runtime, loaded from .proto files or from a serialized FileDescriptorSet, so
+//  that editing another schema doesn't require recompiling. Messages of these types are DynamicMessages.
+// Descriptors are cached for the lifetime of the process by the editor widgets (see descriptorLayout.hpp), so a
+//  schema which has been shown in an editor must never be destroyed before the process exits.
+class DynamicSchema {
+public:
+  // Parses `protoFiles`, and everything they import, looking for them in `importPaths`, like protoc's -I.
+  // If `cacheDirectory` is not empty, the parsed files are stored there. The next time the same files are loaded with
+  //  the same import paths, the cached descriptors are used instead of parsing again, as long as none of the files
+  //  which were parsed has been modified since.
+  // Throws with every parse error if any of the files could not be parsed.
+  static std::unique_ptr<DynamicSchema> fromProtoFiles(const std::vector<std::string> &protoFiles, const std::vector<std::string> &importPaths, const std::string &cacheDirectory="");
+  // Loads a FileDescriptorSet, as written by `protoc --include_imports --descriptor_set_out`
+  static std::unique_ptr<DynamicSchema> fromDescriptorSetFile(const std::string &path);
+  static std::unique_ptr<DynamicSchema> fromDescriptorSet(const google::protobuf::FileDescriptorSet &descriptorSet);
+
+  const google::protobuf::DescriptorPool* pool() const;
+  // Throws if there is no message type with this fully qualified name
+  const google::protobuf::Descriptor* findMessageType(const std::string &fullName) const;
+  // The default instance of a message type from this schema. New messages are created with `prototype->New()`.
+  const google::protobuf::Message* prototype(const google::protobuf::Descriptor *descriptor) const;
+  // Whether the descriptors came from the on-disk cache rather than from parsing
+  bool loadedFromCache() const;
+private:
+  DynamicSchema();
+  void buildFiles(const google::protobuf::FileDescriptorSet &descriptorSet);
+  google::protobuf::DescriptorPool pool_;
+  // Creating a prototype the first time a type is asked for modifies the factory, which isn't part of the schema's
+  //  observable state
+  mutable google::protobuf::DynamicMessageFactory factory_;
+  bool loadedFromCache_{false};
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_DYNAMIC_SCHEMA_HPP_
@@ -0,0 +1,209 @@
+#include "editHistory.hpp"
+#include "messageDiff.hpp"
+
+#include <stdexcept>
+
+namespace pb = google::protobuf;
+
+namespace {
+
+constexpr size_t kDefaultMemoryLimit = 64 << 20;
+constexpr int kDefaultMergeIntervalMilliseconds = 1000;
+
+// Copies the field at `path` out of `root`, into an otherwise empty message of the type which contains the field. For
+//  a member of a oneof, whichever member of the oneof is set is copied, since setting one member clears the others.
+std::unique_ptr<pb::Message> captureField(const pb::Message &root, const protobuf_editor::FieldPath &path) {
+  const pb::FieldDescriptor *fieldDescriptor = path.back().fieldDescriptor;
+  const int index = path.back().index;
+  const pb::Message *prototype = root.GetReflection()->GetMessageFactory()->GetPrototype(fieldDescriptor->containing_type());
+  std::unique_ptr<pb::Message> state(prototype->New());
+  const pb::Message *containingMessage = path.resolveContainingMessage(root);
+  if (containingMessage == nullptr) {
+    // The field can't be set if the message it's in isn't there
+    return state;
+  }
+  const pb::OneofDescriptor *oneofDescriptor = fieldDescriptor->real_containing_oneof();
+  if (oneofDescriptor != nullptr) {
+    const pb::FieldDescriptor *setFieldDescriptor = containingMessage->GetReflection()->GetOneofFieldDescriptor(*containingMessage, oneofDescriptor);
+    if (setFieldDescriptor != nullptr) {
+      protobuf_editor::copyFieldAtPath(*containingMessage, state.get(), protobuf_editor::FieldPath(setFieldDescriptor));
+    }
+  } else if (index == -1) {
+    protobuf_editor::copyFieldAtPath(*containingMessage, state.get(), protobuf_editor::FieldPath(fieldDescriptor));
+  } else {
+    protobuf_editor::copyRepeatedElement(*containingMessage, index, state.get(), -1, fieldDescriptor);
+  }
+  return state;
+}
+
+// The reverse of captureField
+void restoreField(const pb::Message &state, pb::Message *root, const protobuf_editor::FieldPath &path) {
+  const pb::FieldDescriptor *fieldDescriptor = path.back().fieldDescriptor;
+  const int index = path.back().index;
+  pb::Message *containingMessage = path.resolveMutableContainingMessage(root);
+  const pb::OneofDescriptor *oneofDescriptor = fieldDescriptor->real_containing_oneof();
+  if (oneofDescriptor != nullptr) {
+    const pb::FieldDescriptor *setFieldDescriptor = state.GetReflection()->GetOneofFieldDescriptor(state, oneofDescriptor);
+    if (setFieldDescriptor == nullptr) {
+      containingMessage->GetReflection()->ClearOneof(containingMessage, oneofDescriptor);
+    } else {
+      protobuf_editor::copyFieldAtPath(state, containingMessage, protobuf_editor::FieldPath(setFieldDescriptor));
+    }
+  } else if (index == -1) {
+    protobuf_editor::copyFieldAtPath(state, containingMessage, protobuf_editor::FieldPath(fieldDescriptor));
+  } else {
+    protobuf_editor::copyRepeatedElement(state, 0, containingMessage, index, fieldDescriptor);
+  }
+}
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+EditHistory::EditHistory(QObject *parent) : QObject(parent), memoryLimit_(kDefaultMemoryLimit), mergeIntervalMilliseconds_(kDefaultMergeIntervalMilliseconds) {
+  clock_.start();
+}
+
+size_t EditHistory::memoryLimit() const {
+  return memoryLimit_;
+}
+
+void EditHistory::setMemoryLimit(size_t bytes) {
+  memoryLimit_ = bytes;
+  enforceMemoryLimit();
+  emit changed();
+}
+
+size_t EditHistory::memoryUsage() const {
+  return memoryUsage_;
+}
+
+void EditHistory::setMergeInterval(int milliseconds) {
+  mergeIntervalMilliseconds_ = milliseconds;
+}
+
+bool EditHistory::canUndo() const {
+  return !undoStack_.empty();
+}
+
+bool EditHistory::canRedo() const {
+  return !redoStack_.empty();
+}
+
+void EditHistory::clear() {
+  undoStack_.clear();
+  redoStack_.clear();
+  memoryUsage_ = 0;
+  canMerge_ = false;
+  editInProgress_ = false;
+  pendingBefore_.reset();
+  emit changed();
+}
+
+void EditHistory::beginEdit(const pb::Message &root, const FieldPath &path) {
+  if (path.empty()) {
+    throw std::runtime_error("An edit must name the field which is being edited");
+  }
+  const int index = path.back().index;
+  if (index != -1) {
+    const pb::Message *containingMessage = path.resolveContainingMessage(root);
+    if (containingMessage == nullptr || index >= containingMessage->GetReflection()->FieldSize(*containingMessage, path.back().fieldDescriptor)) {
+      // Not an element which exists, so it can't be what's being edited
+      editInProgress_ = false;
+      return;
+    }
+  }
+  pendingPath_ = path;
+  pendingBefore_ = captureField(root, path);
+  editInProgress_ = true;
+}
+
+void EditHistory::endEdit(const pb::Message &root, const FieldPath &path) {
+  if (!editInProgress_ || path != pendingPath_) {
+    return;
+  }
+  editInProgress_ = false;
+  std::unique_ptr<pb::Message> after = captureField(root, path);
+  if (diffMessages(*pendingBefore_, *after).empty()) {
+    // Nothing actually changed, e.g. the same text was typed back in
+    pendingBefore_.reset();
+    return;
+  }
+
+  const qint64 now = clock_.elapsed();
+  // Anything which was undone can't be redone once something else has changed
+  for (const Edit &edit : redoStack_) {
+    memoryUsage_ -= edit.bytes;
+  }
+  redoStack_.clear();
+
+  if (canMerge_ && !undoStack_.empty() && undoStack_.back().path == path && now - undoStack_.back().time <= mergeIntervalMilliseconds_) {
+    // Keep the value from before the first of these edits, and take the latest value
+    Edit &previous = undoStack_.back();
+    memoryUsage_ -= previous.bytes;
+    previous.after = std::move(after);
+    previous.time = now;
+    previous.bytes = editSize(previous);
+    memoryUsage_ += previous.bytes;
+    pendingBefore_.reset();
+  } else {
+    Edit edit;
+    edit.path = path;
+    edit.before = std::move(pendingBefore_);
+    edit.after = std::move(after);
+    edit.time = now;
+    edit.bytes = editSize(edit);
+    memoryUsage_ += edit.bytes;
+    undoStack_.push_back(std::move(edit));
+  }
+  canMerge_ = true;
+  enforceMemoryLimit();
+  emit changed();
+}
+
+std::optional<FieldPath> EditHistory::undo(pb::Message *root) {
+  if (undoStack_.empty()) {
+    return std::nullopt;
+  }
+  Edit edit = std::move(undoStack_.back());
+  undoStack_.pop_back();
+  restoreField(*edit.before, root, edit.path);
+  const FieldPath path = edit.path;
+  redoStack_.push_back(std::move(edit));
+  canMerge_ = false;
+  emit changed();
+  return path;
+}
+
+std::optional<FieldPath> EditHistory::redo(pb::Message *root) {
+  if (redoStack_.empty()) {
+    return std::nullopt;
+  }
+  Edit edit = std::move(redoStack_.back());
+  redoStack_.pop_back();
+  restoreField(*edit.after, root, edit.path);
+  const FieldPath path = edit.path;
+  undoStack_.push_back(std::move(edit));
+  canMerge_ = false;
+  emit changed();
+  return path;
+}
+
+void EditHistory::enforceMemoryLimit() {
+  // The oldest edits are the least likely to be undone. An edit which on its own is larger than the limit isn't
+  //  kept either.
+  while (memoryUsage_ > memoryLimit_ && !undoStack_.empty()) {
+    memoryUsage_ -= undoStack_.front().bytes;
+    undoStack_.pop_front();
+  }
+  while (memoryUsage_ > memoryLimit_ && !redoStack_.empty()) {
+    memoryUsage_ -= redoStack_.front().bytes;
+    redoStack_.erase(redoStack_.begin());
+  }
+}
+
+size_t EditHistory::editSize(const Edit &edit) {
+  return sizeof(Edit) + edit.path.size()*sizeof(FieldPath::Element) + edit.before->SpaceUsedLong() + edit.after->SpaceUsedLong();
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
@@ -0,0 +1,75 @@
+#ifndef PROTOBUF_EDITOR_EDIT_HISTORY_HPP_
+#define PROTOBUF_EDITOR_EDIT_HISTORY_HPP_
+
+#include "fieldPath.hpp"
+
+#include <google/protobuf/message.h>
+
+#include <QElapsedTimer>
+#include <QObject>
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace protobuf_editor {
+
+// Records edits as the value of one field before and after it was changed, rather than as copies of the whole
+//  message, so that undo costs as much as the edit did no matter how large the message is. Consecutive edits to the
+//  same field, like typing into a line edit, are merged into one. Once the recorded edits take up more memory than
+//  the limit, the oldest are forgotten.
+// An edit to a single element of a repeated field only records that element. Adding, removing or moving elements
+//  records the whole field.
+class EditHistory : public QObject {
+  Q_OBJECT
+public:
+  explicit EditHistory(QObject *parent=nullptr);
+  size_t memoryLimit() const;
+  void setMemoryLimit(size_t bytes);
+  size_t memoryUsage() const;
+  // Edits to the same field which are at most this far apart are undone together
+  void setMergeInterval(int milliseconds);
+  bool canUndo() const;
+  bool canRedo() const;
+  void clear();
+  // To be called right before and right after the field at `path`, relative to `root`, is modified. An edit which
+  //  was begun but never ended, e.g. because the input didn't parse, isn't recorded.
+  void beginEdit(const google::protobuf::Message &root, const FieldPath &path);
+  void endEdit(const google::protobuf::Message &root, const FieldPath &path);
+  // Puts the field back the way it was before the last edit, and returns its path, so that only it needs to be
+  //  refreshed. Returns nothing if there's nothing to undo.
+  std::optional<FieldPath> undo(google::protobuf::Message *root);
+  std::optional<FieldPath> redo(google::protobuf::Message *root);
+private:
+  struct Edit {
+    FieldPath path;
+    // Messages of the type which contains the field, holding only the field. For a single element of a repeated
+    //  field, they hold only that element.
+    std::unique_ptr<google::protobuf::Message> before;
+    std::unique_ptr<google::protobuf::Message> after;
+    qint64 time{0};
+    size_t bytes{0};
+  };
+  std::deque<Edit> undoStack_;
+  std::vector<Edit> redoStack_;
+  size_t memoryLimit_;
+  size_t memoryUsage_{0};
+  int mergeIntervalMilliseconds_;
+  // Undo and redo end the edit which could be merged into
+  bool canMerge_{false};
+  bool editInProgress_{false};
+  FieldPath pendingPath_;
+  std::unique_ptr<google::protobuf::Message> pendingBefore_;
+  QElapsedTimer clock_;
+  void enforceMemoryLimit();
+  static size_t editSize(const Edit &edit);
+signals:
+  // Whenever canUndo or canRedo may have changed
+  void changed();
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_EDIT_HISTORY_HPP_
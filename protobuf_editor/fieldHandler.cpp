@@ -0,0 +1,291 @@
+#include "descriptorLayout.hpp"
+#include "fieldHandler.hpp"
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QLineEdit>
+
+#include <stdexcept>
+#include <string>
+
+namespace pb = google::protobuf;
+
+namespace {
+
+// How to get, set, parse and format each type which is edited as text
+template<typename T>
+struct TextFieldTraits;
+
+template<>
+struct TextFieldTraits<int32_t> {
+  static int32_t get(const pb::Message &message, const pb::FieldDescriptor *fieldDescriptor) {
+    return message.GetReflection()->GetInt32(message, fieldDescriptor);
+  }
+  static void set(pb::Message *message, const pb::FieldDescriptor *fieldDescriptor, int32_t value) {
+    message->GetReflection()->SetInt32(message, fieldDescriptor, value);
+  }
+  static int32_t defaultValue(const pb::FieldDescriptor *fieldDescriptor) {
+    return fieldDescriptor->default_value_int32();
+  }
+  static int32_t parse(const QString &text, bool *success) {
+    static_assert(sizeof(int) == sizeof(int32_t), "QString::toInt must parse a 32 bit integer");
+    return text.toInt(success);
+  }
+  static QString format(int32_t value) {
+    return QString::number(value);
+  }
+};
+
+template<>
+struct TextFieldTraits<uint32_t> {
+  static uint32_t get(const pb::Message &message, const pb::FieldDescriptor *fieldDescriptor) {
+    return message.GetReflection()->GetUInt32(message, fieldDescriptor);
+  }
+  static void set(pb::Message *message, const pb::FieldDescriptor *fieldDescriptor, uint32_t value) {
+    message->GetReflection()->SetUInt32(message, fieldDescriptor, value);
+  }
+  static uint32_t defaultValue(const pb::FieldDescriptor *fieldDescriptor) {
+    return fieldDescriptor->default_value_uint32();
+  }
+  static uint32_t parse(const QString &text, bool *success) {
+    static_assert(sizeof(uint) == sizeof(uint32_t), "QString::toUInt must parse a 32 bit integer");
+    return text.toUInt(success);
+  }
+  static QString format(uint32_t value) {
+    return QString::number(value);
+  }
+};
+
+template<>
+struct TextFieldTraits<int64_t> {
+  static int64_t get(const pb::Message &message, const pb::FieldDescriptor *fieldDescriptor) {
+    return message.GetReflection()->GetInt64(message, fieldDescriptor);
+  }
+  static void set(pb::Message *message, const pb::FieldDescriptor *fieldDescriptor, int64_t value) {
+    message->GetReflection()->SetInt64(message, fieldDescriptor, value);
+  }
+  static int64_t defaultValue(const pb::FieldDescriptor *fieldDescriptor) {
+    return fieldDescriptor->default_value_int64();
+  }
+  static int64_t parse(const QString &text, bool *success) {
+    return text.toLongLong(success);
+  }
+  static QString format(int64_t value) {
+    return QString::number(static_cast<qlonglong>(value));
+  }
+};
+
+template<>
+struct TextFieldTraits<uint64_t> {
+  static uint64_t get(const pb::Message &message, const pb::FieldDescriptor *fieldDescriptor) {
+    return message.GetReflection()->GetUInt64(message, fieldDescriptor);
+  }
+  static void set(pb::Message *message, const pb::FieldDescriptor *fieldDescriptor, uint64_t value) {
+    message->GetReflection()->SetUInt64(message, fieldDescriptor, value);
+  }
+  static uint64_t defaultValue(const pb::FieldDescriptor *fieldDescriptor) {
+    return fieldDescriptor->default_value_uint64();
+  }
+  static uint64_t parse(const QString &text, bool *success) {
+    return text.toULongLong(success);
+  }
+  static QString format(uint64_t value) {
+    return QString::number(static_cast<qulonglong>(value));
+  }
+};
+
+template<>
+struct TextFieldTraits<float> {
+  static float get(const pb::Message &message, const pb::FieldDescriptor *fieldDescriptor) {
+    return message.GetReflection()->GetFloat(message, fieldDescriptor);
+  }
+  static void set(pb::Message *message, const pb::FieldDescriptor *fieldDescriptor, float value) {
+    message->GetReflection()->SetFloat(message, fieldDescriptor, value);
+  }
+  static float defaultValue(const pb::FieldDescriptor *fieldDescriptor) {
+    return fieldDescriptor->default_value_float();
+  }
+  static float parse(const QString &text, bool *success) {
+    return text.toFloat(success);
+  }
+  static QString format(float value) {
+    return QString::number(value);
+  }
+};
+
+template<>
+struct TextFieldTraits<double> {
+  static double get(const pb::Message &message, const pb::FieldDescriptor *fieldDescriptor) {
+    return message.GetReflection()->GetDouble(message, fieldDescriptor);
+  }
+  static void set(pb::Message *message, const pb::FieldDescriptor *fieldDescriptor, double value) {
+    message->GetReflection()->SetDouble(message, fieldDescriptor, value);
+  }
+  static double defaultValue(const pb::FieldDescriptor *fieldDescriptor) {
+    return fieldDescriptor->default_value_double();
+  }
+  static double parse(const QString &text, bool *success) {
+    return text.toDouble(success);
+  }
+  static QString format(double value) {
+    return QString::number(value);
+  }
+};
+
+// Used for both string and bytes fields
+template<>
+struct TextFieldTraits<std::string> {
+  static std::string get(const pb::Message &message, const pb::FieldDescriptor *fieldDescriptor) {
+    return message.GetReflection()->GetString(message, fieldDescriptor);
+  }
+  static void set(pb::Message *message, const pb::FieldDescriptor *fieldDescriptor, std::string value) {
+    message->GetReflection()->SetString(message, fieldDescriptor, std::move(value));
+  }
+  static std::string defaultValue(const pb::FieldDescriptor *fieldDescriptor) {
+    return fieldDescriptor->default_value_string();
+  }
+  static std::string parse(const QString &text, bool *success) {
+    *success = true;
+    return text.toStdString();
+  }
+  static QString format(const std::string &value) {
+    return QString::fromStdString(value);
+  }
+};
+
+// Numbers and strings are edited in a QLineEdit
+template<typename T>
+class TextFieldHandler : public protobuf_editor::FieldHandler {
+public:
+  using Traits = TextFieldTraits<T>;
+  using FieldHandler::FieldHandler;
+  QWidget* createWidget(std::function<void()> onEdited) override {
+    lineEdit_ = new QLineEdit;
+    lineEdit_->setMinimumWidth(200);
+    QObject::connect(lineEdit_, &QLineEdit::textChanged, lineEdit_, std::move(onEdited));
+    return lineEdit_;
+  }
+  void readFromMessage(const pb::Message &message) override {
+    const QString text = Traits::format(Traits::get(message, fieldDescriptor_));
+    // Avoid the cost of re-laying out text which is already shown
+    if (lineEdit_->text() != text) {
+      lineEdit_->setText(text);
+    }
+  }
+  bool writeToMessage(pb::Message *message) const override {
+    bool success;
+    auto value = Traits::parse(lineEdit_->text(), &success);
+    if (success) {
+      Traits::set(message, fieldDescriptor_, std::move(value));
+    }
+    return success;
+  }
+  void writeDefaultToMessage(pb::Message *message) const override {
+    Traits::set(message, fieldDescriptor_, Traits::defaultValue(fieldDescriptor_));
+  }
+  void setReadOnly(bool readOnly) override {
+    lineEdit_->setReadOnly(readOnly);
+  }
+private:
+  QLineEdit *lineEdit_{nullptr};
+};
+
+// Booleans are a QCheckBox
+class BoolFieldHandler : public protobuf_editor::FieldHandler {
+public:
+  using FieldHandler::FieldHandler;
+  QWidget* createWidget(std::function<void()> onEdited) override {
+    checkBox_ = new QCheckBox;
+    QObject::connect(checkBox_, &QCheckBox::toggled, checkBox_, std::move(onEdited));
+    return checkBox_;
+  }
+  void readFromMessage(const pb::Message &message) override {
+    const bool isTrue = message.GetReflection()->GetBool(message, fieldDescriptor_);
+    if (checkBox_->isChecked() != isTrue) {
+      checkBox_->setChecked(isTrue);
+    }
+  }
+  bool writeToMessage(pb::Message *message) const override {
+    message->GetReflection()->SetBool(message, fieldDescriptor_, checkBox_->isChecked());
+    return true;
+  }
+  void writeDefaultToMessage(pb::Message *message) const override {
+    message->GetReflection()->SetBool(message, fieldDescriptor_, fieldDescriptor_->default_value_bool());
+  }
+private:
+  QCheckBox *checkBox_{nullptr};
+};
+
+// Enums are a QComboBox, with the enum's values in the order in which they're declared
+class EnumFieldHandler : public protobuf_editor::FieldHandler {
+public:
+  using FieldHandler::FieldHandler;
+  QWidget* createWidget(std::function<void()> onEdited) override {
+    comboBox_ = new QComboBox;
+    comboBox_->addItems(protobuf_editor::fieldLayout(fieldDescriptor_).enumNames);
+    QObject::connect(comboBox_, &QComboBox::currentIndexChanged, comboBox_, std::move(onEdited));
+    return comboBox_;
+  }
+  void readFromMessage(const pb::Message &message) override {
+    const int index = message.GetReflection()->GetEnum(message, fieldDescriptor_)->index();
+    if (comboBox_->currentIndex() != index) {
+      comboBox_->setCurrentIndex(index);
+    }
+  }
+  bool writeToMessage(pb::Message *message) const override {
+    const int index = comboBox_->currentIndex();
+    if (index < 0) {
+      return false;
+    }
+    message->GetReflection()->SetEnum(message, fieldDescriptor_, fieldDescriptor_->enum_type()->value(index));
+    return true;
+  }
+  void writeDefaultToMessage(pb::Message *message) const override {
+    message->GetReflection()->SetEnum(message, fieldDescriptor_, fieldDescriptor_->default_value_enum());
+  }
+private:
+  QComboBox *comboBox_{nullptr};
+};
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+FieldHandler::FieldHandler(const pb::FieldDescriptor *fieldDescriptor) : fieldDescriptor_(fieldDescriptor) {}
+
+FieldHandler::~FieldHandler() {}
+
+void FieldHandler::setReadOnly(bool) {
+  // Only widgets which can be typed in need to know, others put back the value when edited
+}
+
+std::unique_ptr<FieldHandler> makeFieldHandler(const pb::FieldDescriptor *fieldDescriptor) {
+  if (fieldDescriptor->is_repeated()) {
+    throw std::runtime_error("Cannot create a handler for repeated field \""+fieldDescriptor->full_name()+"\"");
+  }
+  // The only place where the type of the field is looked at
+  switch (fieldDescriptor->cpp_type()) {
+    case pb::FieldDescriptor::CppType::CPPTYPE_STRING:
+      return std::make_unique<TextFieldHandler<std::string>>(fieldDescriptor);
+    case pb::FieldDescriptor::CppType::CPPTYPE_FLOAT:
+      return std::make_unique<TextFieldHandler<float>>(fieldDescriptor);
+    case pb::FieldDescriptor::CppType::CPPTYPE_DOUBLE:
+      return std::make_unique<TextFieldHandler<double>>(fieldDescriptor);
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT32:
+      return std::make_unique<TextFieldHandler<int32_t>>(fieldDescriptor);
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT32:
+      return std::make_unique<TextFieldHandler<uint32_t>>(fieldDescriptor);
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT64:
+      return std::make_unique<TextFieldHandler<int64_t>>(fieldDescriptor);
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT64:
+      return std::make_unique<TextFieldHandler<uint64_t>>(fieldDescriptor);
+    case pb::FieldDescriptor::CppType::CPPTYPE_BOOL:
+      return std::make_unique<BoolFieldHandler>(fieldDescriptor);
+    case pb::FieldDescriptor::CppType::CPPTYPE_ENUM:
+      return std::make_unique<EnumFieldHandler>(fieldDescriptor);
+    default:
+      throw std::runtime_error("Cannot create a handler for message field \""+fieldDescriptor->full_name()+"\"");
+  }
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
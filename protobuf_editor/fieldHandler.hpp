@@ -0,0 +1,39 @@
+#ifndef PROTOBUF_EDITOR_FIELD_HANDLER_HPP_
+#define PROTOBUF_EDITOR_FIELD_HANDLER_HPP_
+
+#include <google/protobuf/message.h>
+
+#include <QWidget>
+
+#include <functional>
+#include <memory>
+
+namespace protobuf_editor {
+
+// Moves the value of one singular, non-message field between a message and the widget which shows it. The type of the
+//  field is resolved once, when the handler is created by makeFieldHandler, after which reading and writing go
+//  straight to the matching Reflection getter/setter and widget, without switching on the field's type again.
+class FieldHandler {
+public:
+  explicit FieldHandler(const google::protobuf::FieldDescriptor *fieldDescriptor);
+  virtual ~FieldHandler();
+  // Creates the widget which shows the value. `onEdited` is called whenever the user edits it.
+  virtual QWidget* createWidget(std::function<void()> onEdited) = 0;
+  // Shows the value which is in the message
+  virtual void readFromMessage(const google::protobuf::Message &message) = 0;
+  // Writes the value which is shown into the message. Returns false if it could not be parsed, in which case the
+  //  message is untouched.
+  virtual bool writeToMessage(google::protobuf::Message *message) const = 0;
+  // Writes the field's default value into the message
+  virtual void writeDefaultToMessage(google::protobuf::Message *message) const = 0;
+  virtual void setReadOnly(bool readOnly);
+protected:
+  const google::protobuf::FieldDescriptor* const fieldDescriptor_;
+};
+
+// Throws if the field is a message or repeated
+std::unique_ptr<FieldHandler> makeFieldHandler(const google::protobuf::FieldDescriptor *fieldDescriptor);
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_FIELD_HANDLER_HPP_
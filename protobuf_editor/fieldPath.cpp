@@ -0,0 +1,179 @@
+#include "fieldPath.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+
+namespace pb = google::protobuf;
+
+namespace {
+
+std::tuple<int, int> sortKey(const protobuf_editor::FieldPath::Element &element) {
+  // Every element of two paths which share a root and a prefix belongs to the same message, so the field number
+  //  is enough to identify the field
+  return {element.fieldDescriptor->number(), element.index};
+}
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+FieldPath::FieldPath(const pb::FieldDescriptor *fieldDescriptor, int index) {
+  append(fieldDescriptor, index);
+}
+
+FieldPath FieldPath::parse(const pb::Descriptor *rootDescriptor, const std::string &path) {
+  FieldPath result;
+  const pb::Descriptor *descriptor = rootDescriptor;
+  size_t position = 0;
+  while (position <= path.size()) {
+    if (descriptor == nullptr) {
+      throw std::runtime_error("Field path \""+path+"\" continues past a field which is not a message");
+    }
+    const size_t end = std::min(path.find('.', position), path.size());
+    std::string name = path.substr(position, end-position);
+    int index = -1;
+    const size_t bracket = name.find('[');
+    if (bracket != std::string::npos) {
+      if (name.back() != ']') {
+        throw std::runtime_error("Field path \""+path+"\" has an unterminated index");
+      }
+      const std::string indexString = name.substr(bracket+1, name.size()-bracket-2);
+      try {
+        size_t parsedLength;
+        index = std::stoi(indexString, &parsedLength);
+        if (parsedLength != indexString.size() || index < 0) {
+          throw std::invalid_argument(indexString);
+        }
+      } catch (const std::logic_error &) {
+        throw std::runtime_error("Field path \""+path+"\" has an invalid index \""+indexString+"\"");
+      }
+      name.resize(bracket);
+    }
+    const pb::FieldDescriptor *fieldDescriptor = descriptor->FindFieldByName(name);
+    if (fieldDescriptor == nullptr) {
+      throw std::runtime_error("\""+descriptor->full_name()+"\" has no field named \""+name+"\"");
+    }
+    if (index != -1 && !fieldDescriptor->is_repeated()) {
+      throw std::runtime_error("Field path \""+path+"\" indexes into \""+name+"\", which is not repeated");
+    }
+    result.append(fieldDescriptor, index);
+    // Only a single message can be descended into, not a whole repeated field
+    const bool canDescend = fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE && (!fieldDescriptor->is_repeated() || index != -1);
+    descriptor = (canDescend ? fieldDescriptor->message_type() : nullptr);
+    position = end+1;
+  }
+  return result;
+}
+
+bool FieldPath::empty() const {
+  return elements_.empty();
+}
+
+size_t FieldPath::size() const {
+  return elements_.size();
+}
+
+const FieldPath::Element& FieldPath::front() const {
+  return elements_.front();
+}
+
+const FieldPath::Element& FieldPath::back() const {
+  return elements_.back();
+}
+
+const FieldPath::Element& FieldPath::at(size_t position) const {
+  return elements_.at(position);
+}
+
+std::vector<FieldPath::Element>::const_iterator FieldPath::begin() const {
+  return elements_.begin();
+}
+
+std::vector<FieldPath::Element>::const_iterator FieldPath::end() const {
+  return elements_.end();
+}
+
+void FieldPath::prepend(const pb::FieldDescriptor *fieldDescriptor, int index) {
+  elements_.insert(elements_.begin(), Element{fieldDescriptor, index});
+}
+
+void FieldPath::append(const pb::FieldDescriptor *fieldDescriptor, int index) {
+  elements_.push_back(Element{fieldDescriptor, index});
+}
+
+bool FieldPath::startsWith(const FieldPath &prefix) const {
+  if (prefix.size() > size()) {
+    return false;
+  }
+  return std::equal(prefix.begin(), prefix.end(), begin(), [](const Element &lhs, const Element &rhs){
+    return lhs.fieldDescriptor == rhs.fieldDescriptor && lhs.index == rhs.index;
+  });
+}
+
+const pb::Message* FieldPath::resolveContainingMessage(const pb::Message &rootMessage) const {
+  const pb::Message *message = &rootMessage;
+  for (size_t position=0; position+1<elements_.size(); ++position) {
+    const Element &element = elements_.at(position);
+    const pb::Reflection *reflection = message->GetReflection();
+    if (element.index != -1) {
+      if (element.index >= reflection->FieldSize(*message, element.fieldDescriptor)) {
+        return nullptr;
+      }
+      message = &reflection->GetRepeatedMessage(*message, element.fieldDescriptor, element.index);
+    } else {
+      if (!reflection->HasField(*message, element.fieldDescriptor)) {
+        return nullptr;
+      }
+      message = &reflection->GetMessage(*message, element.fieldDescriptor);
+    }
+  }
+  return message;
+}
+
+pb::Message* FieldPath::resolveMutableContainingMessage(pb::Message *rootMessage) const {
+  pb::Message *message = rootMessage;
+  for (size_t position=0; position+1<elements_.size(); ++position) {
+    const Element &element = elements_.at(position);
+    const pb::Reflection *reflection = message->GetReflection();
+    if (element.index != -1) {
+      if (element.index >= reflection->FieldSize(*message, element.fieldDescriptor)) {
+        throw std::runtime_error("Field path \""+toString()+"\" indexes past the end of a repeated field");
+      }
+      message = reflection->MutableRepeatedMessage(message, element.fieldDescriptor, element.index);
+    } else {
+      message = reflection->MutableMessage(message, element.fieldDescriptor);
+    }
+  }
+  return message;
+}
+
+std::string FieldPath::toString() const {
+  std::string result;
+  for (const Element &element : elements_) {
+    if (!result.empty()) {
+      result += '.';
+    }
+    result += element.fieldDescriptor->name();
+    if (element.index != -1) {
+      result += '[' + std::to_string(element.index) + ']';
+    }
+  }
+  return result;
+}
+
+bool FieldPath::operator==(const FieldPath &other) const {
+  return size() == other.size() && startsWith(other);
+}
+
+bool FieldPath::operator!=(const FieldPath &other) const {
+  return !(*this == other);
+}
+
+bool FieldPath::operator<(const FieldPath &other) const {
+  return std::lexicographical_compare(begin(), end(), other.begin(), other.end(), [](const Element &lhs, const Element &rhs){
+    return sortKey(lhs) < sortKey(rhs);
+  });
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
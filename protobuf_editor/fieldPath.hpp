@@ -0,0 +1,55 @@
+#ifndef PROTOBUF_EDITOR_FIELD_PATH_HPP_
+#define PROTOBUF_EDITOR_FIELD_PATH_HPP_
+
+#include <google/protobuf/message.h>
+
+#include <string>
+#include <vector>
+
+namespace protobuf_editor {
+
+// Identifies a field within a message, relative to some root message. Each element names a field of the message
+//  identified by the elements before it. An element with an index refers to a single element of a repeated field.
+// As a string, a path looks like "nested.opt_nested.data" or "rpt_nested[3].data".
+class FieldPath {
+public:
+  struct Element {
+    const google::protobuf::FieldDescriptor *fieldDescriptor{nullptr};
+    // -1 unless this refers to a single element of a repeated field
+    int index{-1};
+  };
+
+  FieldPath() = default;
+  explicit FieldPath(const google::protobuf::FieldDescriptor *fieldDescriptor, int index=-1);
+  // Throws if `path` does not name a field of `rootDescriptor`
+  static FieldPath parse(const google::protobuf::Descriptor *rootDescriptor, const std::string &path);
+
+  bool empty() const;
+  size_t size() const;
+  const Element& front() const;
+  const Element& back() const;
+  const Element& at(size_t position) const;
+  std::vector<Element>::const_iterator begin() const;
+  std::vector<Element>::const_iterator end() const;
+
+  void prepend(const google::protobuf::FieldDescriptor *fieldDescriptor, int index=-1);
+  void append(const google::protobuf::FieldDescriptor *fieldDescriptor, int index=-1);
+  // Returns whether `prefix` is this path or one of its ancestors
+  bool startsWith(const FieldPath &prefix) const;
+
+  // Returns the message which holds the last field of this path, or null if a message along the way is not present
+  const google::protobuf::Message* resolveContainingMessage(const google::protobuf::Message &rootMessage) const;
+  // Like resolveContainingMessage, but creates any nested message along the way which is not yet present
+  google::protobuf::Message* resolveMutableContainingMessage(google::protobuf::Message *rootMessage) const;
+
+  std::string toString() const;
+  bool operator==(const FieldPath &other) const;
+  bool operator!=(const FieldPath &other) const;
+  bool operator<(const FieldPath &other) const;
+private:
+  std::vector<Element> elements_;
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_FIELD_PATH_HPP_
@@ -0,0 +1,336 @@
+#include "fieldSearchIndex.hpp"
+#include "descriptorLayout.hpp"
+#include "fieldValue.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace pb = google::protobuf;
+
+namespace {
+
+// Scores by how the query matched, see FieldSearchIndex::search
+constexpr int kExactNameScore = 1000;
+constexpr int kNamePrefixScore = 800;
+constexpr int kNameScore = 600;
+constexpr int kPathScore = 400;
+constexpr int kValueScore = 300;
+constexpr int kFuzzyScore = 100;
+
+// The longest substrings which are indexed
+constexpr int kMaxGramLength = 3;
+// Only the beginning of longer values is indexed and searched, so that e.g. a large bytes field can't blow up the index
+constexpr int kMaxValueLength = 256;
+
+using Postings = std::unordered_map<uint64_t, std::vector<uint32_t>>;
+
+// The characters of a substring of up to kMaxGramLength characters, and its length, packed into one key
+uint64_t gramKey(const QChar *characters, int length) {
+  uint64_t key = static_cast<uint64_t>(length);
+  for (int index=0; index<length; ++index) {
+    key = (key << 16) | characters[index].unicode();
+  }
+  return key;
+}
+
+// Every distinct substring of `text` which is up to kMaxGramLength characters long
+std::vector<uint64_t> textGrams(const QString &text) {
+  std::vector<uint64_t> grams;
+  for (int length=1; length<=kMaxGramLength; ++length) {
+    for (int start=0; start+length<=text.size(); ++start) {
+      grams.push_back(gramKey(text.constData()+start, length));
+    }
+  }
+  std::sort(grams.begin(), grams.end());
+  grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+  return grams;
+}
+
+// The substrings of `query` which any text containing all of it must contain. The longest ones narrow it down most.
+std::vector<uint64_t> queryGrams(const QString &query) {
+  const int length = std::min(static_cast<int>(query.size()), kMaxGramLength);
+  std::vector<uint64_t> grams;
+  for (int start=0; start+length<=query.size(); ++start) {
+    grams.push_back(gramKey(query.constData()+start, length));
+  }
+  return grams;
+}
+
+// The substrings which any text matching `query` fuzzily must contain: each of its characters
+std::vector<uint64_t> characterGrams(const QString &query) {
+  std::vector<uint64_t> grams;
+  for (const QChar &character : query) {
+    grams.push_back(gramKey(&character, 1));
+  }
+  return grams;
+}
+
+void addPostings(Postings &postings, const QString &text, uint32_t entryIndex) {
+  for (const uint64_t gram : textGrams(text)) {
+    std::vector<uint32_t> &entries = postings[gram];
+    if (entries.empty() || entries.back() < entryIndex) {
+      // Entries are mostly added in order
+      entries.push_back(entryIndex);
+      continue;
+    }
+    auto position = std::lower_bound(entries.begin(), entries.end(), entryIndex);
+    if (*position != entryIndex) {
+      entries.insert(position, entryIndex);
+    }
+  }
+}
+
+void removePostings(Postings &postings, const QString &text, uint32_t entryIndex) {
+  for (const uint64_t gram : textGrams(text)) {
+    auto found = postings.find(gram);
+    if (found == postings.end()) {
+      continue;
+    }
+    std::vector<uint32_t> &entries = found->second;
+    auto position = std::lower_bound(entries.begin(), entries.end(), entryIndex);
+    if (position != entries.end() && *position == entryIndex) {
+      entries.erase(position);
+    }
+    if (entries.empty()) {
+      postings.erase(found);
+    }
+  }
+}
+
+// The sorted indices of the entries which have every one of `grams`
+std::vector<uint32_t> lookUp(const Postings &postings, const std::vector<uint64_t> &grams) {
+  std::vector<const std::vector<uint32_t>*> lists;
+  for (const uint64_t gram : grams) {
+    auto found = postings.find(gram);
+    if (found == postings.end()) {
+      return {};
+    }
+    lists.push_back(&found->second);
+  }
+  if (lists.empty()) {
+    return {};
+  }
+  // Intersecting from the shortest list keeps every intermediate result small
+  std::sort(lists.begin(), lists.end(), [](const std::vector<uint32_t> *lhs, const std::vector<uint32_t> *rhs){
+    return lhs->size() < rhs->size();
+  });
+  std::vector<uint32_t> result = *lists.front();
+  std::vector<uint32_t> intersection;
+  for (size_t listIndex=1; listIndex<lists.size() && !result.empty(); ++listIndex) {
+    intersection.clear();
+    std::set_intersection(result.begin(), result.end(), lists.at(listIndex)->begin(), lists.at(listIndex)->end(), std::back_inserter(intersection));
+    result.swap(intersection);
+  }
+  return result;
+}
+
+// Returns a score if every character of `query` appears in `text` in order, higher the closer together they are, or -1
+int fuzzyScore(const QString &query, const QString &text) {
+  int textPosition = 0;
+  int gaps = 0;
+  for (const QChar character : query) {
+    const int found = text.indexOf(character, textPosition);
+    if (found == -1) {
+      return -1;
+    }
+    gaps += found - textPosition;
+    textPosition = found+1;
+  }
+  return std::max(kFuzzyScore - gaps, 1);
+}
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+struct FieldSearchIndex::SchemaEntry {
+  FieldPath path;
+  // Lowercase
+  QString name;
+  QString pathString;
+  // Only fields which are shown as a single value can be searched by value
+  bool hasValue{false};
+};
+
+struct FieldSearchIndex::Schema {
+  // In the order the widgets show them
+  std::vector<SchemaEntry> entries;
+  // Entries by path, in path order, so that the entries below a path are found with one lookup
+  std::map<FieldPath, size_t> entryByPath;
+  // The sorted indices of the entries whose path contains each substring, see gramKey. A field's name is the end of
+  //  its path, so this finds names too.
+  Postings pathPostings;
+};
+
+const FieldSearchIndex::Schema& FieldSearchIndex::schemaFor(const pb::Descriptor *descriptor) {
+  static std::mutex mutex;
+  // Like messageLayout, built the first time a type is searched and never freed
+  static std::unordered_map<const pb::Descriptor*, std::unique_ptr<Schema>> schemas;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::unique_ptr<Schema> &schema = schemas[descriptor];
+  if (schema == nullptr) {
+    schema = std::make_unique<Schema>();
+    addSchemaEntries(descriptor, FieldPath(), 0, schema->entries);
+    for (size_t entryIndex=0; entryIndex<schema->entries.size(); ++entryIndex) {
+      schema->entryByPath.emplace(schema->entries.at(entryIndex).path, entryIndex);
+      addPostings(schema->pathPostings, schema->entries.at(entryIndex).pathString, static_cast<uint32_t>(entryIndex));
+    }
+  }
+  return *schema;
+}
+
+void FieldSearchIndex::addSchemaEntries(const pb::Descriptor *descriptor, const FieldPath &prefix, int depth, std::vector<SchemaEntry> &entries) {
+  for (const FieldLayout &fieldLayout : messageLayout(descriptor).fields) {
+    if (entries.size() >= kMaxEntries) {
+      return;
+    }
+    if (fieldLayout.kind == FieldLayout::Kind::kSkipped) {
+      // There's no widget to go to
+      continue;
+    }
+    SchemaEntry entry;
+    entry.path = prefix;
+    entry.path.append(fieldLayout.fieldDescriptor);
+    entry.name = QString::fromStdString(fieldLayout.fieldDescriptor->name()).toLower();
+    entry.pathString = QString::fromStdString(entry.path.toString()).toLower();
+    // Oneof members which aren't messages have values too, they're only read while set
+    entry.hasValue = (fieldLayout.kind == FieldLayout::Kind::kBuiltIn || (fieldLayout.kind == FieldLayout::Kind::kOneof && fieldLayout.fieldDescriptor->cpp_type() != pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE));
+    entries.push_back(entry);
+    if (fieldLayout.kind == FieldLayout::Kind::kMessage && depth+1 < kMaxDepth) {
+      addSchemaEntries(fieldLayout.fieldDescriptor->message_type(), entry.path, depth+1, entries);
+    }
+  }
+}
+
+FieldSearchIndex::FieldSearchIndex(const pb::Descriptor *descriptor) : schema_(schemaFor(descriptor)) {}
+
+void FieldSearchIndex::setMessage(const pb::Message *message) {
+  message_ = message;
+  // Read again on the next search
+  valuesRead_ = false;
+  values_.clear();
+  valuePostings_.clear();
+}
+
+void FieldSearchIndex::fieldsChanged(const std::vector<FieldPath> &paths) {
+  if (!valuesRead_) {
+    // Nothing has been read yet, so there's nothing which could be out of date
+    return;
+  }
+  for (const FieldPath &path : paths) {
+    // The field itself, and anything below it, e.g. when a nested message was cleared
+    for (auto it=schema_.entryByPath.lower_bound(path); it!=schema_.entryByPath.end() && it->first.startsWith(path); ++it) {
+      readValue(it->second);
+    }
+  }
+}
+
+size_t FieldSearchIndex::size() const {
+  return schema_.entries.size();
+}
+
+void FieldSearchIndex::readValue(size_t entryIndex) {
+  const SchemaEntry &entry = schema_.entries.at(entryIndex);
+  QString &value = values_.at(entryIndex);
+  removePostings(valuePostings_, value, static_cast<uint32_t>(entryIndex));
+  value.clear();
+  if (!entry.hasValue || message_ == nullptr) {
+    return;
+  }
+  const pb::Message *containingMessage = entry.path.resolveContainingMessage(*message_);
+  const pb::FieldDescriptor *fieldDescriptor = entry.path.back().fieldDescriptor;
+  if (containingMessage == nullptr || (fieldDescriptor->has_presence() && !containingMessage->GetReflection()->HasField(*containingMessage, fieldDescriptor))) {
+    // Not set, so there's no value to find
+    return;
+  }
+  value = fieldValueToString(fieldDescriptor, readFieldValue(*containingMessage, fieldDescriptor)).left(kMaxValueLength).toLower();
+  addPostings(valuePostings_, value, static_cast<uint32_t>(entryIndex));
+}
+
+void FieldSearchIndex::readValues() {
+  values_.assign(schema_.entries.size(), QString());
+  valuePostings_.clear();
+  for (size_t entryIndex=0; entryIndex<schema_.entries.size(); ++entryIndex) {
+    readValue(entryIndex);
+  }
+  valuesRead_ = true;
+}
+
+std::vector<FieldSearchMatch> FieldSearchIndex::search(const QString &query, size_t maxResults) {
+  const QString loweredQuery = query.trimmed().toLower();
+  if (loweredQuery.isEmpty() || maxResults == 0) {
+    return {};
+  }
+  if (!valuesRead_) {
+    readValues();
+  }
+
+  // Only the fields which have every substring of the query in their path or value can contain it
+  const std::vector<uint64_t> grams = queryGrams(loweredQuery);
+  const std::vector<uint32_t> pathCandidates = lookUp(schema_.pathPostings, grams);
+  const std::vector<uint32_t> valueCandidates = lookUp(valuePostings_, grams);
+  std::vector<uint32_t> candidates;
+  std::set_union(pathCandidates.begin(), pathCandidates.end(), valueCandidates.begin(), valueCandidates.end(), std::back_inserter(candidates));
+
+  // Scores and entry indices, the paths are only copied for the results
+  std::vector<std::pair<int, size_t>> matches;
+  // Sorted, since the candidates are
+  std::vector<uint32_t> matchedEntries;
+  for (const uint32_t entryIndex : candidates) {
+    const SchemaEntry &entry = schema_.entries.at(entryIndex);
+    int score;
+    if (entry.name == loweredQuery) {
+      score = kExactNameScore;
+    } else if (entry.name.startsWith(loweredQuery)) {
+      score = kNamePrefixScore;
+    } else if (entry.name.contains(loweredQuery)) {
+      score = kNameScore;
+    } else if (entry.pathString.contains(loweredQuery)) {
+      score = kPathScore;
+    } else if (values_.at(entryIndex).contains(loweredQuery)) {
+      score = kValueScore;
+    } else {
+      // Has all of the substrings, but not in the right order
+      continue;
+    }
+    // Between equally good matches, prefer the ones nearer to the root
+    score -= static_cast<int>(entry.path.size());
+    matches.emplace_back(score, entryIndex);
+    matchedEntries.push_back(entryIndex);
+  }
+
+  // Fuzzy matches always score below the others, so they're only looked for if there aren't enough results yet, and
+  //  only in the paths which have every character of the query
+  if (matches.size() < maxResults) {
+    for (const uint32_t entryIndex : lookUp(schema_.pathPostings, characterGrams(loweredQuery))) {
+      if (std::binary_search(matchedEntries.begin(), matchedEntries.end(), entryIndex)) {
+        continue;
+      }
+      const SchemaEntry &entry = schema_.entries.at(entryIndex);
+      const int score = fuzzyScore(loweredQuery, entry.pathString);
+      if (score != -1) {
+        matches.emplace_back(score - static_cast<int>(entry.path.size()), entryIndex);
+      }
+    }
+  }
+
+  // Only the best few are needed, don't sort all of them
+  const size_t resultCount = std::min(maxResults, matches.size());
+  std::partial_sort(matches.begin(), matches.begin()+resultCount, matches.end(), [](const std::pair<int, size_t> &lhs, const std::pair<int, size_t> &rhs){
+    // Between equal scores, keep the order in which the widgets show the fields
+    return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+  });
+  std::vector<FieldSearchMatch> results;
+  results.reserve(resultCount);
+  for (size_t resultIndex=0; resultIndex<resultCount; ++resultIndex) {
+    results.push_back({schema_.entries.at(matches.at(resultIndex).second).path, matches.at(resultIndex).first});
+  }
+  return results;
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
@@ -0,0 +1,64 @@
+#ifndef PROTOBUF_EDITOR_FIELD_SEARCH_INDEX_HPP_
+#define PROTOBUF_EDITOR_FIELD_SEARCH_INDEX_HPP_
+
+#include "fieldPath.hpp"
+
+#include <google/protobuf/message.h>
+
+#include <QString>
+
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace protobuf_editor {
+
+struct FieldSearchMatch {
+  FieldPath path;
+  // Higher is better
+  int score{0};
+};
+
+// Finds fields of a message by name, by path, or by their current value. Every field which the widgets can show is
+//  listed once per message type, and shared by every index for that type. Nested messages are followed down to
+//  kMaxDepth levels, and no more than kMaxEntries fields are listed, which bounds the list for recursive types.
+//  Repeated fields are listed, but not their elements.
+// Values are only read once something is searched for, and after that only the fields which were edited are re-read.
+// Searches don't look at every field. Every substring of up to three characters of a field's path, and of its value,
+//  is indexed, and only the fields which have all of the query's substrings are compared against it.
+class FieldSearchIndex {
+public:
+  static constexpr int kMaxDepth = 8;
+  static constexpr size_t kMaxEntries = 100000;
+
+  explicit FieldSearchIndex(const google::protobuf::Descriptor *descriptor);
+  // The message whose values are searched. Null to only search names.
+  void setMessage(const google::protobuf::Message *message);
+  // To be called with the paths of fields which changed, see ProtobufFieldWidget::fieldsChanged
+  void fieldsChanged(const std::vector<FieldPath> &paths);
+  // Matches, case-insensitively, the query as a substring of a field's name, path or value, and otherwise as a fuzzy
+  //  match of the path, where the query's characters appear in order but not necessarily next to each other. The best
+  //  matches come first.
+  std::vector<FieldSearchMatch> search(const QString &query, size_t maxResults);
+  // The number of fields which can be found
+  size_t size() const;
+private:
+  struct SchemaEntry;
+  struct Schema;
+  const Schema &schema_;
+  const google::protobuf::Message *message_{nullptr};
+  // Lowercase, parallel to the schema's entries. Empty for fields without a value.
+  std::vector<QString> values_;
+  // The sorted indices of the entries whose value contains each substring, see gramKey
+  std::unordered_map<uint64_t, std::vector<uint32_t>> valuePostings_;
+  bool valuesRead_{false};
+  static const Schema& schemaFor(const google::protobuf::Descriptor *descriptor);
+  static void addSchemaEntries(const google::protobuf::Descriptor *descriptor, const FieldPath &prefix, int depth, std::vector<SchemaEntry> &entries);
+  void readValue(size_t entryIndex);
+  void readValues();
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_FIELD_SEARCH_INDEX_HPP_
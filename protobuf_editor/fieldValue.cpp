@@ -0,0 +1,215 @@
+#include "fieldValue.hpp"
+
+namespace pb = google::protobuf;
+
+namespace protobuf_editor {
+
+QVariant readFieldValue(const pb::Message &message, const pb::FieldDescriptor *fieldDescriptor, int index) {
+  const pb::Reflection *reflection = message.GetReflection();
+  const bool repeated = (index != -1);
+  switch (fieldDescriptor->cpp_type()) {
+    case pb::FieldDescriptor::CppType::CPPTYPE_STRING: {
+      const std::string data = repeated ? reflection->GetRepeatedString(message, fieldDescriptor, index) : reflection->GetString(message, fieldDescriptor);
+      return QString::fromStdString(data);
+    }
+    case pb::FieldDescriptor::CppType::CPPTYPE_FLOAT:
+      return repeated ? reflection->GetRepeatedFloat(message, fieldDescriptor, index) : reflection->GetFloat(message, fieldDescriptor);
+    case pb::FieldDescriptor::CppType::CPPTYPE_DOUBLE:
+      return repeated ? reflection->GetRepeatedDouble(message, fieldDescriptor, index) : reflection->GetDouble(message, fieldDescriptor);
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT32:
+      return repeated ? reflection->GetRepeatedInt32(message, fieldDescriptor, index) : reflection->GetInt32(message, fieldDescriptor);
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT32:
+      return repeated ? reflection->GetRepeatedUInt32(message, fieldDescriptor, index) : reflection->GetUInt32(message, fieldDescriptor);
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT64:
+      return static_cast<qlonglong>(repeated ? reflection->GetRepeatedInt64(message, fieldDescriptor, index) : reflection->GetInt64(message, fieldDescriptor));
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT64:
+      return static_cast<qulonglong>(repeated ? reflection->GetRepeatedUInt64(message, fieldDescriptor, index) : reflection->GetUInt64(message, fieldDescriptor));
+    case pb::FieldDescriptor::CppType::CPPTYPE_BOOL:
+      return repeated ? reflection->GetRepeatedBool(message, fieldDescriptor, index) : reflection->GetBool(message, fieldDescriptor);
+    case pb::FieldDescriptor::CppType::CPPTYPE_ENUM:
+      return repeated ? reflection->GetRepeatedEnumValue(message, fieldDescriptor, index) : reflection->GetEnumValue(message, fieldDescriptor);
+    default:
+      throw std::runtime_error("Cannot read the value of a message field");
+  }
+}
+
+bool writeFieldValue(pb::Message *message, const pb::FieldDescriptor *fieldDescriptor, const QVariant &value, int index) {
+  const pb::Reflection *reflection = message->GetReflection();
+  const bool repeated = (index != -1);
+  bool success = true;
+  switch (fieldDescriptor->cpp_type()) {
+    case pb::FieldDescriptor::CppType::CPPTYPE_STRING: {
+      const std::string data = value.toString().toStdString();
+      if (repeated) {
+        reflection->SetRepeatedString(message, fieldDescriptor, index, data);
+      } else {
+        reflection->SetString(message, fieldDescriptor, data);
+      }
+      break;
+    }
+    case pb::FieldDescriptor::CppType::CPPTYPE_FLOAT: {
+      const auto data = value.toFloat(&success);
+      if (success) {
+        repeated ? reflection->SetRepeatedFloat(message, fieldDescriptor, index, data) : reflection->SetFloat(message, fieldDescriptor, data);
+      }
+      break;
+    }
+    case pb::FieldDescriptor::CppType::CPPTYPE_DOUBLE: {
+      const auto data = value.toDouble(&success);
+      if (success) {
+        repeated ? reflection->SetRepeatedDouble(message, fieldDescriptor, index, data) : reflection->SetDouble(message, fieldDescriptor, data);
+      }
+      break;
+    }
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT32: {
+      const auto data = value.toInt(&success);
+      if (success) {
+        repeated ? reflection->SetRepeatedInt32(message, fieldDescriptor, index, data) : reflection->SetInt32(message, fieldDescriptor, data);
+      }
+      break;
+    }
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT32: {
+      const auto data = value.toUInt(&success);
+      if (success) {
+        repeated ? reflection->SetRepeatedUInt32(message, fieldDescriptor, index, data) : reflection->SetUInt32(message, fieldDescriptor, data);
+      }
+      break;
+    }
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT64: {
+      const auto data = value.toLongLong(&success);
+      if (success) {
+        repeated ? reflection->SetRepeatedInt64(message, fieldDescriptor, index, data) : reflection->SetInt64(message, fieldDescriptor, data);
+      }
+      break;
+    }
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT64: {
+      const auto data = value.toULongLong(&success);
+      if (success) {
+        repeated ? reflection->SetRepeatedUInt64(message, fieldDescriptor, index, data) : reflection->SetUInt64(message, fieldDescriptor, data);
+      }
+      break;
+    }
+    case pb::FieldDescriptor::CppType::CPPTYPE_BOOL: {
+      const bool data = value.toBool();
+      repeated ? reflection->SetRepeatedBool(message, fieldDescriptor, index, data) : reflection->SetBool(message, fieldDescriptor, data);
+      break;
+    }
+    case pb::FieldDescriptor::CppType::CPPTYPE_ENUM: {
+      const auto number = value.toInt(&success);
+      // Only accept values which are defined by the enum
+      success = success && fieldDescriptor->enum_type()->FindValueByNumber(number) != nullptr;
+      if (success) {
+        repeated ? reflection->SetRepeatedEnumValue(message, fieldDescriptor, index, number) : reflection->SetEnumValue(message, fieldDescriptor, number);
+      }
+      break;
+    }
+    default:
+      throw std::runtime_error("Cannot write the value of a message field");
+  }
+  return success;
+}
+
+void writeDefaultFieldValue(pb::Message *message, const pb::FieldDescriptor *fieldDescriptor) {
+  switch (fieldDescriptor->cpp_type()) {
+    case pb::FieldDescriptor::CppType::CPPTYPE_STRING:
+      writeFieldValue(message, fieldDescriptor, QString::fromStdString(fieldDescriptor->default_value_string()));
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_FLOAT:
+      writeFieldValue(message, fieldDescriptor, fieldDescriptor->default_value_float());
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_DOUBLE:
+      writeFieldValue(message, fieldDescriptor, fieldDescriptor->default_value_double());
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT32:
+      writeFieldValue(message, fieldDescriptor, fieldDescriptor->default_value_int32());
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT32:
+      writeFieldValue(message, fieldDescriptor, fieldDescriptor->default_value_uint32());
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT64:
+      writeFieldValue(message, fieldDescriptor, static_cast<qlonglong>(fieldDescriptor->default_value_int64()));
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT64:
+      writeFieldValue(message, fieldDescriptor, static_cast<qulonglong>(fieldDescriptor->default_value_uint64()));
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_BOOL:
+      writeFieldValue(message, fieldDescriptor, fieldDescriptor->default_value_bool());
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_ENUM:
+      writeFieldValue(message, fieldDescriptor, fieldDescriptor->default_value_enum()->number());
+      break;
+    default:
+      throw std::runtime_error("Cannot write the default value of a message field");
+  }
+}
+
+void appendDefaultFieldValue(pb::Message *message, const pb::FieldDescriptor *fieldDescriptor) {
+  const pb::Reflection *reflection = message->GetReflection();
+  switch (fieldDescriptor->cpp_type()) {
+    case pb::FieldDescriptor::CppType::CPPTYPE_STRING:
+      reflection->AddString(message, fieldDescriptor, fieldDescriptor->default_value_string());
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_FLOAT:
+      reflection->AddFloat(message, fieldDescriptor, fieldDescriptor->default_value_float());
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_DOUBLE:
+      reflection->AddDouble(message, fieldDescriptor, fieldDescriptor->default_value_double());
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT32:
+      reflection->AddInt32(message, fieldDescriptor, fieldDescriptor->default_value_int32());
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT32:
+      reflection->AddUInt32(message, fieldDescriptor, fieldDescriptor->default_value_uint32());
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT64:
+      reflection->AddInt64(message, fieldDescriptor, fieldDescriptor->default_value_int64());
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT64:
+      reflection->AddUInt64(message, fieldDescriptor, fieldDescriptor->default_value_uint64());
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_BOOL:
+      reflection->AddBool(message, fieldDescriptor, fieldDescriptor->default_value_bool());
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_ENUM:
+      reflection->AddEnum(message, fieldDescriptor, fieldDescriptor->default_value_enum());
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE:
+      reflection->AddMessage(message, fieldDescriptor);
+      break;
+  }
+}
+
+QString fieldValueToString(const pb::FieldDescriptor *fieldDescriptor, const QVariant &value) {
+  if (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_ENUM) {
+    const pb::EnumValueDescriptor *enumValueDescriptor = fieldDescriptor->enum_type()->FindValueByNumber(value.toInt());
+    if (enumValueDescriptor == nullptr) {
+      // Open enums can hold values which are not defined
+      return QString::number(value.toInt());
+    }
+    return QString::fromStdString(enumValueDescriptor->name());
+  }
+  if (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_BOOL) {
+    return value.toBool() ? QStringLiteral("true") : QStringLiteral("false");
+  }
+  return value.toString();
+}
+
+QString fieldTypeName(const pb::FieldDescriptor *fieldDescriptor) {
+  QString typeName;
+  if (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE) {
+    typeName = QString::fromStdString(fieldDescriptor->message_type()->full_name());
+  } else if (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_ENUM) {
+    typeName = QString::fromStdString(fieldDescriptor->enum_type()->full_name());
+  } else {
+    typeName = QString::fromLatin1(fieldDescriptor->type_name());
+  }
+  if (fieldDescriptor->is_map()) {
+    return QStringLiteral("map ") + typeName;
+  }
+  if (fieldDescriptor->is_repeated()) {
+    return QStringLiteral("repeated ") + typeName;
+  }
+  return typeName;
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef PROTOBUF_EDITOR_FIELD_VALUE_HPP_
+#define PROTOBUF_EDITOR_FIELD_VALUE_HPP_
+
+#include <google/protobuf/message.h>
+
+#include <QMetaType>
+#include <QString>
+#include <QVariant>
+
+// Allows passing a field descriptor through the item model roles, so that delegates know what they're editing
+Q_DECLARE_METATYPE(const google::protobuf::FieldDescriptor*)
+
+namespace protobuf_editor {
+
+// Reads the value of a non-message field as a QVariant. Enums are read as their number.
+// If `index` is not -1, the field is repeated and the element at `index` is read.
+QVariant readFieldValue(const google::protobuf::Message &message, const google::protobuf::FieldDescriptor *fieldDescriptor, int index=-1);
+
+// Writes `value` to a non-message field. Strings are parsed into the field's type, so text from a QLineEdit can be
+//  passed directly. Returns false if the value could not be converted, in which case the message is untouched.
+bool writeFieldValue(google::protobuf::Message *message, const google::protobuf::FieldDescriptor *fieldDescriptor, const QVariant &value, int index=-1);
+
+// Writes the field's default value
+void writeDefaultFieldValue(google::protobuf::Message *message, const google::protobuf::FieldDescriptor *fieldDescriptor);
+
+// Appends an element with the field's default value to a repeated field
+void appendDefaultFieldValue(google::protobuf::Message *message, const google::protobuf::FieldDescriptor *fieldDescriptor);
+
+// Formats a value as returned by `readFieldValue` for display. Enums are shown by name.
+QString fieldValueToString(const google::protobuf::FieldDescriptor *fieldDescriptor, const QVariant &value);
+
+// A human readable name of the field's type, e.g. "int32", "repeated proto.test.Nested2"
+QString fieldTypeName(const google::protobuf::FieldDescriptor *fieldDescriptor);
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_FIELD_VALUE_HPP_
@@ -0,0 +1,223 @@
+#include "instrumentation.hpp"
+
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+
+namespace {
+
+std::atomic<int> currentLogLevel{static_cast<int>(protobuf_editor::LogLevel::kWarning)};
+
+#ifdef PROTOBUF_EDITOR_INSTRUMENTATION
+
+// Small numbers are easier to tell apart in a trace viewer than the platform's thread ids
+uint64_t currentThreadId() {
+  static std::atomic<uint64_t> nextThreadId{1};
+  thread_local const uint64_t threadId = nextThreadId++;
+  return threadId;
+}
+
+double toMicroseconds(int64_t nanoseconds) {
+  return static_cast<double>(nanoseconds) / 1000.0;
+}
+
+#endif // PROTOBUF_EDITOR_INSTRUMENTATION
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+void setLogLevel(LogLevel level) {
+  currentLogLevel = static_cast<int>(level);
+}
+
+LogLevel logLevel() {
+  return static_cast<LogLevel>(currentLogLevel.load(std::memory_order_relaxed));
+}
+
+bool logEnabled(LogLevel level) {
+  return static_cast<int>(level) >= currentLogLevel.load(std::memory_order_relaxed);
+}
+
+void logMessage(LogLevel level, const QString &message) {
+  if (!logEnabled(level)) {
+    return;
+  }
+#ifdef PROTOBUF_EDITOR_INSTRUMENTATION
+  Instrumentation::instance().recordLogMessage(level, message);
+#endif
+  switch (level) {
+    case LogLevel::kDebug:
+      qDebug().noquote() << message;
+      break;
+    case LogLevel::kInfo:
+      qInfo().noquote() << message;
+      break;
+    case LogLevel::kWarning:
+      qWarning().noquote() << message;
+      break;
+    case LogLevel::kError:
+      qCritical().noquote() << message;
+      break;
+  }
+}
+
+LogLevel parseLogLevel(const QString &name) {
+  const QString lowerName = name.toLower();
+  if (lowerName == "debug") {
+    return LogLevel::kDebug;
+  }
+  if (lowerName == "info") {
+    return LogLevel::kInfo;
+  }
+  if (lowerName == "warning") {
+    return LogLevel::kWarning;
+  }
+  if (lowerName == "error") {
+    return LogLevel::kError;
+  }
+  throw std::runtime_error("Unknown log level \""+name.toStdString()+"\", expected debug, info, warning or error");
+}
+
+#ifdef PROTOBUF_EDITOR_INSTRUMENTATION
+
+Instrumentation& Instrumentation::instance() {
+  static Instrumentation instrumentation;
+  return instrumentation;
+}
+
+int64_t Instrumentation::now() const {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch_).count();
+}
+
+void Instrumentation::recordScope(std::string name, int64_t startNanoseconds, int64_t durationNanoseconds) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ScopeStatistics &statistics = scopeStatistics_[name];
+  ++statistics.count;
+  statistics.totalNanoseconds += durationNanoseconds;
+  statistics.maxNanoseconds = std::max(statistics.maxNanoseconds, durationNanoseconds);
+  Event event;
+  event.name = std::move(name);
+  event.startNanoseconds = startNanoseconds;
+  event.durationNanoseconds = durationNanoseconds;
+  event.threadId = currentThreadId();
+  pushEvent(std::move(event));
+}
+
+void Instrumentation::addToCounter(const std::string &name, int64_t delta) {
+  const int64_t timestamp = now();
+  std::lock_guard<std::mutex> lock(mutex_);
+  int64_t &value = counters_[name];
+  value += delta;
+  Event event;
+  event.name = name;
+  event.startNanoseconds = timestamp;
+  event.isCounter = true;
+  event.counterValue = value;
+  event.threadId = currentThreadId();
+  pushEvent(std::move(event));
+}
+
+void Instrumentation::recordLogMessage(LogLevel level, const QString &message) {
+  const int64_t timestamp = now();
+  std::lock_guard<std::mutex> lock(mutex_);
+  logMessages_.push_back(LogEntry{timestamp, level, message});
+  if (logMessages_.size() > kMaxLogMessages) {
+    logMessages_.pop_front();
+  }
+}
+
+void Instrumentation::pushEvent(Event event) {
+  // The mutex is held by the caller
+  events_.push_back(std::move(event));
+  if (events_.size() > kMaxEvents) {
+    events_.pop_front();
+  }
+}
+
+void Instrumentation::reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  events_.clear();
+  scopeStatistics_.clear();
+  counters_.clear();
+  logMessages_.clear();
+}
+
+std::unordered_map<std::string, Instrumentation::ScopeStatistics> Instrumentation::scopeStatistics() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return scopeStatistics_;
+}
+
+std::unordered_map<std::string, int64_t> Instrumentation::counters() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return counters_;
+}
+
+std::vector<Instrumentation::LogEntry> Instrumentation::recentLogMessages() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return std::vector<LogEntry>(logMessages_.begin(), logMessages_.end());
+}
+
+void Instrumentation::exportChromeTrace(const QString &path) const {
+  QJsonArray traceEvents;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const Event &event : events_) {
+      QJsonObject traceEvent;
+      traceEvent["name"] = QString::fromStdString(event.name);
+      traceEvent["pid"] = 1;
+      traceEvent["tid"] = static_cast<qint64>(event.threadId);
+      traceEvent["ts"] = toMicroseconds(event.startNanoseconds);
+      if (event.isCounter) {
+        traceEvent["ph"] = "C";
+        traceEvent["args"] = QJsonObject{{"value", static_cast<qint64>(event.counterValue)}};
+      } else {
+        traceEvent["ph"] = "X";
+        traceEvent["cat"] = "editor";
+        traceEvent["dur"] = toMicroseconds(event.durationNanoseconds);
+      }
+      traceEvents.append(traceEvent);
+    }
+    for (const LogEntry &entry : logMessages_) {
+      // Instant events, which show up as markers
+      QJsonObject traceEvent;
+      traceEvent["name"] = entry.message;
+      traceEvent["cat"] = "log";
+      traceEvent["ph"] = "i";
+      traceEvent["s"] = "g";
+      traceEvent["pid"] = 1;
+      traceEvent["tid"] = 0;
+      traceEvent["ts"] = toMicroseconds(entry.timestampNanoseconds);
+      traceEvents.append(traceEvent);
+    }
+  }
+  QJsonObject trace;
+  trace["traceEvents"] = traceEvents;
+  trace["displayTimeUnit"] = "ms";
+
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly)) {
+    throw std::runtime_error("Failed to open \""+path.toStdString()+"\": "+file.errorString().toStdString());
+  }
+  file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact));
+  if (!file.commit()) {
+    throw std::runtime_error("Failed to write \""+path.toStdString()+"\": "+file.errorString().toStdString());
+  }
+}
+
+TimingScope::TimingScope(std::string name) : name_(std::move(name)), startNanoseconds_(Instrumentation::instance().now()) {}
+
+TimingScope::~TimingScope() {
+  Instrumentation &instrumentation = Instrumentation::instance();
+  instrumentation.recordScope(std::move(name_), startNanoseconds_, instrumentation.now() - startNanoseconds_);
+}
+
+#endif // PROTOBUF_EDITOR_INSTRUMENTATION
+
+} // namespace protobuf_editor
\ No newline at end of file
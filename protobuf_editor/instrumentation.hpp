@@ -0,0 +1,120 @@
+#ifndef PROTOBUF_EDITOR_INSTRUMENTATION_HPP_
+#define PROTOBUF_EDITOR_INSTRUMENTATION_HPP_
+
+#include <QString>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace protobuf_editor {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Logging. Always compiled in. Messages below the log level are dropped before they're formatted, as long as the
+//  caller checks logEnabled first. The rest go to Qt's message handler, and to the instrumentation's recent log.
+
+enum class LogLevel {
+  kDebug,
+  kInfo,
+  kWarning,
+  kError
+};
+
+// Defaults to kWarning
+void setLogLevel(LogLevel level);
+LogLevel logLevel();
+bool logEnabled(LogLevel level);
+void logMessage(LogLevel level, const QString &message);
+// Accepts "debug", "info", "warning" and "error". Throws for anything else.
+LogLevel parseLogLevel(const QString &name);
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Timing and counters. Only compiled in when configured with -DPROTOBUF_EDITOR_INSTRUMENTATION=ON; otherwise the
+//  macros below expand to nothing and their arguments are never evaluated.
+
+#ifdef PROTOBUF_EDITOR_INSTRUMENTATION
+
+class Instrumentation {
+public:
+  // Only this many of the most recent timed scopes and log messages are kept for the trace. The statistics count
+  //  every scope.
+  static constexpr size_t kMaxEvents = 1 << 16;
+  static constexpr size_t kMaxLogMessages = 1000;
+
+  struct ScopeStatistics {
+    uint64_t count{0};
+    int64_t totalNanoseconds{0};
+    int64_t maxNanoseconds{0};
+  };
+  struct LogEntry {
+    int64_t timestampNanoseconds{0};
+    LogLevel level{LogLevel::kInfo};
+    QString message;
+  };
+
+  static Instrumentation& instance();
+  // Nanoseconds since the instrumentation was first used
+  int64_t now() const;
+  void recordScope(std::string name, int64_t startNanoseconds, int64_t durationNanoseconds);
+  void addToCounter(const std::string &name, int64_t delta);
+  void recordLogMessage(LogLevel level, const QString &message);
+  void reset();
+
+  // Copies, so that they can be read while the editor keeps recording
+  std::unordered_map<std::string, ScopeStatistics> scopeStatistics() const;
+  std::unordered_map<std::string, int64_t> counters() const;
+  std::vector<LogEntry> recentLogMessages() const;
+  // Writes the recent scopes, with every change of a counter, in the Chrome trace event format, which can be opened
+  //  with chrome://tracing or https://ui.perfetto.dev. Throws if the file can't be written.
+  void exportChromeTrace(const QString &path) const;
+private:
+  struct Event {
+    std::string name;
+    int64_t startNanoseconds{0};
+    int64_t durationNanoseconds{0};
+    // Counter events carry the counter's new value, and have no duration
+    bool isCounter{false};
+    int64_t counterValue{0};
+    uint64_t threadId{0};
+  };
+  const std::chrono::steady_clock::time_point epoch_{std::chrono::steady_clock::now()};
+  mutable std::mutex mutex_;
+  std::deque<Event> events_;
+  std::unordered_map<std::string, ScopeStatistics> scopeStatistics_;
+  std::unordered_map<std::string, int64_t> counters_;
+  std::deque<LogEntry> logMessages_;
+  Instrumentation() = default;
+  void pushEvent(Event event);
+};
+
+// Times everything until the end of the enclosing scope
+class TimingScope {
+public:
+  explicit TimingScope(std::string name);
+  ~TimingScope();
+  TimingScope(const TimingScope&) = delete;
+  TimingScope& operator=(const TimingScope&) = delete;
+private:
+  std::string name_;
+  int64_t startNanoseconds_;
+};
+
+#define PROTOBUF_EDITOR_CONCATENATE_INNER(a, b) a##b
+#define PROTOBUF_EDITOR_CONCATENATE(a, b) PROTOBUF_EDITOR_CONCATENATE_INNER(a, b)
+#define PROTOBUF_EDITOR_TIME_SCOPE(name) ::protobuf_editor::TimingScope PROTOBUF_EDITOR_CONCATENATE(timingScope, __LINE__)(name)
+#define PROTOBUF_EDITOR_COUNT(name, delta) ::protobuf_editor::Instrumentation::instance().addToCounter((name), (delta))
+
+#else
+
+#define PROTOBUF_EDITOR_TIME_SCOPE(name) static_cast<void>(0)
+#define PROTOBUF_EDITOR_COUNT(name, delta) static_cast<void>(0)
+
+#endif // PROTOBUF_EDITOR_INSTRUMENTATION
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_INSTRUMENTATION_HPP_
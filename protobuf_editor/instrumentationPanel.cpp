@@ -0,0 +1,165 @@
+#include "instrumentationPanel.hpp"
+#include "instrumentation.hpp"
+
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QTabWidget>
+#include <QVBoxLayout>
+
+namespace {
+
+enum ScopeColumn {
+  kScopeNameColumn = 0,
+  kScopeCountColumn,
+  kScopeTotalColumn,
+  kScopeMeanColumn,
+  kScopeMaxColumn,
+  kScopeColumnCount
+};
+
+double toMilliseconds(int64_t nanoseconds) {
+  return static_cast<double>(nanoseconds) / 1e6;
+}
+
+QString logLevelName(protobuf_editor::LogLevel level) {
+  switch (level) {
+    case protobuf_editor::LogLevel::kDebug:
+      return QStringLiteral("debug");
+    case protobuf_editor::LogLevel::kInfo:
+      return QStringLiteral("info");
+    case protobuf_editor::LogLevel::kWarning:
+      return QStringLiteral("warning");
+    case protobuf_editor::LogLevel::kError:
+      return QStringLiteral("error");
+  }
+  return QString();
+}
+
+// Rebuilding a sorted view re-sorts on every row, so sorting is paused while it's filled
+class SortingPause {
+public:
+  explicit SortingPause(QTreeWidget *treeWidget) : treeWidget_(treeWidget) {
+    treeWidget_->setSortingEnabled(false);
+  }
+  ~SortingPause() {
+    treeWidget_->setSortingEnabled(true);
+  }
+private:
+  QTreeWidget *treeWidget_;
+};
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+InstrumentationPanel::InstrumentationPanel(QWidget *parent) : QWidget(parent) {
+  buildWidget();
+  refresh();
+}
+
+void InstrumentationPanel::buildWidget() {
+  scopesTreeWidget_ = new QTreeWidget;
+  scopesTreeWidget_->setColumnCount(kScopeColumnCount);
+  scopesTreeWidget_->setHeaderLabels({tr("Scope"), tr("Count"), tr("Total (ms)"), tr("Mean (ms)"), tr("Max (ms)")});
+  scopesTreeWidget_->setRootIsDecorated(false);
+  scopesTreeWidget_->setUniformRowHeights(true);
+  scopesTreeWidget_->header()->setSectionResizeMode(kScopeNameColumn, QHeaderView::Stretch);
+  scopesTreeWidget_->setSortingEnabled(true);
+  scopesTreeWidget_->sortByColumn(kScopeTotalColumn, Qt::DescendingOrder);
+
+  countersTreeWidget_ = new QTreeWidget;
+  countersTreeWidget_->setColumnCount(2);
+  countersTreeWidget_->setHeaderLabels({tr("Counter"), tr("Value")});
+  countersTreeWidget_->setRootIsDecorated(false);
+  countersTreeWidget_->setUniformRowHeights(true);
+  countersTreeWidget_->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+  countersTreeWidget_->setSortingEnabled(true);
+  countersTreeWidget_->sortByColumn(1, Qt::DescendingOrder);
+
+  logTextEdit_ = new QPlainTextEdit;
+  logTextEdit_->setReadOnly(true);
+  logTextEdit_->setLineWrapMode(QPlainTextEdit::NoWrap);
+
+  QTabWidget *tabWidget = new QTabWidget;
+  tabWidget->addTab(scopesTreeWidget_, tr("Timings"));
+  tabWidget->addTab(countersTreeWidget_, tr("Counters"));
+  tabWidget->addTab(logTextEdit_, tr("Log"));
+
+  QPushButton *refreshButton = new QPushButton(tr("Refresh"));
+  connect(refreshButton, &QPushButton::clicked, this, &InstrumentationPanel::refresh);
+  QPushButton *resetButton = new QPushButton(tr("Reset"));
+  connect(resetButton, &QPushButton::clicked, [this]{
+    Instrumentation::instance().reset();
+    refresh();
+  });
+  QPushButton *exportButton = new QPushButton(tr("Export Chrome Trace..."));
+  connect(exportButton, &QPushButton::clicked, this, &InstrumentationPanel::exportChromeTrace);
+
+  QHBoxLayout *buttonLayout = new QHBoxLayout;
+  buttonLayout->addWidget(refreshButton);
+  buttonLayout->addWidget(resetButton);
+  buttonLayout->addStretch(1);
+  buttonLayout->addWidget(exportButton);
+
+  QVBoxLayout *layout = new QVBoxLayout(this);
+  layout->addWidget(tabWidget, 1);
+  layout->addLayout(buttonLayout);
+
+  // Only while it can be seen, reading the statistics takes the instrumentation's lock
+  refreshTimer_ = new QTimer(this);
+  refreshTimer_->setInterval(kRefreshIntervalMilliseconds);
+  connect(refreshTimer_, &QTimer::timeout, [this]{
+    if (isVisible()) {
+      refresh();
+    }
+  });
+  refreshTimer_->start();
+}
+
+void InstrumentationPanel::refresh() {
+  const Instrumentation &instrumentation = Instrumentation::instance();
+  {
+    const SortingPause pause(scopesTreeWidget_);
+    scopesTreeWidget_->clear();
+    for (const auto &[name, statistics] : instrumentation.scopeStatistics()) {
+      QTreeWidgetItem *item = new QTreeWidgetItem(scopesTreeWidget_);
+      item->setText(kScopeNameColumn, QString::fromStdString(name));
+      // Stored as numbers, so that they sort as numbers
+      item->setData(kScopeCountColumn, Qt::DisplayRole, static_cast<qulonglong>(statistics.count));
+      item->setData(kScopeTotalColumn, Qt::DisplayRole, toMilliseconds(statistics.totalNanoseconds));
+      item->setData(kScopeMeanColumn, Qt::DisplayRole, toMilliseconds(statistics.totalNanoseconds) / static_cast<double>(statistics.count));
+      item->setData(kScopeMaxColumn, Qt::DisplayRole, toMilliseconds(statistics.maxNanoseconds));
+    }
+  }
+  {
+    const SortingPause pause(countersTreeWidget_);
+    countersTreeWidget_->clear();
+    for (const auto &[name, value] : instrumentation.counters()) {
+      QTreeWidgetItem *item = new QTreeWidgetItem(countersTreeWidget_);
+      item->setText(0, QString::fromStdString(name));
+      item->setData(1, Qt::DisplayRole, static_cast<qlonglong>(value));
+    }
+  }
+  QStringList lines;
+  for (const Instrumentation::LogEntry &entry : instrumentation.recentLogMessages()) {
+    lines.append(QStringLiteral("%1 ms [%2] %3").arg(toMilliseconds(entry.timestampNanoseconds), 0, 'f', 3).arg(logLevelName(entry.level), entry.message));
+  }
+  logTextEdit_->setPlainText(lines.join('\n'));
+}
+
+void InstrumentationPanel::exportChromeTrace() {
+  const QString path = QFileDialog::getSaveFileName(this, tr("Export Chrome Trace"), QString(), tr("Trace (*.json);;All files (*)"));
+  if (path.isEmpty()) {
+    return;
+  }
+  try {
+    Instrumentation::instance().exportChromeTrace(path);
+  } catch (const std::exception &ex) {
+    QMessageBox::warning(this, windowTitle(), QString::fromStdString(ex.what()));
+  }
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
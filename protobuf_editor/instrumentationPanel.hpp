@@ -0,0 +1,33 @@
+#ifndef PROTOBUF_EDITOR_INSTRUMENTATION_PANEL_HPP_
+#define PROTOBUF_EDITOR_INSTRUMENTATION_PANEL_HPP_
+
+#include <QPlainTextEdit>
+#include <QTimer>
+#include <QTreeWidget>
+#include <QWidget>
+
+namespace protobuf_editor {
+
+// Shows what the Instrumentation has recorded: how long each timed scope took, the counters, and recent log
+//  messages. Refreshes itself while visible, and exports everything as a Chrome trace. Only built when the editor is
+//  configured with -DPROTOBUF_EDITOR_INSTRUMENTATION=ON.
+class InstrumentationPanel : public QWidget {
+  Q_OBJECT
+public:
+  static constexpr int kRefreshIntervalMilliseconds = 1000;
+
+  explicit InstrumentationPanel(QWidget *parent=nullptr);
+  void refresh();
+private:
+  QTreeWidget *scopesTreeWidget_{nullptr};
+  QTreeWidget *countersTreeWidget_{nullptr};
+  QPlainTextEdit *logTextEdit_{nullptr};
+  QTimer *refreshTimer_{nullptr};
+  void buildWidget();
+  void exportChromeTrace();
+signals:
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_INSTRUMENTATION_PANEL_HPP_
@@ -0,0 +1,187 @@
+#include "liveTail.hpp"
+
+#include <google/protobuf/io/coded_stream.h>
+
+#include <QFile>
+#include <QLocalSocket>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace pb = google::protobuf;
+
+namespace {
+
+constexpr qint64 kReadBlockSize = 1 << 20;
+// How long the worker waits for more data before checking whether it was asked to stop
+constexpr int kPollIntervalMilliseconds = 10;
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+LiveTail::LiveTail(Source source, const QString &path, const pb::Message &prototype, QObject *parent) : QObject(parent), source_(source), path_(path) {
+  // Allocated here rather than on the worker, in case the prototype's factory isn't thread-safe
+  decoding_.reset(prototype.New());
+  pending_.reset(prototype.New());
+  clock_.start();
+}
+
+LiveTail::~LiveTail() {
+  // The worker refers to this object, so it must be done before we're gone
+  stop();
+}
+
+QString LiveTail::path() const {
+  return path_;
+}
+
+void LiveTail::start() {
+  if (isRunning()) {
+    return;
+  }
+  stopRequested_.store(false);
+  // Runs for as long as the tail is open, so it gets its own thread rather than holding on to one of the pool's
+  thread_.reset(QThread::create([this]{ run(); }));
+  thread_->start();
+}
+
+void LiveTail::stop() {
+  if (thread_ == nullptr) {
+    return;
+  }
+  stopRequested_.store(true);
+  thread_->wait();
+  thread_.reset();
+}
+
+bool LiveTail::isRunning() const {
+  return thread_ != nullptr && thread_->isRunning();
+}
+
+qint64 LiveTail::elapsedMilliseconds() const {
+  return clock_.elapsed();
+}
+
+LiveTail::Statistics LiveTail::statistics() const {
+  Statistics statistics;
+  statistics.messagesReceived = messagesReceived_.load(std::memory_order_relaxed);
+  statistics.messagesDropped = messagesDropped_.load(std::memory_order_relaxed);
+  statistics.decodeErrors = decodeErrors_.load(std::memory_order_relaxed);
+  statistics.bytesReceived = bytesReceived_.load(std::memory_order_relaxed);
+  return statistics;
+}
+
+bool LiveTail::takeLatest(std::unique_ptr<pb::Message> *message, qint64 *receivedAt) {
+  if (message == nullptr || *message == nullptr) {
+    throw std::runtime_error("A message to swap with must be given");
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!hasPending_) {
+    return false;
+  }
+  std::swap(*message, pending_);
+  hasPending_ = false;
+  if (receivedAt != nullptr) {
+    *receivedAt = pendingReceivedAt_;
+  }
+  return true;
+}
+
+void LiveTail::run() {
+  // Created on the worker thread, since that's the only thread which uses it
+  std::unique_ptr<QIODevice> device;
+  if (source_ == Source::kFile) {
+    // Unbuffered, so that reading past the end picks up whatever was appended since
+    device = std::make_unique<QFile>(path_);
+    if (!device->open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+      emit failed(tr("Failed to open \"%1\": %2").arg(path_, device->errorString()));
+      return;
+    }
+  } else {
+    QLocalSocket *socket = new QLocalSocket;
+    device.reset(socket);
+    socket->connectToServer(path_, QIODevice::ReadOnly);
+    if (!socket->waitForConnected()) {
+      emit failed(tr("Failed to connect to \"%1\": %2").arg(path_, socket->errorString()));
+      return;
+    }
+  }
+
+  while (!stopRequested_.load(std::memory_order_relaxed)) {
+    if (source_ == Source::kLocalSocket && device->bytesAvailable() == 0) {
+      QLocalSocket *socket = static_cast<QLocalSocket*>(device.get());
+      if (!socket->waitForReadyRead(kPollIntervalMilliseconds)) {
+        if (socket->state() != QLocalSocket::ConnectedState) {
+          emit failed(tr("\"%1\" disconnected").arg(path_));
+          return;
+        }
+        continue;
+      }
+    }
+
+    const size_t previousSize = buffer_.size();
+    buffer_.resize(previousSize + kReadBlockSize);
+    const qint64 bytesRead = device->read(&buffer_[previousSize], kReadBlockSize);
+    buffer_.resize(previousSize + std::max<qint64>(bytesRead, 0));
+    if (bytesRead < 0) {
+      emit failed(tr("Failed to read \"%1\": %2").arg(path_, device->errorString()));
+      return;
+    }
+    if (bytesRead == 0) {
+      // Caught up with the writer
+      QThread::msleep(kPollIntervalMilliseconds);
+      continue;
+    }
+    bytesReceived_.fetch_add(static_cast<quint64>(bytesRead), std::memory_order_relaxed);
+    consumeBuffer();
+  }
+}
+
+void LiveTail::consumeBuffer() {
+  // Walk the size prefixes to find the last message which has been received completely. The ones before it would
+  //  only be replaced before anyone sees them, so they aren't decoded at all.
+  const int bufferSize = static_cast<int>(std::min<size_t>(buffer_.size(), std::numeric_limits<int>::max()));
+  pb::io::CodedInputStream input(reinterpret_cast<const uint8_t*>(buffer_.data()), bufferSize);
+  int lastStart = -1;
+  uint32_t lastSize = 0;
+  int consumed = 0;
+  quint64 completeMessages = 0;
+  uint32_t messageSize;
+  while (input.ReadVarint32(&messageSize)) {
+    const int start = input.CurrentPosition();
+    if (messageSize > static_cast<uint32_t>(bufferSize - start)) {
+      // Only part of it has arrived so far
+      break;
+    }
+    input.Skip(static_cast<int>(messageSize));
+    lastStart = start;
+    lastSize = messageSize;
+    consumed = input.CurrentPosition();
+    ++completeMessages;
+  }
+  if (completeMessages == 0) {
+    return;
+  }
+  messagesReceived_.fetch_add(completeMessages, std::memory_order_relaxed);
+  messagesDropped_.fetch_add(completeMessages-1, std::memory_order_relaxed);
+
+  if (decoding_->ParseFromArray(buffer_.data()+lastStart, static_cast<int>(lastSize))) {
+    const qint64 receivedAt = clock_.elapsed();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (hasPending_) {
+      // The viewer never got to the previous one
+      messagesDropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::swap(decoding_, pending_);
+    hasPending_ = true;
+    pendingReceivedAt_ = receivedAt;
+  } else {
+    decodeErrors_.fetch_add(1, std::memory_order_relaxed);
+  }
+  buffer_.erase(0, static_cast<size_t>(consumed));
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
@@ -0,0 +1,81 @@
+#ifndef PROTOBUF_EDITOR_LIVE_TAIL_HPP_
+#define PROTOBUF_EDITOR_LIVE_TAIL_HPP_
+
+#include <google/protobuf/message.h>
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QThread>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace protobuf_editor {
+
+// Follows a stream of length-delimited messages as it's being written, on a worker thread, and keeps only the latest
+//  one. A viewer takes the latest message whenever it's ready to draw another frame, so no matter how quickly
+//  messages arrive, only as many are handed over as can be shown. Messages which are replaced before they were taken
+//  are counted as dropped.
+// Only the last complete message of each read is decoded, the ones before it are only skipped over. Three messages
+//  are allocated up front and passed between the worker and the viewer, so nothing is allocated per message.
+class LiveTail : public QObject {
+  Q_OBJECT
+public:
+  enum class Source {
+    // A file which is being appended to. It's read from the start, and then polled for more.
+    kFile,
+    // A QLocalServer name, or the path of a Unix domain socket
+    kLocalSocket
+  };
+  struct Statistics {
+    quint64 messagesReceived{0};
+    // Received, but replaced by a newer message before they were taken
+    quint64 messagesDropped{0};
+    quint64 decodeErrors{0};
+    quint64 bytesReceived{0};
+  };
+  LiveTail(Source source, const QString &path, const google::protobuf::Message &prototype, QObject *parent=nullptr);
+  ~LiveTail();
+  QString path() const;
+  void start();
+  // Blocks until the worker has stopped
+  void stop();
+  bool isRunning() const;
+  // If a message arrived since the last call, swaps it with `*message`, which must be a message of the prototype's
+  //  type, and returns true. The message given in is reused for decoding. `receivedAt` is in milliseconds on the same
+  //  clock as elapsedMilliseconds.
+  bool takeLatest(std::unique_ptr<google::protobuf::Message> *message, qint64 *receivedAt);
+  qint64 elapsedMilliseconds() const;
+  Statistics statistics() const;
+private:
+  const Source source_;
+  const QString path_;
+  QElapsedTimer clock_;
+  std::unique_ptr<QThread> thread_;
+  std::atomic<bool> stopRequested_{false};
+  // Only touched by the worker
+  std::unique_ptr<google::protobuf::Message> decoding_;
+  std::string buffer_;
+  // Handed from the worker to the viewer, guarded by mutex_
+  mutable std::mutex mutex_;
+  std::unique_ptr<google::protobuf::Message> pending_;
+  bool hasPending_{false};
+  qint64 pendingReceivedAt_{0};
+  std::atomic<quint64> messagesReceived_{0};
+  std::atomic<quint64> messagesDropped_{0};
+  std::atomic<quint64> decodeErrors_{0};
+  std::atomic<quint64> bytesReceived_{0};
+  void run();
+  // Decodes the last complete message in buffer_, and drops every complete message from it
+  void consumeBuffer();
+signals:
+  // Emitted from the worker thread, so only connect with queued or automatic connections
+  void failed(const QString &errorString);
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_LIVE_TAIL_HPP_
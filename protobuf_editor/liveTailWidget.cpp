@@ -0,0 +1,113 @@
+#include "liveTailWidget.hpp"
+#include "messageDiff.hpp"
+#include "messageTypeWidget.hpp"
+
+#include <QGuiApplication>
+#include <QScreen>
+#include <QScrollArea>
+#include <QVBoxLayout>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace pb = google::protobuf;
+
+namespace {
+
+// Redrawing the counters every frame would cost more than it tells anyone
+constexpr int kStatusIntervalMilliseconds = 250;
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+LiveTailWidget::LiveTailWidget(std::unique_ptr<LiveTail> tail, const pb::Message &prototype, QWidget *parent) : QWidget(parent), tail_(std::move(tail)) {
+  if (tail_ == nullptr) {
+    throw std::runtime_error("Live tail widget was constructed without a tail");
+  }
+  displayed_.reset(prototype.New());
+  incoming_.reset(prototype.New());
+
+  messageTypeWidget_ = new MessageTypeWidget(prototype.GetDescriptor());
+  messageTypeWidget_->setReadOnlyMessage(displayed_.get());
+  QScrollArea *scrollArea = new QScrollArea;
+  scrollArea->setWidgetResizable(true);
+  scrollArea->setWidget(messageTypeWidget_);
+
+  statusLabel_ = new QLabel;
+
+  QVBoxLayout *layout = new QVBoxLayout(this);
+  layout->addWidget(scrollArea, 1);
+  layout->addWidget(statusLabel_);
+
+  // Drawing faster than the display refreshes would only draw frames which are never seen
+  const QScreen *screen = QGuiApplication::primaryScreen();
+  if (screen != nullptr && screen->refreshRate() > 0) {
+    frameIntervalMilliseconds_ = std::max(1, static_cast<int>(std::lround(1000.0 / screen->refreshRate())));
+  }
+  frameTimer_.setTimerType(Qt::PreciseTimer);
+  frameTimer_.setInterval(frameIntervalMilliseconds_);
+  connect(&frameTimer_, &QTimer::timeout, this, &LiveTailWidget::drawFrame);
+  statusTimer_.setInterval(kStatusIntervalMilliseconds);
+  connect(&statusTimer_, &QTimer::timeout, this, &LiveTailWidget::updateStatus);
+
+  connect(tail_.get(), &LiveTail::failed, this, [this](const QString &errorString){
+    errorString_ = errorString;
+    updateStatus();
+  });
+
+  tail_->start();
+  sinceLastFrame_.start();
+  frameTimer_.start();
+  statusTimer_.start();
+  updateStatus();
+}
+
+LiveTailWidget::~LiveTailWidget() {
+  tail_->stop();
+  frameTimer_.stop();
+  delete messageTypeWidget_;
+}
+
+void LiveTailWidget::drawFrame() {
+  // If the previous frame took longer than a refresh, the timer fires late and at least one refresh went by without
+  //  a new frame
+  if (sinceLastFrame_.restart() > 2*frameIntervalMilliseconds_) {
+    ++lateFrames_;
+  }
+
+  qint64 receivedAt;
+  if (!tail_->takeLatest(&incoming_, &receivedAt)) {
+    return;
+  }
+  // Bring the displayed message up to date field by field, rather than pointing the widgets at a new message, so that
+  //  only the widgets for fields which changed re-read anything
+  const std::vector<FieldPath> changedPaths = diffMessages(*displayed_, *incoming_);
+  for (const FieldPath &path : changedPaths) {
+    copyFieldAtPath(*incoming_, displayed_.get(), path);
+  }
+  messageTypeWidget_->refreshFields(changedPaths);
+
+  ++framesDrawn_;
+  lagMilliseconds_ = tail_->elapsedMilliseconds() - receivedAt;
+  maximumLagMilliseconds_ = std::max(maximumLagMilliseconds_, lagMilliseconds_);
+}
+
+void LiveTailWidget::updateStatus() {
+  const LiveTail::Statistics statistics = tail_->statistics();
+  QString status = tr("%1 received, %2 drawn, %3 dropped, %4 late frames, lag %5 ms (max %6 ms), %7 decode errors")
+                       .arg(statistics.messagesReceived)
+                       .arg(framesDrawn_)
+                       .arg(statistics.messagesDropped)
+                       .arg(lateFrames_)
+                       .arg(lagMilliseconds_)
+                       .arg(maximumLagMilliseconds_)
+                       .arg(statistics.decodeErrors);
+  if (!errorString_.isEmpty()) {
+    status = errorString_ + " - " + status;
+  }
+  statusLabel_->setText(status);
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
@@ -0,0 +1,54 @@
+#ifndef PROTOBUF_EDITOR_LIVE_TAIL_WIDGET_HPP_
+#define PROTOBUF_EDITOR_LIVE_TAIL_WIDGET_HPP_
+
+#include "liveTail.hpp"
+
+#include <google/protobuf/message.h>
+
+#include <QElapsedTimer>
+#include <QLabel>
+#include <QTimer>
+#include <QWidget>
+
+#include <memory>
+
+namespace protobuf_editor {
+
+class MessageTypeWidget;
+
+// Shows the latest message of a LiveTail, read-only. At most one frame is drawn per refresh of the display, and only
+//  the fields which differ from the previous frame are re-read by the widgets. The status line shows how far behind
+//  the viewer is: messages which were never drawn because a newer one replaced them, frames which were drawn late
+//  because the previous one took too long, and the time between a message arriving and it being drawn.
+class LiveTailWidget : public QWidget {
+  Q_OBJECT
+public:
+  // Starts the tail
+  explicit LiveTailWidget(std::unique_ptr<LiveTail> tail, const google::protobuf::Message &prototype, QWidget *parent=nullptr);
+  // Stops the tail and deletes the message widget before the message it points into
+  ~LiveTailWidget();
+private:
+  std::unique_ptr<LiveTail> tail_;
+  // What the widgets show. Always the same message, the fields which changed are copied into it. Child widgets are
+  //  only deleted by ~QWidget, after the members, so the destructor deletes the message widget first.
+  std::unique_ptr<google::protobuf::Message> displayed_;
+  // Swapped with the tail's latest message
+  std::unique_ptr<google::protobuf::Message> incoming_;
+  MessageTypeWidget *messageTypeWidget_{nullptr};
+  QLabel *statusLabel_{nullptr};
+  QTimer frameTimer_;
+  QTimer statusTimer_;
+  QElapsedTimer sinceLastFrame_;
+  int frameIntervalMilliseconds_{16};
+  quint64 framesDrawn_{0};
+  quint64 lateFrames_{0};
+  qint64 lagMilliseconds_{0};
+  qint64 maximumLagMilliseconds_{0};
+  QString errorString_;
+  void drawFrame();
+  void updateStatus();
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_LIVE_TAIL_WIDGET_HPP_
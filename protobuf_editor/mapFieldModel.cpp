@@ -0,0 +1,355 @@
+#include "fieldValue.hpp"
+#include "mapFieldModel.hpp"
+
+#include <QBrush>
+#include <QColor>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+namespace pb = google::protobuf;
+
+namespace {
+
+// Message values are summarized in the table, and edited in a separate widget. Don't show too much of them.
+constexpr int kMaxSummaryLength = 200;
+
+template<typename T>
+std::string bytesOf(T value) {
+  std::string bytes(sizeof(T), '\0');
+  std::memcpy(&bytes[0], &value, sizeof(T));
+  return bytes;
+}
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+MapFieldModel::MapFieldModel(const pb::FieldDescriptor *fieldDescriptor, QObject *parent) : QAbstractTableModel(parent), fieldDescriptor_(fieldDescriptor), keyFieldDescriptor_(fieldDescriptor->is_map() ? fieldDescriptor->message_type()->map_key() : nullptr), valueFieldDescriptor_(fieldDescriptor->is_map() ? fieldDescriptor->message_type()->map_value() : nullptr) {
+  if (!fieldDescriptor_->is_map()) {
+    throw std::runtime_error("Map field model was constructed with a field which is not a map");
+  }
+}
+
+void MapFieldModel::setMessage(pb::Message *message) {
+  beginResetModel();
+  message_ = message;
+  mutableMessage_ = message;
+  buildIndex();
+  endResetModel();
+  emit duplicateKeyCountChanged(duplicateKeyCount_);
+}
+
+void MapFieldModel::setReadOnlyMessage(const pb::Message *message) {
+  beginResetModel();
+  message_ = message;
+  mutableMessage_ = nullptr;
+  buildIndex();
+  endResetModel();
+  emit duplicateKeyCountChanged(duplicateKeyCount_);
+}
+
+pb::Message* MapFieldModel::mutableMessage() const {
+  if (mutableMessage_ == nullptr) {
+    throw std::runtime_error("Modifying a map field, but there is no message or it is read-only");
+  }
+  return mutableMessage_;
+}
+
+const pb::Message& MapFieldModel::entry(int row) const {
+  return message_->GetReflection()->GetRepeatedMessage(*message_, fieldDescriptor_, row);
+}
+
+std::string MapFieldModel::keyOf(const pb::Message &entry) const {
+  const pb::Reflection *reflection = entry.GetReflection();
+  // Keys can only be integers, bools and strings. All keys of a map have the same type, so the bytes of the value are
+  //  enough to tell them apart.
+  switch (keyFieldDescriptor_->cpp_type()) {
+    case pb::FieldDescriptor::CppType::CPPTYPE_STRING:
+      return reflection->GetString(entry, keyFieldDescriptor_);
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT32:
+      return bytesOf(reflection->GetInt32(entry, keyFieldDescriptor_));
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT32:
+      return bytesOf(reflection->GetUInt32(entry, keyFieldDescriptor_));
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT64:
+      return bytesOf(reflection->GetInt64(entry, keyFieldDescriptor_));
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT64:
+      return bytesOf(reflection->GetUInt64(entry, keyFieldDescriptor_));
+    case pb::FieldDescriptor::CppType::CPPTYPE_BOOL:
+      return bytesOf(reflection->GetBool(entry, keyFieldDescriptor_));
+    default:
+      throw std::runtime_error("Map \""+fieldDescriptor_->full_name()+"\" has a key of a type which maps can't have");
+  }
+}
+
+void MapFieldModel::buildIndex() {
+  keys_.clear();
+  rowsByKey_.clear();
+  duplicateKeyCount_ = 0;
+  if (message_ == nullptr) {
+    return;
+  }
+  const int size = message_->GetReflection()->FieldSize(*message_, fieldDescriptor_);
+  keys_.reserve(size);
+  rowsByKey_.reserve(size);
+  for (int row=0; row<size; ++row) {
+    keys_.push_back(keyOf(entry(row)));
+    std::vector<int> &rows = rowsByKey_[keys_.back()];
+    rows.push_back(row);
+    if (rows.size() == 2) {
+      ++duplicateKeyCount_;
+    }
+  }
+}
+
+std::vector<int> MapFieldModel::addRowKey(int row) {
+  std::vector<int> &rows = rowsByKey_[keys_.at(row)];
+  rows.push_back(row);
+  if (rows.size() == 2) {
+    // The entry which already had this key is now a duplicate too
+    ++duplicateKeyCount_;
+    return {rows.front()};
+  }
+  return {};
+}
+
+std::vector<int> MapFieldModel::removeRowKey(int row) {
+  auto it = rowsByKey_.find(keys_.at(row));
+  if (it == rowsByKey_.end()) {
+    throw std::runtime_error("Map field index is missing the key of an entry");
+  }
+  std::vector<int> &rows = it->second;
+  rows.erase(std::find(rows.begin(), rows.end(), row));
+  if (rows.empty()) {
+    rowsByKey_.erase(it);
+  } else if (rows.size() == 1) {
+    // The entry which is left with this key is no longer a duplicate
+    --duplicateKeyCount_;
+    return {rows.front()};
+  }
+  return {};
+}
+
+void MapFieldModel::emitRowChanged(int row) {
+  emit dataChanged(index(row, kKeyColumn), index(row, kValueColumn));
+}
+
+int MapFieldModel::rowCount(const QModelIndex &parent) const {
+  if (parent.isValid() || message_ == nullptr) {
+    return 0;
+  }
+  return static_cast<int>(keys_.size());
+}
+
+int MapFieldModel::columnCount(const QModelIndex &parent) const {
+  if (parent.isValid()) {
+    return 0;
+  }
+  return kColumnCount;
+}
+
+QVariant MapFieldModel::data(const QModelIndex &index, int role) const {
+  if (!index.isValid() || message_ == nullptr) {
+    return {};
+  }
+  const pb::FieldDescriptor *columnFieldDescriptor = (index.column() == kKeyColumn ? keyFieldDescriptor_ : valueFieldDescriptor_);
+  switch (role) {
+    case FieldDescriptorRole:
+      return QVariant::fromValue(columnFieldDescriptor);
+    case DuplicateKeyRole:
+      return isDuplicateKey(index.row());
+    case Qt::BackgroundRole:
+      if (isDuplicateKey(index.row())) {
+        return QBrush(QColor(255, 200, 200));
+      }
+      return {};
+    case Qt::ToolTipRole:
+      if (isDuplicateKey(index.row())) {
+        return tr("Another entry has the same key, only one of them will be kept");
+      }
+      return {};
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+      break;
+    default:
+      return {};
+  }
+
+  const pb::Message &mapEntry = entry(index.row());
+  if (columnFieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE) {
+    if (role == Qt::EditRole) {
+      return {};
+    }
+    const pb::Message &value = mapEntry.GetReflection()->GetMessage(mapEntry, columnFieldDescriptor);
+    QString summary = QString::fromStdString(value.ShortDebugString());
+    if (summary.size() > kMaxSummaryLength) {
+      summary = summary.left(kMaxSummaryLength) + QStringLiteral("...");
+    }
+    return QStringLiteral("{%1}").arg(summary);
+  }
+  const QVariant value = readFieldValue(mapEntry, columnFieldDescriptor);
+  if (role == Qt::EditRole) {
+    return value;
+  }
+  return fieldValueToString(columnFieldDescriptor, value);
+}
+
+QVariant MapFieldModel::headerData(int section, Qt::Orientation orientation, int role) const {
+  if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+    return (section == kKeyColumn ? tr("Key") : tr("Value"));
+  }
+  return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+bool MapFieldModel::setData(const QModelIndex &index, const QVariant &value, int role) {
+  if (!index.isValid() || mutableMessage_ == nullptr || role != Qt::EditRole) {
+    return false;
+  }
+  const int row = index.row();
+  const bool isKey = (index.column() == kKeyColumn);
+  emit aboutToChangeField(row);
+  pb::Message *mapEntry = mutableMessage()->GetReflection()->MutableRepeatedMessage(mutableMessage(), fieldDescriptor_, row);
+  if (!writeFieldValue(mapEntry, isKey ? keyFieldDescriptor_ : valueFieldDescriptor_, value)) {
+    return false;
+  }
+  if (isKey) {
+    // Move the entry to its new key in the index, which may make it, or the entries it shared a key with, duplicates
+    const int previousDuplicateKeyCount = duplicateKeyCount_;
+    std::vector<int> changedRows = removeRowKey(row);
+    keys_[row] = keyOf(*mapEntry);
+    const std::vector<int> addedChangedRows = addRowKey(row);
+    changedRows.insert(changedRows.end(), addedChangedRows.begin(), addedChangedRows.end());
+    for (int changedRow : changedRows) {
+      emitRowChanged(changedRow);
+    }
+    emitRowChanged(row);
+    if (duplicateKeyCount_ != previousDuplicateKeyCount) {
+      emit duplicateKeyCountChanged(duplicateKeyCount_);
+    }
+  } else {
+    emit dataChanged(index, index);
+  }
+  emit fieldChanged(row);
+  return true;
+}
+
+Qt::ItemFlags MapFieldModel::flags(const QModelIndex &index) const {
+  Qt::ItemFlags result = QAbstractTableModel::flags(index);
+  const pb::FieldDescriptor *columnFieldDescriptor = (index.column() == kKeyColumn ? keyFieldDescriptor_ : valueFieldDescriptor_);
+  if (index.isValid() && mutableMessage_ != nullptr && columnFieldDescriptor->cpp_type() != pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE) {
+    result |= Qt::ItemIsEditable;
+  }
+  return result;
+}
+
+int MapFieldModel::findKey(const QVariant &key) const {
+  if (message_ == nullptr) {
+    return -1;
+  }
+  // Parse the key the same way as an edit would, into an entry of our own
+  const pb::Message *entryPrototype = message_->GetReflection()->GetMessageFactory()->GetPrototype(fieldDescriptor_->message_type());
+  std::unique_ptr<pb::Message> probe(entryPrototype->New());
+  if (!writeFieldValue(probe.get(), keyFieldDescriptor_, key)) {
+    return -1;
+  }
+  auto it = rowsByKey_.find(keyOf(*probe));
+  if (it == rowsByKey_.end()) {
+    return -1;
+  }
+  return it->second.front();
+}
+
+bool MapFieldModel::isDuplicateKey(int row) const {
+  if (row < 0 || row >= static_cast<int>(keys_.size())) {
+    return false;
+  }
+  auto it = rowsByKey_.find(keys_[row]);
+  return it != rowsByKey_.end() && it->second.size() > 1;
+}
+
+int MapFieldModel::duplicateKeyCount() const {
+  return duplicateKeyCount_;
+}
+
+int MapFieldModel::appendEntry() {
+  pb::Message *message = mutableMessage();
+  const int row = rowCount();
+  const int previousDuplicateKeyCount = duplicateKeyCount_;
+  emit aboutToChangeField(-1);
+  beginInsertRows(QModelIndex(), row, row);
+  message->GetReflection()->AddMessage(message, fieldDescriptor_);
+  keys_.push_back(keyOf(entry(row)));
+  const std::vector<int> changedRows = addRowKey(row);
+  endInsertRows();
+  for (int changedRow : changedRows) {
+    emitRowChanged(changedRow);
+  }
+  if (duplicateKeyCount_ != previousDuplicateKeyCount) {
+    emit duplicateKeyCountChanged(duplicateKeyCount_);
+  }
+  emit fieldChanged(-1);
+  return row;
+}
+
+void MapFieldModel::removeEntry(int row) {
+  pb::Message *message = mutableMessage();
+  const int lastRow = rowCount()-1;
+  if (row < 0 || row > lastRow) {
+    throw std::runtime_error("Removing from a map field at an invalid index");
+  }
+  const int previousDuplicateKeyCount = duplicateKeyCount_;
+  emit aboutToChangeField(-1);
+
+  std::vector<int> changedRows = removeRowKey(row);
+  if (row != lastRow) {
+    // The last entry takes the removed entry's row, in the index as well as in the message
+    std::vector<int> &lastRows = rowsByKey_.at(keys_[lastRow]);
+    *std::find(lastRows.begin(), lastRows.end(), lastRow) = row;
+    keys_[row] = std::move(keys_[lastRow]);
+  }
+  keys_.pop_back();
+
+  beginRemoveRows(QModelIndex(), lastRow, lastRow);
+  const pb::Reflection *reflection = message->GetReflection();
+  if (row != lastRow) {
+    reflection->SwapElements(message, fieldDescriptor_, row, lastRow);
+  }
+  reflection->RemoveLast(message, fieldDescriptor_);
+  endRemoveRows();
+
+  if (row != lastRow) {
+    emitRowChanged(row);
+  }
+  for (int changedRow : changedRows) {
+    // Rows are numbered as they were before the last entry moved
+    emitRowChanged(changedRow == lastRow ? row : changedRow);
+  }
+  if (duplicateKeyCount_ != previousDuplicateKeyCount) {
+    emit duplicateKeyCountChanged(duplicateKeyCount_);
+  }
+  emit fieldChanged(-1);
+}
+
+void MapFieldModel::entryChanged(int row) {
+  if (message_ == nullptr || row < 0 || row >= rowCount()) {
+    return;
+  }
+  std::string key = keyOf(entry(row));
+  if (key != keys_[row]) {
+    const int previousDuplicateKeyCount = duplicateKeyCount_;
+    std::vector<int> changedRows = removeRowKey(row);
+    keys_[row] = std::move(key);
+    const std::vector<int> addedChangedRows = addRowKey(row);
+    changedRows.insert(changedRows.end(), addedChangedRows.begin(), addedChangedRows.end());
+    for (int changedRow : changedRows) {
+      emitRowChanged(changedRow);
+    }
+    if (duplicateKeyCount_ != previousDuplicateKeyCount) {
+      emit duplicateKeyCountChanged(duplicateKeyCount_);
+    }
+  }
+  emitRowChanged(row);
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
@@ -0,0 +1,94 @@
+#ifndef PROTOBUF_EDITOR_MAP_FIELD_MODEL_HPP_
+#define PROTOBUF_EDITOR_MAP_FIELD_MODEL_HPP_
+
+#include <google/protobuf/message.h>
+
+#include <QAbstractTableModel>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace protobuf_editor {
+
+// A table model over the entries of one map field of a message, with a column for the key and one for the value.
+//  Reflection only exposes a map as a repeated field of entry messages, in no particular order, so finding a key
+//  would mean scanning every entry. Instead, the model builds a hash index from key to entries when it's given the
+//  message, and keeps it up to date through every insertion, removal and edit of a key, so looking up a key costs
+//  the same no matter how large the map is.
+// While being edited, a map can hold the same key more than once, and only one of those entries would survive
+//  serialization. Such entries are flagged as soon as they appear.
+class MapFieldModel : public QAbstractTableModel {
+  Q_OBJECT
+public:
+  enum Role {
+    // The const google::protobuf::FieldDescriptor* of the column, the entry's key or value field
+    FieldDescriptorRole = Qt::UserRole + 1,
+    // Whether another entry has the same key
+    DuplicateKeyRole
+  };
+  enum Column {
+    kKeyColumn = 0,
+    kValueColumn,
+    kColumnCount
+  };
+
+  explicit MapFieldModel(const google::protobuf::FieldDescriptor *fieldDescriptor, QObject *parent=nullptr);
+  // `message` is the message which contains the map field
+  void setMessage(google::protobuf::Message *message);
+  // Entries can be viewed but not edited
+  void setReadOnlyMessage(const google::protobuf::Message *message);
+
+  int rowCount(const QModelIndex &parent=QModelIndex()) const override;
+  int columnCount(const QModelIndex &parent=QModelIndex()) const override;
+  QVariant data(const QModelIndex &index, int role=Qt::DisplayRole) const override;
+  QVariant headerData(int section, Qt::Orientation orientation, int role=Qt::DisplayRole) const override;
+  bool setData(const QModelIndex &index, const QVariant &value, int role=Qt::EditRole) override;
+  Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+  // The row of an entry with the key, which is parsed like an edit of the key column. -1 if there is none, or the
+  //  key doesn't parse.
+  int findKey(const QVariant &key) const;
+  bool isDuplicateKey(int row) const;
+  // The number of keys which more than one entry has
+  int duplicateKeyCount() const;
+
+  // Adds an entry with the default key and value, and returns its row
+  int appendEntry();
+  // The order of a map's entries doesn't matter, so the last entry is moved into the removed entry's row rather than
+  //  shifting every entry after it
+  void removeEntry(int row);
+  // To be called when an entry was modified through something other than this model, e.g. the widget editing a
+  //  message value, or an undo. Its key is read again.
+  void entryChanged(int row);
+private:
+  const google::protobuf::FieldDescriptor* const fieldDescriptor_;
+  const google::protobuf::FieldDescriptor* const keyFieldDescriptor_;
+  const google::protobuf::FieldDescriptor* const valueFieldDescriptor_;
+  const google::protobuf::Message *message_{nullptr};
+  // Null when read-only
+  google::protobuf::Message *mutableMessage_{nullptr};
+  // The key of each entry, by row, as bytes which are equal exactly when the keys are
+  std::vector<std::string> keys_;
+  // Almost always a single row, more than one for duplicate keys
+  std::unordered_map<std::string, std::vector<int>> rowsByKey_;
+  int duplicateKeyCount_{0};
+  google::protobuf::Message* mutableMessage() const;
+  const google::protobuf::Message& entry(int row) const;
+  std::string keyOf(const google::protobuf::Message &entry) const;
+  void buildIndex();
+  // Both return the rows whose duplicate flag changed, other than `row` itself
+  std::vector<int> addRowKey(int row);
+  std::vector<int> removeRowKey(int row);
+  void emitRowChanged(int row);
+signals:
+  // Emitted right before the message is modified, with the same row which fieldChanged will be emitted with
+  void aboutToChangeField(int row);
+  // `row` is the entry which was edited, or -1 if entries were added or removed
+  void fieldChanged(int row);
+  void duplicateKeyCountChanged(int count);
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_MAP_FIELD_MODEL_HPP_
@@ -0,0 +1,242 @@
+#include "descriptorLayout.hpp"
+#include "mapFieldModel.hpp"
+#include "mapFieldWidget.hpp"
+#include "messageTypeWidget.hpp"
+#include "protobufItemDelegate.hpp"
+
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QVBoxLayout>
+
+#include <algorithm>
+
+namespace pb = google::protobuf;
+
+namespace {
+
+// The table scrolls on its own rather than growing with the number of entries
+constexpr int kTableViewHeight = 200;
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+MapFieldWidget::MapFieldWidget(const pb::FieldDescriptor *fieldDescriptor, QWidget *parent) : ProtobufFieldWidget(fieldDescriptor, parent) {
+  buildWidget();
+}
+
+void MapFieldWidget::buildWidget() {
+  if (!fieldDescriptor_->is_map()) {
+    throw std::runtime_error("Map field widget was constructed with a field which is not a map");
+  }
+  valueFieldDescriptor_ = fieldDescriptor_->message_type()->map_value();
+
+  QVBoxLayout *overallLayout = new QVBoxLayout(this);
+  overallLayout->setContentsMargins(0,0,0,0);
+  groupBox_ = new QGroupBox(fieldLayout(fieldDescriptor_).label);
+  overallLayout->addWidget(groupBox_);
+  QVBoxLayout *groupBoxLayout = new QVBoxLayout(groupBox_);
+
+  // A row of buttons for adding and removing entries, and a box for finding one by its key
+  QHBoxLayout *buttonLayout = new QHBoxLayout;
+  auto createButton = [this, buttonLayout](const QString &text) {
+    QToolButton *button = new QToolButton;
+    button->setText(text);
+    buttonLayout->addWidget(button);
+    return button;
+  };
+  addButton_ = createButton(tr("Add"));
+  removeButton_ = createButton(tr("Remove"));
+  findKeyLineEdit_ = new QLineEdit;
+  findKeyLineEdit_->setPlaceholderText(tr("Find key..."));
+  findKeyLineEdit_->setClearButtonEnabled(true);
+  buttonLayout->addWidget(findKeyLineEdit_);
+  buttonLayout->addStretch();
+  sizeLabel_ = new QLabel;
+  buttonLayout->addWidget(sizeLabel_);
+  groupBoxLayout->addLayout(buttonLayout);
+
+  model_ = new MapFieldModel(fieldDescriptor_, this);
+  tableView_ = new QTableView;
+  tableView_->setSelectionBehavior(QAbstractItemView::SelectRows);
+  tableView_->setSelectionMode(QAbstractItemView::SingleSelection);
+  // Fixed row heights and column widths, sizing them to their contents would read every entry of the map
+  tableView_->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+  tableView_->horizontalHeader()->setSectionResizeMode(MapFieldModel::kKeyColumn, QHeaderView::Interactive);
+  tableView_->horizontalHeader()->setStretchLastSection(true);
+  tableView_->setFixedHeight(kTableViewHeight);
+  tableView_->setItemDelegate(new ProtobufItemDelegate(MapFieldModel::FieldDescriptorRole, tableView_));
+  tableView_->setModel(model_);
+  groupBoxLayout->addWidget(tableView_);
+
+  connect(model_, &MapFieldModel::aboutToChangeField, [this](int row){
+    beginFieldEdit(FieldPath(fieldDescriptor_, row));
+  });
+  connect(model_, &MapFieldModel::fieldChanged, [this](int row){
+    updateControls();
+    reportFieldChanged(FieldPath(fieldDescriptor_, row));
+  });
+  connect(model_, &MapFieldModel::duplicateKeyCountChanged, this, &MapFieldWidget::updateControls);
+
+  connect(addButton_, &QToolButton::clicked, [this]{
+    setCurrentRow(model_->appendEntry());
+  });
+  connect(removeButton_, &QToolButton::clicked, [this]{
+    const int row = currentRow();
+    if (row == -1) {
+      return;
+    }
+    // Make sure that nothing is referencing the entry which is about to be removed
+    setCurrentRow(-1);
+    model_->removeEntry(row);
+    // The last entry took the removed entry's row
+    setCurrentRow(std::min(row, model_->rowCount()-1));
+  });
+  connect(findKeyLineEdit_, &QLineEdit::textEdited, this, &MapFieldWidget::findKey);
+  connect(findKeyLineEdit_, &QLineEdit::returnPressed, [this]{
+    findKey(findKeyLineEdit_->text());
+  });
+
+  if (valueFieldDescriptor_->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE) {
+    // There is only ever one widget for editing a message value, it is given the value of whichever entry is selected
+    valueWidget_ = new MessageTypeWidget(valueFieldDescriptor_->message_type(), valueFieldDescriptor_);
+    valueWidget_->setVisible(false);
+    valueWidget_->setParentFieldWidget(this);
+    groupBoxLayout->addWidget(valueWidget_);
+  }
+
+  connect(tableView_->selectionModel(), &QItemSelectionModel::currentChanged, [this]{
+    updateValueWidget();
+    updateControls();
+  });
+
+  updateControls();
+}
+
+void MapFieldWidget::setDataFromMessage() {
+  if (currentMessage_ == nullptr) {
+    throw std::runtime_error("Setting data from message, but message is null");
+  }
+  // Every key is read once here to build the index, values are only read for the visible rows
+  setCurrentRow(-1);
+  if (isReadOnly()) {
+    model_->setReadOnlyMessage(currentMessage_);
+  } else {
+    model_->setMessage(mutableCurrentMessage());
+  }
+  updateControls();
+}
+
+void MapFieldWidget::refreshFieldPath(const FieldPath &path, size_t position) {
+  const int row = path.at(position).index;
+  if (row == -1 || currentMessage_ == nullptr || row >= model_->rowCount()) {
+    // Entries may have been added or removed, start over
+    setDataFromMessage();
+    return;
+  }
+  // A single entry changed, possibly its key
+  model_->entryChanged(row);
+  if (valueWidget_ != nullptr && row == currentRow()) {
+    if (position+2 < path.size()) {
+      // The path continues with the entry's value field, which is the value widget's own field
+      valueWidget_->refreshFieldPath(path, position+1);
+    } else {
+      updateValueWidget();
+    }
+  }
+}
+
+void MapFieldWidget::qualifyFieldPath(FieldPath &path) {
+  // Paths from our own model already start with this field and the entry's row. Paths from the value widget start
+  //  with the entry's value field, and are missing which entry it belongs to.
+  if (!path.empty() && path.front().fieldDescriptor == valueFieldDescriptor_) {
+    const int row = currentRow();
+    path.prepend(fieldDescriptor_, row);
+    // Only the summary of that one entry needs to be redrawn
+    model_->entryChanged(row);
+  }
+}
+
+int MapFieldWidget::currentRow() const {
+  const QModelIndex current = tableView_->currentIndex();
+  return (current.isValid() ? current.row() : -1);
+}
+
+void MapFieldWidget::setCurrentRow(int row) {
+  if (row < 0) {
+    tableView_->setCurrentIndex(QModelIndex());
+    return;
+  }
+  const QModelIndex index = model_->index(row, MapFieldModel::kKeyColumn);
+  tableView_->setCurrentIndex(index);
+  tableView_->scrollTo(index);
+}
+
+void MapFieldWidget::findKey(const QString &text) {
+  if (text.isEmpty()) {
+    findKeyLineEdit_->setStyleSheet(QString());
+    return;
+  }
+  const int row = model_->findKey(text);
+  if (row == -1) {
+    findKeyLineEdit_->setStyleSheet(QStringLiteral("color: red"));
+    return;
+  }
+  findKeyLineEdit_->setStyleSheet(QString());
+  setCurrentRow(row);
+}
+
+void MapFieldWidget::updateValueWidget() {
+  if (valueWidget_ == nullptr) {
+    return;
+  }
+  const int row = currentRow();
+  if (row == -1 || currentMessage_ == nullptr) {
+    valueWidget_->setVisible(false);
+    return;
+  }
+  const pb::Reflection *reflection = currentMessage_->GetReflection();
+  if (isReadOnly()) {
+    const pb::Message &entry = reflection->GetRepeatedMessage(*currentMessage_, fieldDescriptor_, row);
+    valueWidget_->setReadOnlyMessage(&entry.GetReflection()->GetMessage(entry, valueFieldDescriptor_), &entry);
+  } else {
+    pb::Message *entry = reflection->MutableRepeatedMessage(mutableCurrentMessage(), fieldDescriptor_, row);
+    valueWidget_->setMessage(entry->GetReflection()->MutableMessage(entry, valueFieldDescriptor_), entry);
+  }
+  showValueSizes();
+  valueWidget_->setVisible(true);
+}
+
+void MapFieldWidget::updateSizeOverlay() {
+  updateControls();
+  showValueSizes();
+}
+
+void MapFieldWidget::showValueSizes() {
+  const int row = currentRow();
+  if (valueWidget_ == nullptr || row == -1) {
+    return;
+  }
+  FieldPath valuePath = sizePath_;
+  valuePath.append(fieldDescriptor_, row);
+  valuePath.append(valueFieldDescriptor_);
+  valueWidget_->showSizes(sizeProfile_, valuePath);
+}
+
+void MapFieldWidget::updateControls() {
+  const int size = model_->rowCount();
+  const int duplicateKeyCount = model_->duplicateKeyCount();
+  const bool editable = !isReadOnly();
+  QString text = tr("%n entries", "", size);
+  if (duplicateKeyCount > 0) {
+    text += tr(", %n duplicate key(s)", "", duplicateKeyCount);
+  }
+  if (sizeProfile_ != nullptr) {
+    text += QStringLiteral(", ") + byteSizeText();
+  }
+  sizeLabel_->setText(text);
+  addButton_->setEnabled(editable);
+  removeButton_->setEnabled(editable && currentRow() != -1);
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
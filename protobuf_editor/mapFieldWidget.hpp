@@ -0,0 +1,52 @@
+#ifndef PROTOBUF_EDITOR_MAP_FIELD_WIDGET_HPP_
+#define PROTOBUF_EDITOR_MAP_FIELD_WIDGET_HPP_
+
+#include "protobufFieldWidget.hpp"
+
+#include <google/protobuf/message.h>
+
+#include <QGroupBox>
+#include <QLabel>
+#include <QLineEdit>
+#include <QTableView>
+#include <QToolButton>
+
+namespace protobuf_editor {
+
+class MapFieldModel;
+class MessageTypeWidget;
+
+// A widget for editing a map field, as a table of keys and values. Like RepeatedFieldWidget, only the visible rows are
+//  ever read or drawn. Keys are indexed as they're loaded, so finding an entry by its key and noticing that two
+//  entries share a key don't depend on the size of the map. Built-in values are edited in place. For message values,
+//  a single MessageTypeWidget below the table edits the value of whichever entry is selected.
+class MapFieldWidget : public ProtobufFieldWidget {
+  Q_OBJECT
+public:
+  explicit MapFieldWidget(const google::protobuf::FieldDescriptor *fieldDescriptor, QWidget *parent=nullptr);
+  void refreshFieldPath(const FieldPath &path, size_t position) override;
+private:
+  const google::protobuf::FieldDescriptor *valueFieldDescriptor_{nullptr};
+  MapFieldModel *model_{nullptr};
+  QGroupBox *groupBox_{nullptr};
+  QTableView *tableView_{nullptr};
+  QLabel *sizeLabel_{nullptr};
+  QLineEdit *findKeyLineEdit_{nullptr};
+  QToolButton *addButton_{nullptr};
+  QToolButton *removeButton_{nullptr};
+  MessageTypeWidget *valueWidget_{nullptr};
+  void buildWidget();
+  void setDataFromMessage() override;
+  void qualifyFieldPath(FieldPath &path) override;
+  int currentRow() const;
+  void setCurrentRow(int row);
+  void findKey(const QString &text);
+  void updateControls();
+  void updateValueWidget();
+  void updateSizeOverlay() override;
+  void showValueSizes();
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_MAP_FIELD_WIDGET_HPP_
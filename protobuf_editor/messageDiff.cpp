@@ -0,0 +1,314 @@
+#include "messageDiff.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace pb = google::protobuf;
+
+namespace {
+
+template<typename T>
+bool floatingPointEqual(T lhs, T rhs) {
+  // A NaN which is still NaN has not changed
+  return lhs == rhs || (std::isnan(lhs) && std::isnan(rhs));
+}
+
+// Compares a non-message field, or one element of it if `index` is not -1
+bool valuesEqual(const pb::Message &lhs, const pb::Message &rhs, const pb::FieldDescriptor *fieldDescriptor, int index) {
+  const pb::Reflection *lhsReflection = lhs.GetReflection();
+  const pb::Reflection *rhsReflection = rhs.GetReflection();
+  const bool repeated = (index != -1);
+  switch (fieldDescriptor->cpp_type()) {
+    case pb::FieldDescriptor::CppType::CPPTYPE_STRING: {
+      if (repeated) {
+        std::string lhsScratch, rhsScratch;
+        return lhsReflection->GetRepeatedStringReference(lhs, fieldDescriptor, index, &lhsScratch) == rhsReflection->GetRepeatedStringReference(rhs, fieldDescriptor, index, &rhsScratch);
+      }
+      std::string lhsScratch, rhsScratch;
+      return lhsReflection->GetStringReference(lhs, fieldDescriptor, &lhsScratch) == rhsReflection->GetStringReference(rhs, fieldDescriptor, &rhsScratch);
+    }
+    case pb::FieldDescriptor::CppType::CPPTYPE_FLOAT:
+      return repeated ? floatingPointEqual(lhsReflection->GetRepeatedFloat(lhs, fieldDescriptor, index), rhsReflection->GetRepeatedFloat(rhs, fieldDescriptor, index))
+                      : floatingPointEqual(lhsReflection->GetFloat(lhs, fieldDescriptor), rhsReflection->GetFloat(rhs, fieldDescriptor));
+    case pb::FieldDescriptor::CppType::CPPTYPE_DOUBLE:
+      return repeated ? floatingPointEqual(lhsReflection->GetRepeatedDouble(lhs, fieldDescriptor, index), rhsReflection->GetRepeatedDouble(rhs, fieldDescriptor, index))
+                      : floatingPointEqual(lhsReflection->GetDouble(lhs, fieldDescriptor), rhsReflection->GetDouble(rhs, fieldDescriptor));
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT32:
+      return repeated ? lhsReflection->GetRepeatedInt32(lhs, fieldDescriptor, index) == rhsReflection->GetRepeatedInt32(rhs, fieldDescriptor, index)
+                      : lhsReflection->GetInt32(lhs, fieldDescriptor) == rhsReflection->GetInt32(rhs, fieldDescriptor);
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT32:
+      return repeated ? lhsReflection->GetRepeatedUInt32(lhs, fieldDescriptor, index) == rhsReflection->GetRepeatedUInt32(rhs, fieldDescriptor, index)
+                      : lhsReflection->GetUInt32(lhs, fieldDescriptor) == rhsReflection->GetUInt32(rhs, fieldDescriptor);
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT64:
+      return repeated ? lhsReflection->GetRepeatedInt64(lhs, fieldDescriptor, index) == rhsReflection->GetRepeatedInt64(rhs, fieldDescriptor, index)
+                      : lhsReflection->GetInt64(lhs, fieldDescriptor) == rhsReflection->GetInt64(rhs, fieldDescriptor);
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT64:
+      return repeated ? lhsReflection->GetRepeatedUInt64(lhs, fieldDescriptor, index) == rhsReflection->GetRepeatedUInt64(rhs, fieldDescriptor, index)
+                      : lhsReflection->GetUInt64(lhs, fieldDescriptor) == rhsReflection->GetUInt64(rhs, fieldDescriptor);
+    case pb::FieldDescriptor::CppType::CPPTYPE_BOOL:
+      return repeated ? lhsReflection->GetRepeatedBool(lhs, fieldDescriptor, index) == rhsReflection->GetRepeatedBool(rhs, fieldDescriptor, index)
+                      : lhsReflection->GetBool(lhs, fieldDescriptor) == rhsReflection->GetBool(rhs, fieldDescriptor);
+    case pb::FieldDescriptor::CppType::CPPTYPE_ENUM:
+      return repeated ? lhsReflection->GetRepeatedEnumValue(lhs, fieldDescriptor, index) == rhsReflection->GetRepeatedEnumValue(rhs, fieldDescriptor, index)
+                      : lhsReflection->GetEnumValue(lhs, fieldDescriptor) == rhsReflection->GetEnumValue(rhs, fieldDescriptor);
+    default:
+      throw std::runtime_error("Cannot compare the value of a message field");
+  }
+}
+
+void diffMessages(const pb::Message &lhs, const pb::Message &rhs, const protobuf_editor::FieldPath &prefix, std::vector<protobuf_editor::FieldPath> &result);
+
+// Compares one field which is present in both messages
+void diffField(const pb::Message &lhs, const pb::Message &rhs, const pb::FieldDescriptor *fieldDescriptor, const protobuf_editor::FieldPath &prefix, std::vector<protobuf_editor::FieldPath> &result) {
+  const bool isMessage = (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE);
+  auto reportDifference = [&](int index) {
+    protobuf_editor::FieldPath path = prefix;
+    path.append(fieldDescriptor, index);
+    result.push_back(std::move(path));
+  };
+
+  if (!fieldDescriptor->is_repeated()) {
+    if (!isMessage) {
+      if (!valuesEqual(lhs, rhs, fieldDescriptor, -1)) {
+        reportDifference(-1);
+      }
+      return;
+    }
+    protobuf_editor::FieldPath nestedPrefix = prefix;
+    nestedPrefix.append(fieldDescriptor);
+    diffMessages(lhs.GetReflection()->GetMessage(lhs, fieldDescriptor), rhs.GetReflection()->GetMessage(rhs, fieldDescriptor), nestedPrefix, result);
+    return;
+  }
+
+  const int size = lhs.GetReflection()->FieldSize(lhs, fieldDescriptor);
+  if (size != rhs.GetReflection()->FieldSize(rhs, fieldDescriptor)) {
+    reportDifference(-1);
+    return;
+  }
+  for (int index=0; index<size; ++index) {
+    if (!isMessage) {
+      if (!valuesEqual(lhs, rhs, fieldDescriptor, index)) {
+        reportDifference(index);
+      }
+      continue;
+    }
+    protobuf_editor::FieldPath elementPrefix = prefix;
+    elementPrefix.append(fieldDescriptor, index);
+    diffMessages(lhs.GetReflection()->GetRepeatedMessage(lhs, fieldDescriptor, index), rhs.GetReflection()->GetRepeatedMessage(rhs, fieldDescriptor, index), elementPrefix, result);
+  }
+}
+
+void diffMessages(const pb::Message &lhs, const pb::Message &rhs, const protobuf_editor::FieldPath &prefix, std::vector<protobuf_editor::FieldPath> &result) {
+  // Only look at the fields which are present in at least one of the messages. Both lists are sorted by field number.
+  std::vector<const pb::FieldDescriptor*> lhsFields, rhsFields;
+  lhs.GetReflection()->ListFields(lhs, &lhsFields);
+  rhs.GetReflection()->ListFields(rhs, &rhsFields);
+  auto lhsIt = lhsFields.begin();
+  auto rhsIt = rhsFields.begin();
+  while (lhsIt != lhsFields.end() || rhsIt != rhsFields.end()) {
+    if (rhsIt == rhsFields.end() || (lhsIt != lhsFields.end() && (*lhsIt)->number() < (*rhsIt)->number())) {
+      // Only present on the left
+      protobuf_editor::FieldPath path = prefix;
+      path.append(*lhsIt);
+      result.push_back(std::move(path));
+      ++lhsIt;
+    } else if (lhsIt == lhsFields.end() || (*rhsIt)->number() < (*lhsIt)->number()) {
+      // Only present on the right
+      protobuf_editor::FieldPath path = prefix;
+      path.append(*rhsIt);
+      result.push_back(std::move(path));
+      ++rhsIt;
+    } else {
+      diffField(lhs, rhs, *lhsIt, prefix, result);
+      ++lhsIt;
+      ++rhsIt;
+    }
+  }
+}
+
+// Copies a non-message field, or one element of it if `index` is not -1. The element must already exist in `to`.
+void copyValue(const pb::Message &from, pb::Message *to, const pb::FieldDescriptor *fieldDescriptor, int index) {
+  const pb::Reflection *fromReflection = from.GetReflection();
+  const pb::Reflection *toReflection = to->GetReflection();
+  const bool repeated = (index != -1);
+  switch (fieldDescriptor->cpp_type()) {
+    case pb::FieldDescriptor::CppType::CPPTYPE_STRING:
+      if (repeated) {
+        toReflection->SetRepeatedString(to, fieldDescriptor, index, fromReflection->GetRepeatedString(from, fieldDescriptor, index));
+      } else {
+        toReflection->SetString(to, fieldDescriptor, fromReflection->GetString(from, fieldDescriptor));
+      }
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_FLOAT:
+      if (repeated) {
+        toReflection->SetRepeatedFloat(to, fieldDescriptor, index, fromReflection->GetRepeatedFloat(from, fieldDescriptor, index));
+      } else {
+        toReflection->SetFloat(to, fieldDescriptor, fromReflection->GetFloat(from, fieldDescriptor));
+      }
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_DOUBLE:
+      if (repeated) {
+        toReflection->SetRepeatedDouble(to, fieldDescriptor, index, fromReflection->GetRepeatedDouble(from, fieldDescriptor, index));
+      } else {
+        toReflection->SetDouble(to, fieldDescriptor, fromReflection->GetDouble(from, fieldDescriptor));
+      }
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT32:
+      if (repeated) {
+        toReflection->SetRepeatedInt32(to, fieldDescriptor, index, fromReflection->GetRepeatedInt32(from, fieldDescriptor, index));
+      } else {
+        toReflection->SetInt32(to, fieldDescriptor, fromReflection->GetInt32(from, fieldDescriptor));
+      }
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT32:
+      if (repeated) {
+        toReflection->SetRepeatedUInt32(to, fieldDescriptor, index, fromReflection->GetRepeatedUInt32(from, fieldDescriptor, index));
+      } else {
+        toReflection->SetUInt32(to, fieldDescriptor, fromReflection->GetUInt32(from, fieldDescriptor));
+      }
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT64:
+      if (repeated) {
+        toReflection->SetRepeatedInt64(to, fieldDescriptor, index, fromReflection->GetRepeatedInt64(from, fieldDescriptor, index));
+      } else {
+        toReflection->SetInt64(to, fieldDescriptor, fromReflection->GetInt64(from, fieldDescriptor));
+      }
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT64:
+      if (repeated) {
+        toReflection->SetRepeatedUInt64(to, fieldDescriptor, index, fromReflection->GetRepeatedUInt64(from, fieldDescriptor, index));
+      } else {
+        toReflection->SetUInt64(to, fieldDescriptor, fromReflection->GetUInt64(from, fieldDescriptor));
+      }
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_BOOL:
+      if (repeated) {
+        toReflection->SetRepeatedBool(to, fieldDescriptor, index, fromReflection->GetRepeatedBool(from, fieldDescriptor, index));
+      } else {
+        toReflection->SetBool(to, fieldDescriptor, fromReflection->GetBool(from, fieldDescriptor));
+      }
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_ENUM:
+      if (repeated) {
+        toReflection->SetRepeatedEnumValue(to, fieldDescriptor, index, fromReflection->GetRepeatedEnumValue(from, fieldDescriptor, index));
+      } else {
+        toReflection->SetEnumValue(to, fieldDescriptor, fromReflection->GetEnumValue(from, fieldDescriptor));
+      }
+      break;
+    default:
+      throw std::runtime_error("Cannot copy the value of a message field");
+  }
+}
+
+// Appends a copy of one element of a repeated field
+void appendElement(const pb::Message &from, pb::Message *to, const pb::FieldDescriptor *fieldDescriptor, int index) {
+  const pb::Reflection *fromReflection = from.GetReflection();
+  const pb::Reflection *toReflection = to->GetReflection();
+  switch (fieldDescriptor->cpp_type()) {
+    case pb::FieldDescriptor::CppType::CPPTYPE_STRING:
+      toReflection->AddString(to, fieldDescriptor, fromReflection->GetRepeatedString(from, fieldDescriptor, index));
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_FLOAT:
+      toReflection->AddFloat(to, fieldDescriptor, fromReflection->GetRepeatedFloat(from, fieldDescriptor, index));
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_DOUBLE:
+      toReflection->AddDouble(to, fieldDescriptor, fromReflection->GetRepeatedDouble(from, fieldDescriptor, index));
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT32:
+      toReflection->AddInt32(to, fieldDescriptor, fromReflection->GetRepeatedInt32(from, fieldDescriptor, index));
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT32:
+      toReflection->AddUInt32(to, fieldDescriptor, fromReflection->GetRepeatedUInt32(from, fieldDescriptor, index));
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT64:
+      toReflection->AddInt64(to, fieldDescriptor, fromReflection->GetRepeatedInt64(from, fieldDescriptor, index));
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT64:
+      toReflection->AddUInt64(to, fieldDescriptor, fromReflection->GetRepeatedUInt64(from, fieldDescriptor, index));
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_BOOL:
+      toReflection->AddBool(to, fieldDescriptor, fromReflection->GetRepeatedBool(from, fieldDescriptor, index));
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_ENUM:
+      toReflection->AddEnumValue(to, fieldDescriptor, fromReflection->GetRepeatedEnumValue(from, fieldDescriptor, index));
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE:
+      toReflection->AddMessage(to, fieldDescriptor)->CopyFrom(fromReflection->GetRepeatedMessage(from, fieldDescriptor, index));
+      break;
+  }
+}
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+std::vector<FieldPath> diffMessages(const pb::Message &lhs, const pb::Message &rhs) {
+  if (lhs.GetDescriptor() != rhs.GetDescriptor()) {
+    throw std::runtime_error("Cannot diff messages of different types");
+  }
+  std::vector<FieldPath> result;
+  ::diffMessages(lhs, rhs, FieldPath(), result);
+  return result;
+}
+
+void copyFieldAtPath(const pb::Message &from, pb::Message *to, const FieldPath &path) {
+  if (path.empty()) {
+    to->CopyFrom(from);
+    return;
+  }
+  const pb::Message *fromContainingMessage = path.resolveContainingMessage(from);
+  if (fromContainingMessage == nullptr) {
+    throw std::runtime_error("Cannot copy \""+path.toString()+"\", it is not present in the source message");
+  }
+  pb::Message *toContainingMessage = path.resolveMutableContainingMessage(to);
+  const pb::FieldDescriptor *fieldDescriptor = path.back().fieldDescriptor;
+  const int index = path.back().index;
+  const pb::Reflection *fromReflection = fromContainingMessage->GetReflection();
+  const pb::Reflection *toReflection = toContainingMessage->GetReflection();
+  const bool isMessage = (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE);
+
+  if (index != -1) {
+    // A single element, which exists on both sides
+    if (isMessage) {
+      toReflection->MutableRepeatedMessage(toContainingMessage, fieldDescriptor, index)->CopyFrom(fromReflection->GetRepeatedMessage(*fromContainingMessage, fieldDescriptor, index));
+    } else {
+      copyValue(*fromContainingMessage, toContainingMessage, fieldDescriptor, index);
+    }
+    return;
+  }
+
+  if (fieldDescriptor->is_repeated()) {
+    toReflection->ClearField(toContainingMessage, fieldDescriptor);
+    const int size = fromReflection->FieldSize(*fromContainingMessage, fieldDescriptor);
+    for (int elementIndex=0; elementIndex<size; ++elementIndex) {
+      appendElement(*fromContainingMessage, toContainingMessage, fieldDescriptor, elementIndex);
+    }
+    return;
+  }
+
+  const bool fromHasField = !fieldDescriptor->has_presence() || fromReflection->HasField(*fromContainingMessage, fieldDescriptor);
+  if (!fromHasField) {
+    toReflection->ClearField(toContainingMessage, fieldDescriptor);
+  } else if (isMessage) {
+    toReflection->MutableMessage(toContainingMessage, fieldDescriptor)->CopyFrom(fromReflection->GetMessage(*fromContainingMessage, fieldDescriptor));
+  } else {
+    copyValue(*fromContainingMessage, toContainingMessage, fieldDescriptor, -1);
+  }
+}
+
+void copyRepeatedElement(const pb::Message &from, int fromIndex, pb::Message *to, int toIndex, const pb::FieldDescriptor *fieldDescriptor) {
+  const pb::Reflection *toReflection = to->GetReflection();
+  if (fromIndex < 0 || fromIndex >= from.GetReflection()->FieldSize(from, fieldDescriptor) || toIndex < -1 || toIndex >= toReflection->FieldSize(*to, fieldDescriptor)) {
+    throw std::runtime_error("Cannot copy element "+std::to_string(fromIndex)+" of \""+fieldDescriptor->full_name()+"\" to element "+std::to_string(toIndex)+", it is out of range");
+  }
+  appendElement(from, to, fieldDescriptor, fromIndex);
+  if (toIndex == -1) {
+    return;
+  }
+  // Reflection can only append, so swap the copy into place and drop the element it replaces
+  toReflection->SwapElements(to, fieldDescriptor, toIndex, toReflection->FieldSize(*to, fieldDescriptor)-1);
+  toReflection->RemoveLast(to, fieldDescriptor);
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
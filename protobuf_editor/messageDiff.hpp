@@ -0,0 +1,28 @@
+#ifndef PROTOBUF_EDITOR_MESSAGE_DIFF_HPP_
+#define PROTOBUF_EDITOR_MESSAGE_DIFF_HPP_
+
+#include "fieldPath.hpp"
+
+#include <google/protobuf/message.h>
+
+#include <vector>
+
+namespace protobuf_editor {
+
+// Returns the paths of the fields which differ between two messages of the same type, in one pass over the fields
+//  which are present in either message. A difference is reported at the highest level at which it can be described:
+//  a nested message which is present in only one of the messages is reported as that message's field, and a
+//  repeated field whose size changed is reported as the whole field rather than element by element.
+std::vector<FieldPath> diffMessages(const google::protobuf::Message &lhs, const google::protobuf::Message &rhs);
+
+// Copies the field at `path` from one message to another message of the same type. Every message along the path
+//  must be present in both messages, which is always the case for paths returned by diffMessages.
+void copyFieldAtPath(const google::protobuf::Message &from, google::protobuf::Message *to, const FieldPath &path);
+
+// Copies element `fromIndex` of a repeated field over element `toIndex` of the same field of another message of the
+//  same type, or appends it if `toIndex` is -1
+void copyRepeatedElement(const google::protobuf::Message &from, int fromIndex, google::protobuf::Message *to, int toIndex, const google::protobuf::FieldDescriptor *fieldDescriptor);
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_MESSAGE_DIFF_HPP_
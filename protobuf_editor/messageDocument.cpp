@@ -0,0 +1,71 @@
+#include "messageDocument.hpp"
+
+#include <stdexcept>
+
+namespace pb = google::protobuf;
+
+namespace {
+
+// The default instance which new messages are created from. Unlike the message given to us, it lives as long as its
+//  factory (or forever, for compiled-in types), so we can hold on to it.
+const pb::Message* prototypeOf(const pb::Message &message) {
+  const pb::Reflection *reflection = message.GetReflection();
+  return reflection->GetMessageFactory()->GetPrototype(message.GetDescriptor());
+}
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+MessageDocument::MessageDocument(const pb::Message &prototype, const MessageDocumentOptions &options) : prototype_(prototypeOf(prototype)) {
+  if (options.useArena) {
+    pb::ArenaOptions arenaOptions;
+    arenaOptions.start_block_size = options.startBlockSize;
+    arenaOptions.max_block_size = options.maxBlockSize;
+    if (options.initialBlockSize > 0) {
+      initialBlock_.reset(new char[options.initialBlockSize]);
+      arenaOptions.initial_block = initialBlock_.get();
+      arenaOptions.initial_block_size = options.initialBlockSize;
+    }
+    arena_ = std::make_unique<pb::Arena>(arenaOptions);
+  }
+  reset();
+}
+
+MessageDocument::MessageDocument(std::unique_ptr<pb::Message> message) {
+  if (message == nullptr) {
+    throw std::runtime_error("Cannot create a document without a message");
+  }
+  if (message->GetArena() != nullptr) {
+    throw std::runtime_error("Only messages which are on the heap can be taken over");
+  }
+  prototype_ = prototypeOf(*message);
+  heapMessage_ = std::move(message);
+  message_ = heapMessage_.get();
+}
+
+pb::Message* MessageDocument::message() const {
+  return message_;
+}
+
+pb::Arena* MessageDocument::arena() const {
+  return arena_.get();
+}
+
+void MessageDocument::reset() {
+  if (arena_ != nullptr) {
+    // Runs the destructors which the message registered with the arena, and gives back every block but the initial one
+    message_ = nullptr;
+    arena_->Reset();
+    message_ = prototype_->New(arena_.get());
+  } else {
+    heapMessage_.reset(prototype_->New());
+    message_ = heapMessage_.get();
+  }
+}
+
+uint64_t MessageDocument::spaceAllocated() const {
+  return arena_ != nullptr ? arena_->SpaceAllocated() : 0;
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
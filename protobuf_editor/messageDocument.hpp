@@ -0,0 +1,56 @@
+#ifndef PROTOBUF_EDITOR_MESSAGE_DOCUMENT_HPP_
+#define PROTOBUF_EDITOR_MESSAGE_DOCUMENT_HPP_
+
+#include <google/protobuf/arena.h>
+#include <google/protobuf/message.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace protobuf_editor {
+
+// How the arena of a MessageDocument allocates its memory
+struct MessageDocumentOptions {
+  // Without an arena, the message is allocated on the heap like any other
+  bool useArena{true};
+  // The first block which the arena takes from the heap. Each block after it is twice as large, up to maxBlockSize.
+  size_t startBlockSize{4096};
+  size_t maxBlockSize{1 << 20};
+  // Allocated along with the document and kept across reset, so that a document which fits in it never allocates
+  //  from the heap. 0 for none.
+  size_t initialBlockSize{0};
+};
+
+// Owns the message being edited, and everything which is allocated for it. The message lives on an arena, so setting
+//  a nested message or a string while editing takes memory from the arena's blocks rather than from the heap, and
+//  throwing the whole message away frees a handful of blocks rather than every field one by one.
+class MessageDocument {
+public:
+  // Creates an empty message of the prototype's type
+  explicit MessageDocument(const google::protobuf::Message &prototype, const MessageDocumentOptions &options=MessageDocumentOptions());
+  // Takes over a message which was allocated on the heap, nothing is copied
+  explicit MessageDocument(std::unique_ptr<google::protobuf::Message> message);
+  MessageDocument(const MessageDocument&) = delete;
+  MessageDocument& operator=(const MessageDocument&) = delete;
+  google::protobuf::Message* message() const;
+  // Null if the message is on the heap
+  google::protobuf::Arena* arena() const;
+  // Frees the message, and everything which was allocated for it, in one go, and replaces it with a new empty message
+  //  of the same type. Anything which pointed into the previous message must have let go of it.
+  void reset();
+  // How much memory the arena holds, including what's not used yet. 0 without an arena.
+  uint64_t spaceAllocated() const;
+private:
+  const google::protobuf::Message *prototype_;
+  // Declared before the arena, so that the arena is destroyed before the block it allocates from
+  std::unique_ptr<char[]> initialBlock_;
+  std::unique_ptr<google::protobuf::Arena> arena_;
+  // Owned by the arena if there is one, otherwise by heapMessage_
+  google::protobuf::Message *message_{nullptr};
+  std::unique_ptr<google::protobuf::Message> heapMessage_;
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_MESSAGE_DOCUMENT_HPP_
@@ -0,0 +1,184 @@
+#include "messageFile.hpp"
+
+#include <google/protobuf/io/tokenizer.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/text_format.h>
+#include <google/protobuf/util/json_util.h>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace pb = google::protobuf;
+
+namespace {
+
+// Large enough that the per-block overhead is negligible, small enough for smooth progress
+constexpr int kBlockSize = 1 << 20;
+
+// Lets protobuf read directly from a QIODevice, counting the bytes as they go by
+class DeviceInputStream : public pb::io::CopyingInputStream {
+public:
+  DeviceInputStream(QIODevice *device, const protobuf_editor::FileProgressCallback &progress) : device_(device), progress_(progress) {}
+  int Read(void *buffer, int size) override {
+    const qint64 bytesRead = device_->read(static_cast<char*>(buffer), size);
+    if (bytesRead > 0) {
+      bytesProcessed_ += bytesRead;
+      if (progress_) {
+        progress_(bytesProcessed_);
+      }
+    }
+    // 0 at the end of the file, -1 on error, exactly as protobuf expects
+    return static_cast<int>(bytesRead);
+  }
+private:
+  QIODevice *device_;
+  const protobuf_editor::FileProgressCallback &progress_;
+  qint64 bytesProcessed_{0};
+};
+
+class DeviceOutputStream : public pb::io::CopyingOutputStream {
+public:
+  DeviceOutputStream(QIODevice *device, const protobuf_editor::FileProgressCallback &progress) : device_(device), progress_(progress) {}
+  bool Write(const void *buffer, int size) override {
+    if (device_->write(static_cast<const char*>(buffer), size) != size) {
+      return false;
+    }
+    bytesProcessed_ += size;
+    if (progress_) {
+      progress_(bytesProcessed_);
+    }
+    return true;
+  }
+private:
+  QIODevice *device_;
+  const protobuf_editor::FileProgressCallback &progress_;
+  qint64 bytesProcessed_{0};
+};
+
+class TextFormatErrorCollector : public pb::io::ErrorCollector {
+public:
+  void AddError(int line, pb::io::ColumnNumber column, const std::string &message) override {
+    // Only keep the first, later errors tend to be consequences of it. Lines and columns are zero-based.
+    if (error_.empty()) {
+      error_ = std::to_string(line+1)+":"+std::to_string(column+1)+": "+message;
+    }
+  }
+  const std::string& error() const {
+    return error_;
+  }
+private:
+  std::string error_;
+};
+
+std::string describe(const QString &path) {
+  return "\""+path.toStdString()+"\"";
+}
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+MessageFormat messageFormatForPath(const QString &path) {
+  const QString suffix = QFileInfo(path).suffix().toLower();
+  if (suffix == "json") {
+    return MessageFormat::kJson;
+  }
+  if (suffix == "txtpb" || suffix == "textproto" || suffix == "pbtxt" || suffix == "txt") {
+    return MessageFormat::kText;
+  }
+  return MessageFormat::kBinary;
+}
+
+void readMessageFile(const QString &path, MessageFormat format, pb::Message *message, const FileProgressCallback &progress) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    throw std::runtime_error("Failed to open "+describe(path)+": "+file.errorString().toStdString());
+  }
+  DeviceInputStream deviceStream(&file, progress);
+  pb::io::CopyingInputStreamAdaptor input(&deviceStream, kBlockSize);
+
+  switch (format) {
+    case MessageFormat::kBinary:
+      if (!message->ParseFromZeroCopyStream(&input)) {
+        throw std::runtime_error(describe(path)+" is not a valid binary "+message->GetTypeName()+" message");
+      }
+      break;
+    case MessageFormat::kText: {
+      pb::TextFormat::Parser parser;
+      TextFormatErrorCollector errorCollector;
+      parser.RecordErrorsTo(&errorCollector);
+      if (!parser.Parse(&input, message)) {
+        throw std::runtime_error(describe(path)+":"+errorCollector.error());
+      }
+      break;
+    }
+    case MessageFormat::kJson: {
+      std::string json;
+      json.reserve(file.size());
+      const void *block;
+      int blockSize;
+      while (input.Next(&block, &blockSize)) {
+        json.append(static_cast<const char*>(block), blockSize);
+      }
+      const pb::util::Status status = pb::util::JsonStringToMessage(json, message);
+      if (!status.ok()) {
+        throw std::runtime_error(describe(path)+" is not a valid JSON "+message->GetTypeName()+" message: "+status.ToString());
+      }
+      break;
+    }
+  }
+  if (file.error() != QFileDevice::NoError) {
+    throw std::runtime_error("Failed to read "+describe(path)+": "+file.errorString().toStdString());
+  }
+}
+
+void writeMessageFile(const QString &path, MessageFormat format, const pb::Message &message, const FileProgressCallback &progress) {
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly)) {
+    throw std::runtime_error("Failed to open "+describe(path)+": "+file.errorString().toStdString());
+  }
+  {
+    DeviceOutputStream deviceStream(&file, progress);
+    // Flushes whatever is left in its buffer when destroyed, so it must be gone before committing
+    pb::io::CopyingOutputStreamAdaptor output(&deviceStream, kBlockSize);
+    bool success = true;
+    switch (format) {
+      case MessageFormat::kBinary:
+        success = message.SerializeToZeroCopyStream(&output);
+        break;
+      case MessageFormat::kText:
+        success = pb::TextFormat::Print(message, &output);
+        break;
+      case MessageFormat::kJson: {
+        std::string json;
+        pb::util::JsonPrintOptions options;
+        options.add_whitespace = true;
+        const pb::util::Status status = pb::util::MessageToJsonString(message, &json, options);
+        if (!status.ok()) {
+          throw std::runtime_error("Failed to convert the message to JSON: "+status.ToString());
+        }
+        // Already in memory, so skip the adaptor's buffer and write it out in blocks
+        for (size_t offset=0; offset<json.size() && success; offset+=kBlockSize) {
+          const int blockSize = static_cast<int>(std::min<size_t>(kBlockSize, json.size()-offset));
+          success = deviceStream.Write(json.data()+offset, blockSize);
+        }
+        break;
+      }
+    }
+    success = success && output.Flush();
+    if (!success) {
+      file.cancelWriting();
+      throw std::runtime_error("Failed to write "+describe(path)+": "+file.errorString().toStdString());
+    }
+  }
+  if (!file.commit()) {
+    throw std::runtime_error("Failed to write "+describe(path)+": "+file.errorString().toStdString());
+  }
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
@@ -0,0 +1,35 @@
+#ifndef PROTOBUF_EDITOR_MESSAGE_FILE_HPP_
+#define PROTOBUF_EDITOR_MESSAGE_FILE_HPP_
+
+#include <google/protobuf/message.h>
+
+#include <QString>
+
+#include <functional>
+
+namespace protobuf_editor {
+
+enum class MessageFormat {
+  // The protobuf wire format
+  kBinary,
+  kText,
+  kJson
+};
+
+// Guesses the format from the file's extension: ".json" is JSON, ".txtpb", ".textproto", ".pbtxt" and ".txt" are
+//  text format, anything else is binary
+MessageFormat messageFormatForPath(const QString &path);
+
+// Called with the number of bytes of the file which have been read or written so far
+using FileProgressCallback = std::function<void(qint64 bytesProcessed)>;
+
+// These block until the whole file has been processed and are meant to be called from a worker thread, see
+//  MessageFileTask. Files are streamed through in blocks rather than read into memory first, except for JSON, which
+//  protobuf can only parse from and print to a string. Both throw if the file can't be read, written, or parsed.
+void readMessageFile(const QString &path, MessageFormat format, google::protobuf::Message *message, const FileProgressCallback &progress=nullptr);
+// The file is replaced atomically, so a failed save leaves any existing file untouched
+void writeMessageFile(const QString &path, MessageFormat format, const google::protobuf::Message &message, const FileProgressCallback &progress=nullptr);
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_MESSAGE_FILE_HPP_
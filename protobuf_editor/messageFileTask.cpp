@@ -0,0 +1,85 @@
+#include "messageFileTask.hpp"
+
+#include <QFileInfo>
+#include <QtConcurrent>
+
+namespace pb = google::protobuf;
+
+namespace {
+
+// Progress is only drawn this often, no matter how quickly the worker gets through the file
+constexpr int kProgressIntervalMilliseconds = 100;
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+MessageFileTask::MessageFileTask(const QString &path, QObject *parent) : QObject(parent), path_(path) {
+  progressTimer_.setInterval(kProgressIntervalMilliseconds);
+  connect(&progressTimer_, &QTimer::timeout, this, &MessageFileTask::reportProgress);
+  connect(&watcher_, &QFutureWatcher<void>::finished, this, [this]{
+    progressTimer_.stop();
+    reportProgress();
+    emit finished(errorString_.isEmpty());
+  });
+}
+
+MessageFileTask::~MessageFileTask() {
+  // The worker refers to this task, so it must be done before we're gone
+  watcher_.waitForFinished();
+}
+
+MessageFileTask* MessageFileTask::load(const QString &path, MessageFormat format, pb::Message *message, QObject *parent) {
+  if (message == nullptr) {
+    throw std::runtime_error("A message to load into must be given");
+  }
+  MessageFileTask *task = new MessageFileTask(path, parent);
+  task->bytesTotal_.store(QFileInfo(path).size(), std::memory_order_relaxed);
+  task->start([task, path, format, message]{
+    readMessageFile(path, format, message, [task](qint64 bytesProcessed){
+      task->bytesProcessed_.store(bytesProcessed, std::memory_order_relaxed);
+    });
+  });
+  return task;
+}
+
+MessageFileTask* MessageFileTask::save(const QString &path, MessageFormat format, const pb::Message &message, QObject *parent) {
+  MessageFileTask *task = new MessageFileTask(path, parent);
+  const pb::Message *messageToSave = &message;
+  task->start([task, path, format, messageToSave]{
+    // Only the binary size can be known up front, the other formats are only measured by printing them. Serializing
+    //  needs the sizes anyway, and caches them, so this costs little.
+    if (format == MessageFormat::kBinary) {
+      task->bytesTotal_.store(static_cast<qint64>(messageToSave->ByteSizeLong()), std::memory_order_relaxed);
+    }
+    writeMessageFile(path, format, *messageToSave, [task](qint64 bytesProcessed){
+      task->bytesProcessed_.store(bytesProcessed, std::memory_order_relaxed);
+    });
+  });
+  return task;
+}
+
+void MessageFileTask::start(const std::function<void()> &work) {
+  watcher_.setFuture(QtConcurrent::run([this, work]{
+    try {
+      work();
+    } catch (const std::exception &ex) {
+      errorString_ = QString::fromStdString(ex.what());
+    }
+  }));
+  progressTimer_.start();
+}
+
+QString MessageFileTask::path() const {
+  return path_;
+}
+
+QString MessageFileTask::errorString() const {
+  return errorString_;
+}
+
+void MessageFileTask::reportProgress() {
+  emit progressChanged(bytesProcessed_.load(std::memory_order_relaxed), bytesTotal_.load(std::memory_order_relaxed));
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
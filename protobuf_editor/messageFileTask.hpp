@@ -0,0 +1,52 @@
+#ifndef PROTOBUF_EDITOR_MESSAGE_FILE_TASK_HPP_
+#define PROTOBUF_EDITOR_MESSAGE_FILE_TASK_HPP_
+
+#include "messageFile.hpp"
+
+#include <google/protobuf/message.h>
+
+#include <QFutureWatcher>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+#include <atomic>
+#include <functional>
+
+namespace protobuf_editor {
+
+// Loads or saves a message on a worker thread, so that the UI stays responsive while a very large file is processed.
+//  Progress is reported on the thread which started the task, and only as often as it can be shown.
+class MessageFileTask : public QObject {
+  Q_OBJECT
+public:
+  // Parses the file straight into `message`, e.g. one which lives on the arena of a new MessageDocument. The message
+  //  is written from the worker thread, so it must not be touched until finished is emitted. If the load fails, it's
+  //  left partially parsed.
+  static MessageFileTask* load(const QString &path, MessageFormat format, google::protobuf::Message *message, QObject *parent=nullptr);
+  // The message is read from the worker thread, so it must not be modified until finished is emitted
+  static MessageFileTask* save(const QString &path, MessageFormat format, const google::protobuf::Message &message, QObject *parent=nullptr);
+  ~MessageFileTask();
+  QString path() const;
+  QString errorString() const;
+private:
+  explicit MessageFileTask(const QString &path, QObject *parent);
+  void start(const std::function<void()> &work);
+  void reportProgress();
+  const QString path_;
+  // Written by the worker, polled by progressTimer_
+  std::atomic<qint64> bytesProcessed_{0};
+  std::atomic<qint64> bytesTotal_{0};
+  QFutureWatcher<void> watcher_;
+  QTimer progressTimer_;
+  // Only accessed by the worker until it has finished
+  QString errorString_;
+signals:
+  // `bytesTotal` is 0 if it isn't known ahead of time
+  void progressChanged(qint64 bytesProcessed, qint64 bytesTotal);
+  void finished(bool success);
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_MESSAGE_FILE_TASK_HPP_
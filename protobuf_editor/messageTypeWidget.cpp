@@ -1,19 +1,56 @@
 #include "builtInTypeWidget.hpp"
+#include "descriptorLayout.hpp"
+#include "instrumentation.hpp"
+#include "mapFieldWidget.hpp"
+#include "messageDiff.hpp"
 #include "messageTypeWidget.hpp"
+#include "oneofWidget.hpp"
+#include "repeatedFieldWidget.hpp"
 
 #include <QGridLayout>
 #include <QLabel>
 #include <QCheckBox>
+#include <QSignalBlocker>
 
 namespace pb = google::protobuf;
 
+namespace {
+
+// All members of a oneof share one widget, which is given the message and the sizes through its first member only
+bool isSharedOneofMember(const pb::FieldDescriptor *fieldDescriptor) {
+  const pb::OneofDescriptor *oneofDescriptor = fieldDescriptor->real_containing_oneof();
+  return oneofDescriptor != nullptr && oneofDescriptor->field(0) != fieldDescriptor;
+}
+
+} // anonymous namespace
+
 namespace protobuf_editor {
 
 MessageTypeWidget::MessageTypeWidget(const pb::Descriptor *descriptor, const pb::FieldDescriptor *fieldDescriptor, QWidget *parent) : ProtobufFieldWidget(fieldDescriptor, parent), descriptor_(descriptor) {
   buildWidget();
 }
 
+bool MessageTypeWidget::isExpanded() const {
+  return contentWidget_->isVisibleTo(groupBox_);
+}
+
+void MessageTypeWidget::setExpanded(bool expanded) {
+  if (expanded && !childWidgetsBuilt_) {
+    // First time being expanded, now we actually need the widgets for our fields
+    buildChildWidgets();
+    if (currentMessage_ != nullptr) {
+      setDataForChildWidgets();
+    }
+  }
+  contentWidget_->setVisible(expanded);
+  if (expandButton_ != nullptr) {
+    expandButton_->setChecked(expanded);
+    expandButton_->setArrowType(expanded ? Qt::DownArrow : Qt::RightArrow);
+  }
+}
+
 void MessageTypeWidget::buildWidget() {
+  PROTOBUF_EDITOR_TIME_SCOPE("MessageTypeWidget::buildWidget " + descriptor_->full_name());
   // Create a layout (LayoutA) for our entire widget
   QVBoxLayout *overallLayout = new QVBoxLayout(this);
   // Specify no margin for this layout, since we want it to look like the QGroupBox is what we are
@@ -21,14 +58,8 @@ void MessageTypeWidget::buildWidget() {
   // TODO: Ideally we'd inherit from QGroupBox, but that seems tricky given that we've already inherited from something which inherits from QObject
 
   // Create a groupbox for this message
-  if (fieldDescriptor_ != nullptr) {
-    // We are a nested message
-    groupBox_ = new QGroupBox(QString::fromStdString(fieldDescriptor_->full_name()));
-  } else {
-    // We are a root-level message
-    // TODO: Dont create a group box, instead just create a QWidget
-    groupBox_ = new QGroupBox(tr("Root-level Message"));
-  }
+  // TODO: For the root-level message, dont create a group box, instead just create a QWidget
+  groupBox_ = new QGroupBox(title());
   
   // Put the groupbox (and only that groupbox) into the layout LayoutA
   overallLayout->addWidget(groupBox_);
@@ -42,72 +73,146 @@ void MessageTypeWidget::buildWidget() {
     groupBox_->setCheckable(true);
     // groupBox_->setChecked(true);
     connect(groupBox_, &QGroupBox::toggled, [this](bool enabled){
+      PROTOBUF_EDITOR_TIME_SCOPE("edit " + fieldDescriptor_->full_name());
       if (parentMessage_ == nullptr) {
         throw std::runtime_error("Something went wrong. This should not be possible without a message");
       }
       if (!fieldIsOptional()) {
         throw std::runtime_error("Should not be able to toggle groupbox for non-optioal message");
       }
+      if (isReadOnly()) {
+        // The message is only being viewed, put back what's in it
+        const QSignalBlocker blocker(groupBox_);
+        groupBox_->setChecked(!enabled);
+        return;
+      }
       const pb::Reflection *reflection = parentMessage_->GetReflection();
+      beginFieldEdit();
       if (enabled) {
-        pb::Message* newCurrentMessage = reflection->MutableMessage(parentMessage_, fieldDescriptor_);
-        setMessage(newCurrentMessage, parentMessage_);
+        pb::Message* newCurrentMessage = reflection->MutableMessage(mutableParentMessage(), fieldDescriptor_);
+        setMessage(newCurrentMessage, mutableParentMessage());
       } else {
-        reflection->ClearField(parentMessage_, fieldDescriptor_);
+        reflection->ClearField(mutableParentMessage(), fieldDescriptor_);
       }
-      emit messageUpdated();
+      reportFieldChanged();
     });
   }
 
+  // The widgets for our fields live in their own container so that they can be hidden while collapsed
+  contentWidget_ = new QWidget;
+  contentLayout_ = new QVBoxLayout(contentWidget_);
+  contentLayout_->setContentsMargins(0,0,0,0);
+
+  if (fieldDescriptor_ == nullptr) {
+    // The root-level message is always expanded
+    groupBoxLayout->addWidget(contentWidget_);
+    setExpanded(true);
+    return;
+  }
+
+  // Nested messages start collapsed. Building the widgets for every field of every nested message up front is
+  //  expensive for large schemas and never terminates for a recursive message type, so instead only build them
+  //  once the user asks to see them.
+  expandButton_ = new QToolButton;
+  expandButton_->setCheckable(true);
+  expandButton_->setAutoRaise(true);
+  expandButton_->setToolButtonStyle(Qt::ToolButtonTextBesideIcon);
+  expandButton_->setText(tr("%n field(s)", "", descriptor_->field_count()));
+  connect(expandButton_, &QToolButton::toggled, this, &MessageTypeWidget::setExpanded);
+  groupBoxLayout->addWidget(expandButton_);
+  groupBoxLayout->addWidget(contentWidget_);
+  setExpanded(false);
+}
+
+void MessageTypeWidget::buildChildWidgets() {
+  PROTOBUF_EDITOR_TIME_SCOPE("MessageTypeWidget::buildChildWidgets " + descriptor_->full_name());
+  // Everything we need to know about our fields was worked out the first time any editor saw this message type
+  const MessageLayout &layout = messageLayout(descriptor_);
+
   // Iterate over all fields, create widgets for them, and add them to our layout
-  for (int fieldIndex=0; fieldIndex<descriptor_->field_count(); ++fieldIndex) {
-    const pb::FieldDescriptor *fieldDescriptor = descriptor_->field(fieldIndex);
+  nestedWidgets_.reserve(layout.fields.size());
+  for (const FieldLayout &fieldLayout : layout.fields) {
+    const pb::FieldDescriptor *fieldDescriptor = fieldLayout.fieldDescriptor;
 
-    // Skip unhandled types for now
-    if (fieldDescriptor->real_containing_oneof() != nullptr) {
-      std::cout << "Skipping oneof \"" << fieldDescriptor->full_name() << "\" for now" << std::endl;
-      groupBoxLayout->addWidget(new QLabel(tr("[skipped] ")+QString::fromStdString(fieldDescriptor->full_name())));
-      nestedWidgets_.push_back(nullptr);
-      continue;
+    ProtobufFieldWidget *widgetForField = nullptr;
+    switch (fieldLayout.kind) {
+      case FieldLayout::Kind::kSkipped:
+        // Skip unhandled types for now
+        if (logEnabled(LogLevel::kDebug)) {
+          logMessage(LogLevel::kDebug, QStringLiteral("Skipping %1 \"%2\" for now").arg(fieldLayout.skipReason, QString::fromStdString(fieldDescriptor->full_name())));
+        }
+        contentLayout_->addWidget(new QLabel(tr("[skipped] ")+fieldLayout.label));
+        nestedWidgets_.push_back(nullptr);
+        continue;
+      case FieldLayout::Kind::kRepeated:
+        // Is a repeated field of any type
+        widgetForField = new RepeatedFieldWidget(fieldDescriptor);
+        break;
+      case FieldLayout::Kind::kMap:
+        // Is a map, which is also "repeated" but edited by key
+        widgetForField = new MapFieldWidget(fieldDescriptor);
+        break;
+      case FieldLayout::Kind::kOneof:
+        // Is a member of a oneof. A oneof's members are declared together, so its first member comes before the rest.
+        if (isSharedOneofMember(fieldDescriptor)) {
+          nestedWidgets_.push_back(nestedWidgets_.at(fieldDescriptor->real_containing_oneof()->field(0)->index()));
+          continue;
+        }
+        widgetForField = new OneofWidget(fieldDescriptor->real_containing_oneof());
+        break;
+      case FieldLayout::Kind::kMessage:
+        // Is a nested message type
+        if (fieldDescriptor->message_type() == nullptr) {
+          throw std::runtime_error("Nested field descriptor is null");
+        }
+        widgetForField = new MessageTypeWidget(fieldDescriptor->message_type(), fieldDescriptor);
+        break;
+      case FieldLayout::Kind::kBuiltIn:
+        // Is a built-in type
+        widgetForField = new BuiltInTypeWidget(fieldDescriptor);
+        break;
     }
-    
-    if (fieldDescriptor->is_map()) {
-      // Map is also "repeated", handle map first then move to next item
-      std::cout << "Skipping map \"" << fieldDescriptor->full_name() << "\" for now" << std::endl;
-      groupBoxLayout->addWidget(new QLabel(tr("[skipped] ")+QString::fromStdString(fieldDescriptor->full_name())));
-      nestedWidgets_.push_back(nullptr);
-      continue;
-    }
-    
-    if (fieldDescriptor->is_repeated()) {
-      std::cout << "Skipping repeated \"" << fieldDescriptor->full_name() << "\" for now" << std::endl;
-      groupBoxLayout->addWidget(new QLabel(tr("[skipped] ")+QString::fromStdString(fieldDescriptor->full_name())));
-      nestedWidgets_.push_back(nullptr);
-      continue;
+    widgetForField->setParentFieldWidget(this);
+    if (sizeProfile_ != nullptr) {
+      widgetForField->showSizes(sizeProfile_, childSizePath(fieldDescriptor->index()));
     }
+    contentLayout_->addWidget(widgetForField);
+    nestedWidgets_.push_back(widgetForField);
+  }
+  childWidgetsBuilt_ = true;
+}
 
-    if (fieldDescriptor->type() == pb::FieldDescriptor::Type::TYPE_GROUP) {
-      std::cout << "Skipping group \"" << fieldDescriptor->full_name() << "\" for now" << std::endl;
-      groupBoxLayout->addWidget(new QLabel(tr("[skipped] ")+QString::fromStdString(fieldDescriptor->full_name())));
-      nestedWidgets_.push_back(nullptr);
-      continue;
-    }
-    
-    ProtobufFieldWidget *widgetForField;
-    if (fieldDescriptor->type() == pb::FieldDescriptor::Type::TYPE_MESSAGE) {
-      // Is a nested message type
-      const pb::Descriptor *nestedDescriptor = fieldDescriptor->message_type();
-      if (nestedDescriptor == nullptr) {
-          throw std::runtime_error("Nested field descriptor is null");
-      }
-      widgetForField = new MessageTypeWidget(nestedDescriptor, fieldDescriptor);
-    } else {
-      // Is a built-in type
-      widgetForField = new BuiltInTypeWidget(fieldDescriptor);
+QString MessageTypeWidget::title() const {
+  if (fieldDescriptor_ != nullptr) {
+    // We are a nested message
+    return fieldLayout(fieldDescriptor_).label;
+  }
+  // We are a root-level message
+  return tr("Root-level Message");
+}
+
+FieldPath MessageTypeWidget::childSizePath(int fieldIndex) const {
+  const pb::FieldDescriptor *fieldDescriptor = descriptor_->field(fieldIndex);
+  if (fieldDescriptor->real_containing_oneof() != nullptr) {
+    // The oneof's widget works out the paths of its members itself
+    return sizePath_;
+  }
+  FieldPath path = sizePath_;
+  path.append(fieldDescriptor);
+  return path;
+}
+
+void MessageTypeWidget::updateSizeOverlay() {
+  if (sizeProfile_ == nullptr) {
+    groupBox_->setTitle(title());
+  } else {
+    groupBox_->setTitle(tr("%1 (%2)").arg(title(), byteSizeText()));
+  }
+  // Only the widgets which have been built, the rest pick up the sizes when they're built
+  for (size_t fieldIndex=0; fieldIndex<nestedWidgets_.size(); ++fieldIndex) {
+    if (nestedWidgets_[fieldIndex] != nullptr && !isSharedOneofMember(descriptor_->field(static_cast<int>(fieldIndex)))) {
+      nestedWidgets_[fieldIndex]->showSizes(sizeProfile_, childSizePath(static_cast<int>(fieldIndex)));
     }
-    connect(widgetForField, &ProtobufFieldWidget::messageUpdated, this, &ProtobufFieldWidget::messageUpdated);
-    groupBoxLayout->addWidget(widgetForField);
-    nestedWidgets_.push_back(widgetForField);
   }
 }
 
@@ -126,12 +231,34 @@ void MessageTypeWidget::setDataFromMessage() {
     if (!groupBox_->isCheckable()) {
       throw std::runtime_error("Field is optional, but QGroupBox is not checkable");
     }
-    // Message is not set, we're disabled
+    // Message is not set, we're disabled. This only reflects the message, so don't let it look like a user edit.
+    const QSignalBlocker blocker(groupBox_);
     groupBox_->setChecked(false);
     // Nothing else to do
     return;
   }
 
+  if (snapshotEnabled_) {
+    snapshot_.reset(currentMessage_->New());
+    snapshot_->CopyFrom(*currentMessage_);
+  }
+
+  // While collapsed, there are no widgets to give the message to. They'll receive it when they're built.
+  if (childWidgetsBuilt_) {
+    setDataForChildWidgets();
+  }
+
+  // Set whether we're enabled or disabled based on the data in the given message
+  if (fieldIsOptional()) {
+    if (!groupBox_->isCheckable()) {
+      throw std::runtime_error("Field is optional, but QGroupBox is not checkable");
+    }
+    const QSignalBlocker blocker(groupBox_);
+    groupBox_->setChecked(fieldIsSet());
+  }
+}
+
+void MessageTypeWidget::setDataForChildWidgets() {
   // If this message has nested messages, set those messages for all of our nested widgets
   if (descriptor_->field_count() != nestedWidgets_.size()) {
     throw std::runtime_error("Expecting descriptor to have the same number of fields as we have widgets");
@@ -139,39 +266,150 @@ void MessageTypeWidget::setDataFromMessage() {
 
   // Recursively set the message for nested widgets
   for (int fieldIndex=0; fieldIndex<descriptor_->field_count(); ++fieldIndex) {
-    auto *nestedFieldWidget = nestedWidgets_.at(fieldIndex);
-    if (nestedFieldWidget == nullptr) {
-      // TODO: Throw here once we handle all field types
-      std::cout << "Warning! Nested widget is null. This is ok now since we skip certain pb field types" << std::endl;
-      continue;
+    if (!isSharedOneofMember(descriptor_->field(fieldIndex))) {
+      setDataForChildWidget(fieldIndex);
     }
-    // Check if this field of the message is a nested message
-    const pb::FieldDescriptor *nestedFieldDescriptor = descriptor_->field(fieldIndex);
-    if (nestedFieldDescriptor->type() == pb::FieldDescriptor::Type::TYPE_MESSAGE) {
-      if (dynamic_cast<MessageTypeWidget*>(nestedFieldWidget) == nullptr) {
-        throw std::runtime_error("Field is a message, but the corresponding widget is not for a message");
-      }
-      // Get the nested message within the message that we were just given, so that we can pass it to the widget, if it exists
-      const pb::Reflection *reflection = currentMessage_->GetReflection();
-      if (!nestedFieldDescriptor->has_optional_keyword() || reflection->HasField(*currentMessage_, nestedFieldDescriptor)) {
-        pb::Message *nestedMessage = currentMessage_->GetReflection()->MutableMessage(currentMessage_, nestedFieldDescriptor);
-        nestedFieldWidget->setMessage(nestedMessage, currentMessage_);
-      } else {
-        nestedFieldWidget->setMessage(nullptr, currentMessage_);
-      }
+  }
+}
+
+void MessageTypeWidget::setDataForChildWidget(int fieldIndex) {
+  auto *nestedFieldWidget = nestedWidgets_.at(fieldIndex);
+  if (nestedFieldWidget == nullptr) {
+    // TODO: Throw here once we handle all field types
+    logMessage(LogLevel::kDebug, QStringLiteral("Nested widget is null. This is ok now since we skip certain pb field types"));
+    return;
+  }
+  // Check if this field of the message is a nested message
+  const pb::FieldDescriptor *nestedFieldDescriptor = descriptor_->field(fieldIndex);
+  if (nestedFieldDescriptor->type() == pb::FieldDescriptor::Type::TYPE_MESSAGE && !nestedFieldDescriptor->is_repeated() && nestedFieldDescriptor->real_containing_oneof() == nullptr) {
+    if (dynamic_cast<MessageTypeWidget*>(nestedFieldWidget) == nullptr) {
+      throw std::runtime_error("Field is a message, but the corresponding widget is not for a message");
+    }
+    // Get the nested message within the message that we were just given, so that we can pass it to the widget, if it exists
+    const pb::Reflection *reflection = currentMessage_->GetReflection();
+    const bool nestedMessageIsSet = !nestedFieldDescriptor->has_optional_keyword() || reflection->HasField(*currentMessage_, nestedFieldDescriptor);
+    if (isReadOnly()) {
+      // GetMessage returns the default instance for a message which isn't present, so nothing is allocated or modified
+      const pb::Message *nestedMessage = (nestedMessageIsSet ? &reflection->GetMessage(*currentMessage_, nestedFieldDescriptor) : nullptr);
+      nestedFieldWidget->setReadOnlyMessage(nestedMessage, currentMessage_);
+    } else if (nestedMessageIsSet) {
+      pb::Message *nestedMessage = reflection->MutableMessage(mutableCurrentMessage(), nestedFieldDescriptor);
+      nestedFieldWidget->setMessage(nestedMessage, mutableCurrentMessage());
     } else {
-      // The message which holds this field's data is also its parent message
-      nestedFieldWidget->setMessage(currentMessage_, currentMessage_);
+      nestedFieldWidget->setMessage(nullptr, mutableCurrentMessage());
     }
+  } else if (isReadOnly()) {
+    nestedFieldWidget->setReadOnlyMessage(currentMessage_, currentMessage_);
+  } else {
+    // The message which holds this field's data is also its parent message. The same goes for a oneof, whose widget
+    //  works out which of its members is set.
+    nestedFieldWidget->setMessage(mutableCurrentMessage(), mutableCurrentMessage());
   }
+}
 
-  // Set whether we're enabled or disabled based on the data in the given message
-  if (fieldIsOptional()) {
-    if (!groupBox_->isCheckable()) {
-      throw std::runtime_error("Field is optional, but QGroupBox is not checkable");
+void MessageTypeWidget::refreshFields(const std::vector<FieldPath> &paths) {
+  if (currentMessage_ == nullptr) {
+    throw std::runtime_error("Cannot refresh fields without a message");
+  }
+  for (const FieldPath &path : paths) {
+    if (path.empty()) {
+      // The whole message
+      setDataFromMessage();
+      continue;
     }
-    groupBox_->setChecked(fieldIsSet());
+    refreshChildFieldPath(path, 0);
+  }
+}
+
+ProtobufFieldWidget* MessageTypeWidget::revealField(const FieldPath &path, size_t position) {
+  if (position >= path.size()) {
+    return this;
+  }
+  const FieldPath::Element &element = path.at(position);
+  if (element.fieldDescriptor->containing_type() != descriptor_) {
+    throw std::runtime_error("Field \""+element.fieldDescriptor->full_name()+"\" is not a field of \""+descriptor_->full_name()+"\"");
+  }
+  setExpanded(true);
+  ProtobufFieldWidget *childWidget = nestedWidgets_.at(element.fieldDescriptor->index());
+  if (auto *oneofWidget = dynamic_cast<OneofWidget*>(childWidget)) {
+    // Members which aren't set have no widget, the oneof's selector is as close as we can get
+    ProtobufFieldWidget *memberWidget = oneofWidget->memberWidget(element.fieldDescriptor);
+    if (memberWidget == nullptr) {
+      return oneofWidget;
+    }
+    childWidget = memberWidget;
+  }
+  if (auto *repeatedFieldWidget = dynamic_cast<RepeatedFieldWidget*>(childWidget)) {
+    return repeatedFieldWidget->revealElement(path, position);
+  }
+  MessageTypeWidget *nestedMessageWidget = dynamic_cast<MessageTypeWidget*>(childWidget);
+  if (nestedMessageWidget == nullptr || position+1 == path.size()) {
+    return childWidget;
+  }
+  return nestedMessageWidget->revealField(path, position+1);
+}
+
+void MessageTypeWidget::refreshFieldPath(const FieldPath &path, size_t position) {
+  if (position+1 >= path.size() || currentMessage_ == nullptr) {
+    ProtobufFieldWidget::refreshFieldPath(path, position);
+    return;
+  }
+  refreshChildFieldPath(path, position+1);
+}
+
+void MessageTypeWidget::refreshChildFieldPath(const FieldPath &path, size_t position) {
+  if (!childWidgetsBuilt_) {
+    // Nothing is being shown for this message yet, the widgets will read it once they're built
+    return;
+  }
+  const pb::FieldDescriptor *fieldDescriptor = path.at(position).fieldDescriptor;
+  if (fieldDescriptor->containing_type() != descriptor_) {
+    throw std::runtime_error("Field path \""+path.toString()+"\" does not match the message being displayed");
+  }
+  ProtobufFieldWidget *nestedFieldWidget = nestedWidgets_.at(fieldDescriptor->index());
+  if (nestedFieldWidget == nullptr) {
+    // A field type which we skip
+    return;
+  }
+  if (fieldDescriptor->type() == pb::FieldDescriptor::Type::TYPE_MESSAGE && !fieldDescriptor->is_repeated() && fieldDescriptor->real_containing_oneof() == nullptr) {
+    // The nested widget can only be refreshed in place if it's still showing the same nested message. It won't be if
+    //  the nested message was set or cleared.
+    const pb::Reflection *reflection = currentMessage_->GetReflection();
+    const bool nestedMessageIsSet = !fieldDescriptor->has_optional_keyword() || reflection->HasField(*currentMessage_, fieldDescriptor);
+    const pb::Message *nestedMessage = nullptr;
+    if (nestedMessageIsSet) {
+      nestedMessage = (isReadOnly() ? &reflection->GetMessage(*currentMessage_, fieldDescriptor) : reflection->MutableMessage(mutableCurrentMessage(), fieldDescriptor));
+    }
+    auto *nestedMessageWidget = static_cast<MessageTypeWidget*>(nestedFieldWidget);
+    if (position+1 == path.size() || nestedMessageWidget->currentMessage_ != nestedMessage) {
+      setDataForChildWidget(fieldDescriptor->index());
+      return;
+    }
+  }
+  nestedFieldWidget->refreshFieldPath(path, position);
+}
+
+void MessageTypeWidget::setSnapshotEnabled(bool enabled) {
+  snapshotEnabled_ = enabled;
+  if (!snapshotEnabled_) {
+    snapshot_.reset();
+  } else if (currentMessage_ != nullptr) {
+    snapshot_.reset(currentMessage_->New());
+    snapshot_->CopyFrom(*currentMessage_);
+  }
+}
+
+std::vector<FieldPath> MessageTypeWidget::refreshChangedFields() {
+  if (snapshot_ == nullptr || currentMessage_ == nullptr) {
+    throw std::runtime_error("Cannot refresh changed fields without a message and a snapshot of it");
+  }
+  // Diffing only reads the message. The widgets, which are the expensive part, are only touched for what changed.
+  std::vector<FieldPath> changedPaths = diffMessages(*snapshot_, *currentMessage_);
+  for (const FieldPath &path : changedPaths) {
+    copyFieldAtPath(*currentMessage_, snapshot_.get(), path);
   }
+  refreshFields(changedPaths);
+  return changedPaths;
 }
 
 } // namespace protobuf_editor
\ No newline at end of file
@@ -6,7 +6,10 @@
 #include <google/protobuf/message.h>
 
 #include <QGroupBox>
+#include <QToolButton>
+#include <QVBoxLayout>
 
+#include <memory>
 #include <vector>
 
 namespace protobuf_editor {
@@ -15,12 +18,43 @@ class MessageTypeWidget : public ProtobufFieldWidget {
   Q_OBJECT
 public:
   MessageTypeWidget(const google::protobuf::Descriptor *descriptor, const google::protobuf::FieldDescriptor *fieldDescriptor=nullptr, QWidget *parent=nullptr);
+  // Nested messages start collapsed and only build widgets for their fields once expanded
+  bool isExpanded() const;
+  void setExpanded(bool expanded);
+  // Re-reads only the given fields, relative to this widget's message, after the message was modified from outside
+  //  of the editor. Fields whose widgets have not been built yet are skipped, they'll read the message once built.
+  void refreshFields(const std::vector<FieldPath> &paths);
+  void refreshFieldPath(const FieldPath &path, size_t position) override;
+  // Keeps a copy of the message as it was last displayed, so that refreshChangedFields can work out what changed
+  void setSnapshotEnabled(bool enabled);
+  // Diffs the message against the snapshot, refreshes only the fields which differ, and returns their paths.
+  //  Edits made through this widget since the last refresh also differ from the snapshot, re-reading them is harmless.
+  std::vector<FieldPath> refreshChangedFields();
+  // Expands every nested message along the path, building only the widgets which are needed along the way, and
+  //  returns the widget of the field at the end of it. `path.at(position)` names one of our fields. Paths into the
+  //  elements of a repeated field stop at the repeated field's widget. Null if the field has no widget.
+  ProtobufFieldWidget* revealField(const FieldPath &path, size_t position=0);
 private:
   const google::protobuf::Descriptor* const descriptor_;
   std::vector<ProtobufFieldWidget*> nestedWidgets_;
   QGroupBox *groupBox_{nullptr};
+  QToolButton *expandButton_{nullptr};
+  QWidget *contentWidget_{nullptr};
+  QVBoxLayout *contentLayout_{nullptr};
+  bool childWidgetsBuilt_{false};
+  std::unique_ptr<google::protobuf::Message> snapshot_;
+  bool snapshotEnabled_{false};
   void buildWidget();
+  void buildChildWidgets();
   void setDataFromMessage() override;
+  void updateSizeOverlay() override;
+  QString title() const;
+  // The path of a child widget's field, for showSizes
+  FieldPath childSizePath(int fieldIndex) const;
+  void setDataForChildWidgets();
+  void setDataForChildWidget(int fieldIndex);
+  // `path.at(position)` names one of our fields
+  void refreshChildFieldPath(const FieldPath &path, size_t position);
 signals:
 };
 
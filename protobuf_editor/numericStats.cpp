@@ -0,0 +1,429 @@
+#include "numericStats.hpp"
+
+#include <google/protobuf/repeated_field.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace pb = google::protobuf;
+
+namespace {
+
+struct Accumulator {
+  size_t nanCount{0};
+  double minimum{std::numeric_limits<double>::infinity()};
+  double maximum{-std::numeric_limits<double>::infinity()};
+  double shiftedSum{0};
+  double shiftedSumOfSquares{0};
+};
+
+// GetRepeatedFieldRef only hands out one element at a time, through a virtual call. The kernels need the field's
+//  contiguous storage, which only the deprecated GetRepeatedField gives access to.
+template<typename T>
+const pb::RepeatedField<T>& repeatedField(const pb::Message &message, const pb::FieldDescriptor *fieldDescriptor) {
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#elif defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable: 4996)
+#endif
+  return message.GetReflection()->GetRepeatedField<T>(message, fieldDescriptor);
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#elif defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+}
+
+template<typename T>
+double firstValue(const T *data, size_t size) {
+  for (size_t index=0; index<size; ++index) {
+    if (!std::isnan(static_cast<double>(data[index]))) {
+      return static_cast<double>(data[index]);
+    }
+  }
+  return 0;
+}
+
+template<typename T>
+void accumulateScalar(const T *data, size_t size, double shift, Accumulator *accumulator) {
+  for (size_t index=0; index<size; ++index) {
+    const double value = static_cast<double>(data[index]);
+    if (std::isnan(value)) {
+      ++accumulator->nanCount;
+      continue;
+    }
+    accumulator->minimum = std::min(accumulator->minimum, value);
+    accumulator->maximum = std::max(accumulator->maximum, value);
+    const double shifted = value-shift;
+    accumulator->shiftedSum += shifted;
+    accumulator->shiftedSumOfSquares += shifted*shifted;
+  }
+}
+
+// Integers can't be NaN. The sums are split over independent accumulators, so that the additions don't each wait for
+//  the previous one; compilers won't reassociate floating point sums into several on their own.
+template<typename T>
+void accumulateIntegers(const T *data, size_t size, double shift, Accumulator *accumulator) {
+  constexpr int kLaneCount = 4;
+  if (size == 0) {
+    return;
+  }
+  T minimum = std::numeric_limits<T>::max();
+  T maximum = std::numeric_limits<T>::lowest();
+  double sums[kLaneCount] = {};
+  double sumsOfSquares[kLaneCount] = {};
+  size_t index = 0;
+  for (; index+kLaneCount<=size; index+=kLaneCount) {
+    for (int lane=0; lane<kLaneCount; ++lane) {
+      const T value = data[index+lane];
+      minimum = std::min(minimum, value);
+      maximum = std::max(maximum, value);
+      const double shifted = static_cast<double>(value)-shift;
+      sums[lane] += shifted;
+      sumsOfSquares[lane] += shifted*shifted;
+    }
+  }
+  for (; index<size; ++index) {
+    const T value = data[index];
+    minimum = std::min(minimum, value);
+    maximum = std::max(maximum, value);
+    const double shifted = static_cast<double>(value)-shift;
+    sums[0] += shifted;
+    sumsOfSquares[0] += shifted*shifted;
+  }
+  accumulator->minimum = std::min(accumulator->minimum, static_cast<double>(minimum));
+  accumulator->maximum = std::max(accumulator->maximum, static_cast<double>(maximum));
+  accumulator->shiftedSum += (sums[0]+sums[1]) + (sums[2]+sums[3]);
+  accumulator->shiftedSumOfSquares += (sumsOfSquares[0]+sumsOfSquares[1]) + (sumsOfSquares[2]+sumsOfSquares[3]);
+}
+
+// 64 bit integers, and everything when SSE2 isn't available
+template<typename T>
+void accumulate(const T *data, size_t size, double shift, Accumulator *accumulator) {
+  if constexpr (std::is_integral_v<T>) {
+    accumulateIntegers(data, size, shift, accumulator);
+  } else {
+    accumulateScalar(data, size, shift, accumulator);
+  }
+}
+
+#ifdef __SSE2__
+
+// The number of set bits in a movemask result
+constexpr int kBitCount[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+
+void addShifted(__m128d values, __m128d shift, __m128d *sum, __m128d *sumOfSquares) {
+  // NaN lanes are zeroed, so they add nothing
+  const __m128d shifted = _mm_and_pd(_mm_sub_pd(values, shift), _mm_cmpord_pd(values, values));
+  *sum = _mm_add_pd(*sum, shifted);
+  *sumOfSquares = _mm_add_pd(*sumOfSquares, _mm_mul_pd(shifted, shifted));
+}
+
+void reduce(__m128d minimum, __m128d maximum, __m128d sum, __m128d sumOfSquares, Accumulator *accumulator) {
+  double lanes[2];
+  _mm_storeu_pd(lanes, minimum);
+  accumulator->minimum = std::min({accumulator->minimum, lanes[0], lanes[1]});
+  _mm_storeu_pd(lanes, maximum);
+  accumulator->maximum = std::max({accumulator->maximum, lanes[0], lanes[1]});
+  _mm_storeu_pd(lanes, sum);
+  accumulator->shiftedSum += lanes[0]+lanes[1];
+  _mm_storeu_pd(lanes, sumOfSquares);
+  accumulator->shiftedSumOfSquares += lanes[0]+lanes[1];
+}
+
+double horizontalSum(__m128d values) {
+  double lanes[2];
+  _mm_storeu_pd(lanes, values);
+  return lanes[0]+lanes[1];
+}
+
+// int32 and uint32. SSE2 only compares signed 32 bit integers and only converts those to double, so unsigned values
+//  are biased into the signed range first and the bias is added back in double, where it's exact.
+template<typename T>
+void accumulate32BitIntegers(const T *data, size_t size, double shift, Accumulator *accumulator) {
+  static_assert(sizeof(T) == 4, "Only for 32 bit integers");
+  constexpr bool kBiased = std::is_unsigned_v<T>;
+  const __m128i bias = _mm_set1_epi32(kBiased ? std::numeric_limits<int32_t>::min() : 0);
+  const double offset = (kBiased ? 2147483648.0 : 0.0);
+  __m128i minimum = _mm_set1_epi32(std::numeric_limits<int32_t>::max());
+  __m128i maximum = _mm_set1_epi32(std::numeric_limits<int32_t>::min());
+  // Subtracting this from a biased value gives the value minus the shift
+  const __m128d shiftVector = _mm_set1_pd(shift-offset);
+  // Separate accumulators for the low and high pair of lanes, so their additions overlap
+  __m128d lowSum = _mm_setzero_pd();
+  __m128d highSum = _mm_setzero_pd();
+  __m128d lowSumOfSquares = _mm_setzero_pd();
+  __m128d highSumOfSquares = _mm_setzero_pd();
+  size_t index = 0;
+  for (; index+4<=size; index+=4) {
+    const __m128i values = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data+index)), bias);
+    // There's no 32 bit min or max before SSE4.1, so select with a comparison
+    const __m128i less = _mm_cmplt_epi32(values, minimum);
+    minimum = _mm_or_si128(_mm_and_si128(less, values), _mm_andnot_si128(less, minimum));
+    const __m128i greater = _mm_cmpgt_epi32(values, maximum);
+    maximum = _mm_or_si128(_mm_and_si128(greater, values), _mm_andnot_si128(greater, maximum));
+    const __m128d low = _mm_sub_pd(_mm_cvtepi32_pd(values), shiftVector);
+    const __m128d high = _mm_sub_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(values, _MM_SHUFFLE(1, 0, 3, 2))), shiftVector);
+    lowSum = _mm_add_pd(lowSum, low);
+    highSum = _mm_add_pd(highSum, high);
+    lowSumOfSquares = _mm_add_pd(lowSumOfSquares, _mm_mul_pd(low, low));
+    highSumOfSquares = _mm_add_pd(highSumOfSquares, _mm_mul_pd(high, high));
+  }
+  if (index > 0) {
+    int32_t lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), minimum);
+    accumulator->minimum = std::min(accumulator->minimum, *std::min_element(lanes, lanes+4)+offset);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), maximum);
+    accumulator->maximum = std::max(accumulator->maximum, *std::max_element(lanes, lanes+4)+offset);
+    accumulator->shiftedSum += horizontalSum(_mm_add_pd(lowSum, highSum));
+    accumulator->shiftedSumOfSquares += horizontalSum(_mm_add_pd(lowSumOfSquares, highSumOfSquares));
+  }
+  accumulateIntegers(data+index, size-index, shift, accumulator);
+}
+
+template<>
+void accumulate<int32_t>(const int32_t *data, size_t size, double shift, Accumulator *accumulator) {
+  accumulate32BitIntegers(data, size, shift, accumulator);
+}
+
+template<>
+void accumulate<uint32_t>(const uint32_t *data, size_t size, double shift, Accumulator *accumulator) {
+  accumulate32BitIntegers(data, size, shift, accumulator);
+}
+
+template<>
+void accumulate<float>(const float *data, size_t size, double shift, Accumulator *accumulator) {
+  __m128 minimum = _mm_set1_ps(std::numeric_limits<float>::infinity());
+  __m128 maximum = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+  const __m128d shiftVector = _mm_set1_pd(shift);
+  __m128d sum = _mm_setzero_pd();
+  __m128d sumOfSquares = _mm_setzero_pd();
+  size_t index = 0;
+  for (; index+4<=size; index+=4) {
+    const __m128 values = _mm_loadu_ps(data+index);
+    accumulator->nanCount += 4-kBitCount[_mm_movemask_ps(_mm_cmpord_ps(values, values))];
+    // minps and maxps return their second operand if either is NaN, so a NaN never replaces the running value
+    minimum = _mm_min_ps(values, minimum);
+    maximum = _mm_max_ps(values, maximum);
+    // The sums are kept in double, as they are for every other type
+    addShifted(_mm_cvtps_pd(values), shiftVector, &sum, &sumOfSquares);
+    addShifted(_mm_cvtps_pd(_mm_movehl_ps(values, values)), shiftVector, &sum, &sumOfSquares);
+  }
+  float lanes[4];
+  _mm_storeu_ps(lanes, minimum);
+  const __m128d wideMinimum = _mm_set1_pd(*std::min_element(lanes, lanes+4));
+  _mm_storeu_ps(lanes, maximum);
+  const __m128d wideMaximum = _mm_set1_pd(*std::max_element(lanes, lanes+4));
+  reduce(wideMinimum, wideMaximum, sum, sumOfSquares, accumulator);
+  accumulateScalar(data+index, size-index, shift, accumulator);
+}
+
+template<>
+void accumulate<double>(const double *data, size_t size, double shift, Accumulator *accumulator) {
+  __m128d minimum = _mm_set1_pd(std::numeric_limits<double>::infinity());
+  __m128d maximum = _mm_set1_pd(-std::numeric_limits<double>::infinity());
+  const __m128d shiftVector = _mm_set1_pd(shift);
+  __m128d sum = _mm_setzero_pd();
+  __m128d sumOfSquares = _mm_setzero_pd();
+  size_t index = 0;
+  for (; index+2<=size; index+=2) {
+    const __m128d values = _mm_loadu_pd(data+index);
+    accumulator->nanCount += 2-kBitCount[_mm_movemask_pd(_mm_cmpord_pd(values, values))];
+    minimum = _mm_min_pd(values, minimum);
+    maximum = _mm_max_pd(values, maximum);
+    addShifted(values, shiftVector, &sum, &sumOfSquares);
+  }
+  reduce(minimum, maximum, sum, sumOfSquares, accumulator);
+  accumulateScalar(data+index, size-index, shift, accumulator);
+}
+
+#endif // __SSE2__
+
+int binIndex(double value, double minimum, double maximum, int binCount) {
+  if (!(maximum > minimum)) {
+    return 0;
+  }
+  const double bin = std::floor((value-minimum)/(maximum-minimum)*binCount);
+  return static_cast<int>(std::clamp(bin, 0.0, static_cast<double>(binCount-1)));
+}
+
+template<typename T>
+void fillHistogram(const T *data, size_t size, double minimum, double maximum, std::vector<uint64_t> *histogram) {
+  const int binCount = static_cast<int>(histogram->size());
+  for (size_t index=0; index<size; ++index) {
+    const double value = static_cast<double>(data[index]);
+    if constexpr (std::is_floating_point_v<T>) {
+      if (std::isnan(value)) {
+        continue;
+      }
+    }
+    ++(*histogram)[binIndex(value, minimum, maximum, binCount)];
+  }
+}
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+bool NumericStats::supports(const pb::FieldDescriptor *fieldDescriptor) {
+  if (!fieldDescriptor->is_repeated()) {
+    return false;
+  }
+  switch (fieldDescriptor->cpp_type()) {
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT32:
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT64:
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT32:
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT64:
+    case pb::FieldDescriptor::CppType::CPPTYPE_FLOAT:
+    case pb::FieldDescriptor::CppType::CPPTYPE_DOUBLE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+NumericStats::NumericStats(const pb::FieldDescriptor *fieldDescriptor, int binCount) : fieldDescriptor_(fieldDescriptor), binCount_(std::max(binCount, 1)) {
+  if (!supports(fieldDescriptor_)) {
+    throw std::runtime_error("Statistics were requested for \""+fieldDescriptor_->full_name()+"\", which is not a repeated numeric field");
+  }
+}
+
+void NumericStats::compute(const pb::Message &message) {
+  auto computeOver = [this](const auto &field) {
+    const auto *data = field.data();
+    const size_t size = static_cast<size_t>(field.size());
+    Accumulator accumulator;
+    shift_ = firstValue(data, size);
+    accumulate(data, size, shift_, &accumulator);
+    count_ = size-accumulator.nanCount;
+    nanCount_ = accumulator.nanCount;
+    minimum_ = (count_ > 0 ? accumulator.minimum : 0);
+    maximum_ = (count_ > 0 ? accumulator.maximum : 0);
+    shiftedSum_ = accumulator.shiftedSum;
+    shiftedSumOfSquares_ = accumulator.shiftedSumOfSquares;
+    // Binning needs the range, so it's a second pass
+    histogram_.assign(binCount_, 0);
+    histogramMinimum_ = minimum_;
+    histogramMaximum_ = maximum_;
+    fillHistogram(data, size, histogramMinimum_, histogramMaximum_, &histogram_);
+  };
+  switch (fieldDescriptor_->cpp_type()) {
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT32:
+      computeOver(repeatedField<int32_t>(message, fieldDescriptor_));
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT64:
+      computeOver(repeatedField<int64_t>(message, fieldDescriptor_));
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT32:
+      computeOver(repeatedField<uint32_t>(message, fieldDescriptor_));
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT64:
+      computeOver(repeatedField<uint64_t>(message, fieldDescriptor_));
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_FLOAT:
+      computeOver(repeatedField<float>(message, fieldDescriptor_));
+      break;
+    case pb::FieldDescriptor::CppType::CPPTYPE_DOUBLE:
+      computeOver(repeatedField<double>(message, fieldDescriptor_));
+      break;
+    default:
+      throw std::runtime_error("Unsupported type for statistics");
+  }
+}
+
+bool NumericStats::replaceValue(double previousValue, double value) {
+  const bool previousIsNan = std::isnan(previousValue);
+  const bool isNan = std::isnan(value);
+  // The next extreme can only be found by looking at every element
+  if (!previousIsNan && previousValue == minimum_ && (isNan || value > minimum_)) {
+    return false;
+  }
+  if (!previousIsNan && previousValue == maximum_ && (isNan || value < maximum_)) {
+    return false;
+  }
+  // The histogram's bins only cover the range it was computed with
+  if (!isNan && (count_ == 0 || value < histogramMinimum_ || value > histogramMaximum_)) {
+    return false;
+  }
+
+  if (previousIsNan) {
+    --nanCount_;
+  } else {
+    --count_;
+    const double shifted = previousValue-shift_;
+    shiftedSum_ -= shifted;
+    shiftedSumOfSquares_ -= shifted*shifted;
+    --histogram_[binOf(previousValue)];
+  }
+  if (isNan) {
+    ++nanCount_;
+  } else {
+    ++count_;
+    const double shifted = value-shift_;
+    shiftedSum_ += shifted;
+    shiftedSumOfSquares_ += shifted*shifted;
+    ++histogram_[binOf(value)];
+    minimum_ = std::min(minimum_, value);
+    maximum_ = std::max(maximum_, value);
+  }
+  return true;
+}
+
+int NumericStats::binOf(double value) const {
+  return binIndex(value, histogramMinimum_, histogramMaximum_, binCount_);
+}
+
+size_t NumericStats::count() const {
+  return count_;
+}
+
+size_t NumericStats::nanCount() const {
+  return nanCount_;
+}
+
+double NumericStats::minimum() const {
+  return minimum_;
+}
+
+double NumericStats::maximum() const {
+  return maximum_;
+}
+
+double NumericStats::mean() const {
+  if (count_ == 0) {
+    return 0;
+  }
+  return shift_ + shiftedSum_/count_;
+}
+
+double NumericStats::standardDeviation() const {
+  if (count_ == 0) {
+    return 0;
+  }
+  const double variance = (shiftedSumOfSquares_ - shiftedSum_*shiftedSum_/count_)/count_;
+  // Rounding can make it slightly negative when every value is the same
+  return std::sqrt(std::max(variance, 0.0));
+}
+
+const std::vector<uint64_t>& NumericStats::histogram() const {
+  return histogram_;
+}
+
+double NumericStats::histogramMinimum() const {
+  return histogramMinimum_;
+}
+
+double NumericStats::histogramMaximum() const {
+  return histogramMaximum_;
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
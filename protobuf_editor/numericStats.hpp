@@ -0,0 +1,64 @@
+#ifndef PROTOBUF_EDITOR_NUMERIC_STATS_HPP_
+#define PROTOBUF_EDITOR_NUMERIC_STATS_HPP_
+
+#include <google/protobuf/message.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace protobuf_editor {
+
+// Summary statistics of a repeated numeric field: int32, int64, uint32, uint64, float or double. They're computed
+//  straight over the field's contiguous storage, with SSE2 kernels for 32 bit integers, float and double where
+//  available, so a field with millions of elements can be checked without formatting a single value.
+// The sums are kept, shifted by the first value to limit cancellation, so that when a single element changes the
+//  statistics can usually be updated without looking at the other elements.
+class NumericStats {
+public:
+  static constexpr int kDefaultBinCount = 32;
+
+  // Whether the field is repeated and of one of the supported types
+  static bool supports(const google::protobuf::FieldDescriptor *fieldDescriptor);
+
+  explicit NumericStats(const google::protobuf::FieldDescriptor *fieldDescriptor, int binCount=kDefaultBinCount);
+  // Computes everything from scratch. `message` contains the field.
+  void compute(const google::protobuf::Message &message);
+  // Updates the statistics after one element changed from `previousValue` to `value`. Returns false if that isn't
+  //  possible, e.g. because the previous value was the minimum, and compute must be called instead. Nothing is
+  //  modified in that case.
+  bool replaceValue(double previousValue, double value);
+
+  // Not counting NaNs
+  size_t count() const;
+  size_t nanCount() const;
+  // Only meaningful if count() is not 0
+  double minimum() const;
+  double maximum() const;
+  double mean() const;
+  // The population standard deviation
+  double standardDeviation() const;
+  // Counts of values in evenly sized bins from minimum to maximum, as they were when last computed
+  const std::vector<uint64_t>& histogram() const;
+  double histogramMinimum() const;
+  double histogramMaximum() const;
+private:
+  const google::protobuf::FieldDescriptor* const fieldDescriptor_;
+  const int binCount_;
+  size_t count_{0};
+  size_t nanCount_{0};
+  double minimum_{0};
+  double maximum_{0};
+  // Sums of (value-shift_) and its square
+  double shift_{0};
+  double shiftedSum_{0};
+  double shiftedSumOfSquares_{0};
+  std::vector<uint64_t> histogram_;
+  double histogramMinimum_{0};
+  double histogramMaximum_{0};
+  int binOf(double value) const;
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_NUMERIC_STATS_HPP_
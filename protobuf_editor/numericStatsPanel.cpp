@@ -0,0 +1,97 @@
+#include "numericStatsPanel.hpp"
+
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QPainter>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr int kHistogramHeight = 80;
+constexpr int kHistogramMinimumWidth = 160;
+
+// Draws the bins as bars, scaled so that the fullest bin fills the height
+class HistogramWidget : public QWidget {
+public:
+  HistogramWidget() {
+    setMinimumSize(kHistogramMinimumWidth, kHistogramHeight);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+  }
+  void setBins(std::vector<uint64_t> bins, double minimum, double maximum) {
+    bins_ = std::move(bins);
+    setToolTip(tr("%1 bins from %2 to %3").arg(bins_.size()).arg(minimum).arg(maximum));
+    update();
+  }
+protected:
+  void paintEvent(QPaintEvent *) override {
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().base());
+    if (bins_.empty()) {
+      return;
+    }
+    const uint64_t fullest = *std::max_element(bins_.begin(), bins_.end());
+    if (fullest == 0) {
+      return;
+    }
+    const double binWidth = static_cast<double>(width())/bins_.size();
+    for (size_t bin=0; bin<bins_.size(); ++bin) {
+      const double barHeight = static_cast<double>(bins_[bin])/fullest*height();
+      painter.fillRect(QRectF(bin*binWidth, height()-barHeight, binWidth, barHeight), palette().highlight());
+    }
+  }
+private:
+  std::vector<uint64_t> bins_;
+};
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+NumericStatsPanel::NumericStatsPanel(QWidget *parent) : QWidget(parent) {
+  buildWidget();
+}
+
+void NumericStatsPanel::buildWidget() {
+  QFormLayout *formLayout = new QFormLayout;
+  auto createLabel = [formLayout](const QString &name) {
+    QLabel *label = new QLabel;
+    label->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    formLayout->addRow(name, label);
+    return label;
+  };
+  countLabel_ = createLabel(tr("Count"));
+  nanCountLabel_ = createLabel(tr("NaNs"));
+  minimumLabel_ = createLabel(tr("Minimum"));
+  maximumLabel_ = createLabel(tr("Maximum"));
+  meanLabel_ = createLabel(tr("Mean"));
+  standardDeviationLabel_ = createLabel(tr("Std. deviation"));
+
+  histogramWidget_ = new HistogramWidget;
+
+  QHBoxLayout *layout = new QHBoxLayout(this);
+  layout->setContentsMargins(0,0,0,0);
+  layout->addLayout(formLayout);
+  layout->addWidget(histogramWidget_, 1);
+}
+
+void NumericStatsPanel::setStats(const NumericStats &stats) {
+  countLabel_->setText(QString::number(stats.count()));
+  nanCountLabel_->setText(QString::number(stats.nanCount()));
+  if (stats.count() == 0) {
+    minimumLabel_->clear();
+    maximumLabel_->clear();
+    meanLabel_->clear();
+    standardDeviationLabel_->clear();
+  } else {
+    minimumLabel_->setText(QString::number(stats.minimum(), 'g', 10));
+    maximumLabel_->setText(QString::number(stats.maximum(), 'g', 10));
+    meanLabel_->setText(QString::number(stats.mean(), 'g', 10));
+    standardDeviationLabel_->setText(QString::number(stats.standardDeviation(), 'g', 10));
+  }
+  static_cast<HistogramWidget*>(histogramWidget_)->setBins(stats.histogram(), stats.histogramMinimum(), stats.histogramMaximum());
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
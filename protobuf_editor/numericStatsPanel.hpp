@@ -0,0 +1,32 @@
+#ifndef PROTOBUF_EDITOR_NUMERIC_STATS_PANEL_HPP_
+#define PROTOBUF_EDITOR_NUMERIC_STATS_PANEL_HPP_
+
+#include "numericStats.hpp"
+
+#include <QLabel>
+#include <QWidget>
+
+namespace protobuf_editor {
+
+// Shows a NumericStats: the count, NaNs, minimum, maximum, mean and standard deviation, and a histogram of the
+//  values.
+class NumericStatsPanel : public QWidget {
+  Q_OBJECT
+public:
+  explicit NumericStatsPanel(QWidget *parent=nullptr);
+  void setStats(const NumericStats &stats);
+private:
+  QLabel *countLabel_{nullptr};
+  QLabel *nanCountLabel_{nullptr};
+  QLabel *minimumLabel_{nullptr};
+  QLabel *maximumLabel_{nullptr};
+  QLabel *meanLabel_{nullptr};
+  QLabel *standardDeviationLabel_{nullptr};
+  QWidget *histogramWidget_{nullptr};
+  void buildWidget();
+signals:
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_NUMERIC_STATS_PANEL_HPP_
@@ -0,0 +1,189 @@
+#include "builtInTypeWidget.hpp"
+#include "descriptorLayout.hpp"
+#include "fieldValue.hpp"
+#include "instrumentation.hpp"
+#include "messageTypeWidget.hpp"
+#include "oneofWidget.hpp"
+#include "sizeProfile.hpp"
+
+#include <QSignalBlocker>
+
+namespace pb = google::protobuf;
+
+namespace protobuf_editor {
+
+OneofWidget::OneofWidget(const pb::OneofDescriptor *oneofDescriptor, QWidget *parent) : ProtobufFieldWidget(nullptr, parent), oneofDescriptor_(oneofDescriptor) {
+  buildWidget();
+}
+
+void OneofWidget::buildWidget() {
+  QVBoxLayout *overallLayout = new QVBoxLayout(this);
+  overallLayout->setContentsMargins(0,0,0,0);
+  groupBox_ = new QGroupBox(QString::fromStdString(oneofDescriptor_->full_name()));
+  overallLayout->addWidget(groupBox_);
+  QVBoxLayout *groupBoxLayout = new QVBoxLayout(groupBox_);
+
+  // Listing the members only needs their names, no widget is built for any of them yet
+  caseComboBox_ = new QComboBox;
+  caseComboBox_->addItem(tr("(not set)"));
+  for (int memberIndex=0; memberIndex<oneofDescriptor_->field_count(); ++memberIndex) {
+    caseComboBox_->addItem(fieldLayout(oneofDescriptor_->field(memberIndex)).label);
+  }
+  connect(caseComboBox_, QOverload<int>::of(&QComboBox::activated), this, &OneofWidget::onCaseSelected);
+  groupBoxLayout->addWidget(caseComboBox_);
+
+  memberLayout_ = new QVBoxLayout;
+  memberLayout_->setContentsMargins(0,0,0,0);
+  groupBoxLayout->addLayout(memberLayout_);
+  memberWidgets_.assign(oneofDescriptor_->field_count(), nullptr);
+}
+
+int OneofWidget::activeMemberIndex() const {
+  const pb::FieldDescriptor *activeFieldDescriptor = currentMessage_->GetReflection()->GetOneofFieldDescriptor(*currentMessage_, oneofDescriptor_);
+  return (activeFieldDescriptor != nullptr ? activeFieldDescriptor->index_in_oneof() : -1);
+}
+
+void OneofWidget::setDataFromMessage() {
+  if (currentMessage_ == nullptr) {
+    throw std::runtime_error("Setting data from message, but message is null");
+  }
+  const int memberIndex = activeMemberIndex();
+  {
+    // Only reflecting the message, not a user's choice
+    const QSignalBlocker blocker(caseComboBox_);
+    caseComboBox_->setCurrentIndex(memberIndex+1);
+  }
+  showMember(memberIndex);
+  updateSizeOverlay();
+}
+
+void OneofWidget::showMember(int memberIndex) {
+  if (memberIndex != shownMemberIndex_ && shownMemberIndex_ != -1) {
+    // Kept for when this member is selected again. Whatever it pointed to in the message is gone once another member
+    //  is set, so it lets go of that until it's shown again.
+    ProtobufFieldWidget *hiddenWidget = memberWidgets_.at(shownMemberIndex_);
+    hiddenWidget->setVisible(false);
+    hiddenWidget->clearMessage();
+  }
+  shownMemberIndex_ = memberIndex;
+  if (memberIndex == -1) {
+    return;
+  }
+  ProtobufFieldWidget *&memberWidget = memberWidgets_.at(memberIndex);
+  if (memberWidget == nullptr) {
+    // First time this member is selected
+    const pb::FieldDescriptor *fieldDescriptor = oneofDescriptor_->field(memberIndex);
+    PROTOBUF_EDITOR_TIME_SCOPE("OneofWidget::showMember " + fieldDescriptor->full_name());
+    if (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE) {
+      memberWidget = new MessageTypeWidget(fieldDescriptor->message_type(), fieldDescriptor);
+    } else {
+      memberWidget = new BuiltInTypeWidget(fieldDescriptor);
+    }
+    memberWidget->setParentFieldWidget(this);
+    memberLayout_->addWidget(memberWidget);
+  }
+  // Given the message before it's made visible, so it never shows what it showed last time
+  setDataForMemberWidget(memberIndex);
+  memberWidget->setVisible(true);
+}
+
+void OneofWidget::setDataForMemberWidget(int memberIndex) {
+  ProtobufFieldWidget *memberWidget = memberWidgets_.at(memberIndex);
+  const pb::FieldDescriptor *fieldDescriptor = oneofDescriptor_->field(memberIndex);
+  const pb::Reflection *reflection = currentMessage_->GetReflection();
+  if (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE) {
+    // Only ever called for the member which is set, so MutableMessage doesn't switch the oneof to it
+    if (isReadOnly()) {
+      memberWidget->setReadOnlyMessage(&reflection->GetMessage(*currentMessage_, fieldDescriptor), currentMessage_);
+    } else {
+      memberWidget->setMessage(reflection->MutableMessage(mutableCurrentMessage(), fieldDescriptor), mutableCurrentMessage());
+    }
+  } else if (isReadOnly()) {
+    memberWidget->setReadOnlyMessage(currentMessage_, currentMessage_);
+  } else {
+    // The message which holds this member's data is also its parent message
+    memberWidget->setMessage(mutableCurrentMessage(), mutableCurrentMessage());
+  }
+}
+
+void OneofWidget::onCaseSelected(int comboBoxIndex) {
+  PROTOBUF_EDITOR_TIME_SCOPE("edit " + oneofDescriptor_->full_name());
+  if (currentMessage_ == nullptr) {
+    throw std::runtime_error("Something went wrong. This should not be possible without a message");
+  }
+  const int previousMemberIndex = activeMemberIndex();
+  const int memberIndex = comboBoxIndex-1;
+  if (isReadOnly()) {
+    // The message is only being viewed, put back what's in it
+    const QSignalBlocker blocker(caseComboBox_);
+    caseComboBox_->setCurrentIndex(previousMemberIndex+1);
+    return;
+  }
+  if (memberIndex == previousMemberIndex) {
+    return;
+  }
+
+  // The edit is recorded under the member being set, or the one being cleared. Either way, undo puts back whichever
+  //  member was set before.
+  const FieldPath path(oneofDescriptor_->field(memberIndex != -1 ? memberIndex : previousMemberIndex));
+  beginFieldEdit(path);
+  pb::Message *message = mutableCurrentMessage();
+  const pb::Reflection *reflection = message->GetReflection();
+  reflection->ClearOneof(message, oneofDescriptor_);
+  if (memberIndex != -1) {
+    const pb::FieldDescriptor *fieldDescriptor = oneofDescriptor_->field(memberIndex);
+    if (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE) {
+      reflection->MutableMessage(message, fieldDescriptor);
+    } else {
+      writeDefaultFieldValue(message, fieldDescriptor);
+    }
+  }
+  showMember(memberIndex);
+  updateSizeOverlay();
+  reportFieldChanged(path);
+  if (memberIndex != -1 && previousMemberIndex != -1) {
+    // The member which was cleared changed too
+    reportFieldChanged(FieldPath(oneofDescriptor_->field(previousMemberIndex)));
+  }
+}
+
+void OneofWidget::refreshFieldPath(const FieldPath &path, size_t position) {
+  if (currentMessage_ == nullptr) {
+    return;
+  }
+  const int memberIndex = activeMemberIndex();
+  const pb::FieldDescriptor *fieldDescriptor = path.at(position).fieldDescriptor;
+  if (memberIndex != shownMemberIndex_ || memberIndex != fieldDescriptor->index_in_oneof() || position+1 == path.size()) {
+    // Which member is set may have changed, and only the member which is set has a widget. Re-reading that is cheap.
+    setDataFromMessage();
+    return;
+  }
+  // Something inside of the member which is set changed
+  memberWidgets_.at(memberIndex)->refreshFieldPath(path, position);
+}
+
+ProtobufFieldWidget* OneofWidget::memberWidget(const pb::FieldDescriptor *fieldDescriptor) const {
+  if (fieldDescriptor->real_containing_oneof() != oneofDescriptor_ || fieldDescriptor->index_in_oneof() != shownMemberIndex_) {
+    return nullptr;
+  }
+  return memberWidgets_.at(shownMemberIndex_);
+}
+
+void OneofWidget::updateSizeOverlay() {
+  const QString title = QString::fromStdString(oneofDescriptor_->full_name());
+  if (shownMemberIndex_ == -1) {
+    groupBox_->setTitle(title);
+    return;
+  }
+  // Only the member which is shown, hidden members pick up the sizes when they're shown again
+  FieldPath memberPath = sizePath_;
+  memberPath.append(oneofDescriptor_->field(shownMemberIndex_));
+  memberWidgets_.at(shownMemberIndex_)->showSizes(sizeProfile_, memberPath);
+  if (sizeProfile_ == nullptr) {
+    groupBox_->setTitle(title);
+  } else {
+    groupBox_->setTitle(tr("%1 (%2)").arg(title, locale().formattedDataSize(static_cast<qint64>(sizeProfile_->fieldBytes(memberPath)))));
+  }
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef PROTOBUF_EDITOR_ONEOF_WIDGET_HPP_
+#define PROTOBUF_EDITOR_ONEOF_WIDGET_HPP_
+
+#include "protobufFieldWidget.hpp"
+
+#include <google/protobuf/message.h>
+
+#include <QComboBox>
+#include <QGroupBox>
+#include <QVBoxLayout>
+
+#include <vector>
+
+namespace protobuf_editor {
+
+// A widget for editing a oneof, with a selector for which of its members is set. Only the set member has a widget.
+//  Member widgets are built the first time their member is selected, and are kept around, hidden, when another member
+//  is selected, so a oneof with hundreds of members costs no more to open than one with a single member.
+// Unlike other field widgets, this one stands for several fields. It is given the message which contains the oneof,
+//  like a BuiltInTypeWidget, and the paths it reports are those of its members. The sizes path passed to showSizes
+//  names the message which contains the oneof.
+class OneofWidget : public ProtobufFieldWidget {
+  Q_OBJECT
+public:
+  explicit OneofWidget(const google::protobuf::OneofDescriptor *oneofDescriptor, QWidget *parent=nullptr);
+  // `path.at(position)` names one of our members
+  void refreshFieldPath(const FieldPath &path, size_t position) override;
+  // The widget of the member, if it's the one which is set. Null otherwise.
+  ProtobufFieldWidget* memberWidget(const google::protobuf::FieldDescriptor *fieldDescriptor) const;
+private:
+  const google::protobuf::OneofDescriptor* const oneofDescriptor_;
+  QGroupBox *groupBox_{nullptr};
+  QComboBox *caseComboBox_{nullptr};
+  QVBoxLayout *memberLayout_{nullptr};
+  // Indexed the same as the oneof's fields, null until first selected
+  std::vector<ProtobufFieldWidget*> memberWidgets_;
+  // The index, within the oneof, of the member whose widget is shown, -1 for none
+  int shownMemberIndex_{-1};
+  void buildWidget();
+  void setDataFromMessage() override;
+  void updateSizeOverlay() override;
+  // -1 if no member is set
+  int activeMemberIndex() const;
+  void onCaseSelected(int comboBoxIndex);
+  // Also gives the member's widget its data, -1 to hide all of them
+  void showMember(int memberIndex);
+  void setDataForMemberWidget(int memberIndex);
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_ONEOF_WIDGET_HPP_
@@ -1,39 +1,406 @@
 #include "protobufEditor.hpp"
+#include "editHistory.hpp"
+#include "fieldSearchIndex.hpp"
+#include "instrumentation.hpp"
+#include "messageFileTask.hpp"
 #include "messageTypeWidget.hpp"
+#include "protobufItemDelegate.hpp"
+#include "protobufMessageModel.hpp"
+#include "sizeProfile.hpp"
+#include "sizeProfilePanel.hpp"
 
 #include "proto/test.pb.h"
 
+#include <google/protobuf/text_format.h>
+
+#include <QAction>
+#include <QHeaderView>
+#include <QPointer>
 #include <QScrollArea>
+#include <QTimer>
+#include <QToolBar>
 #include <QVBoxLayout>
 
-#include <iostream>
+#include <optional>
 
 namespace pb = google::protobuf;
 
+namespace {
+
+constexpr int kNotificationDebounceMilliseconds = 250;
+constexpr size_t kMaxSearchResults = 20;
+
+} // anonymous namespace
+
 ProtobufEditor::ProtobufEditor(QWidget *parent) : QWidget{parent} {
   // Create a layout for this widget
   QVBoxLayout *layout = new QVBoxLayout(this);
 
+  // A toolbar for switching between the different ways of editing the message
+  toolBar_ = new QToolBar;
+  QAction *treeModeAction = toolBar_->addAction(tr("Tree View"));
+  treeModeAction->setCheckable(true);
+  connect(treeModeAction, &QAction::toggled, [this](bool checked){
+    setEditorMode(checked ? EditorMode::kTree : EditorMode::kWidgets);
+  });
+
+  // Finds a field by name, path or value, as it's typed
+  searchLineEdit_ = new QLineEdit;
+  searchLineEdit_->setPlaceholderText(tr("Find field..."));
+  searchLineEdit_->setClearButtonEnabled(true);
+  searchResultsModel_ = new QStringListModel(this);
+  searchCompleter_ = new QCompleter(searchResultsModel_, this);
+  // The results are already filtered and ordered by the index
+  searchCompleter_->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+  searchCompleter_->setWidget(searchLineEdit_);
+  connect(searchLineEdit_, &QLineEdit::textEdited, this, &ProtobufEditor::updateSearchResults);
+  connect(searchCompleter_, QOverload<const QString&>::of(&QCompleter::activated), [this](const QString &pathString){
+    revealField(protobuf_editor::FieldPath::parse(document_->message()->GetDescriptor(), pathString.toStdString()));
+  });
+  connect(searchLineEdit_, &QLineEdit::returnPressed, [this]{
+    // Go to the best match
+    if (searchResultsModel_->rowCount() > 0) {
+      const QString pathString = searchResultsModel_->index(0).data().toString();
+      revealField(protobuf_editor::FieldPath::parse(document_->message()->GetDescriptor(), pathString.toStdString()));
+    }
+  });
+  toolBar_->addWidget(searchLineEdit_);
+
+  // Shows the bytes each field takes up when encoded
+  sizesAction_ = toolBar_->addAction(tr("Sizes"));
+  sizesAction_->setCheckable(true);
+  connect(sizesAction_, &QAction::toggled, this, &ProtobufEditor::setSizesShown);
+  layout->addWidget(toolBar_);
+
   // Since the protobuf message could be arbitrarily large, this view will be scrollable
-  QScrollArea *scrollArea = new QScrollArea;
+  scrollArea_ = new QScrollArea;
+
+  // Alternatively, the message can be edited through a model/view. Only the visible rows of the tree are created, and
+  //  an editor widget only exists for the cell which is being edited.
+  messageModel_ = new protobuf_editor::ProtobufMessageModel(this);
+  treeView_ = new QTreeView;
+  treeView_->setItemDelegate(new protobuf_editor::ProtobufItemDelegate(protobuf_editor::ProtobufMessageModel::FieldDescriptorRole, treeView_));
+  treeView_->setUniformRowHeights(true);
+  treeView_->setModel(messageModel_);
+  treeView_->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+  stackedWidget_ = new QStackedWidget;
+  stackedWidget_->addWidget(scrollArea_);
+  stackedWidget_->addWidget(treeView_);
+  layout->addWidget(stackedWidget_);
+
+  sizeProfile_ = std::make_unique<protobuf_editor::SizeProfile>();
+  sizeProfilePanel_ = new protobuf_editor::SizeProfilePanel;
+  sizeProfilePanel_->setVisible(false);
+  connect(sizeProfilePanel_, &protobuf_editor::SizeProfilePanel::fieldActivated, this, &ProtobufEditor::revealField);
+  layout->addWidget(sizeProfilePanel_);
+
+  // Rather than hearing about every keystroke, collect the edits and hear about them once the user pauses
+  messageModel_->setNotificationMode(protobuf_editor::ChangeNotifier::Mode::kBatched, kNotificationDebounceMilliseconds);
+  // When any edits are made in the model, this signal will be emitted with the fields which changed
+  connect(messageModel_, &protobuf_editor::ProtobufMessageModel::fieldsChanged, this, &ProtobufEditor::onFieldsChanged);
 
+  editHistory_ = new protobuf_editor::EditHistory(this);
+
+  // Until told otherwise, edit the message type which is compiled into the application
+  setMessageType(proto::test::Test::default_instance());
+}
+
+ProtobufEditor::~ProtobufEditor() {
+  // A worker may still be loading into loadingDocument_ or saving from document_, it must be done before they're freed
+  delete fileTask_;
+}
+
+ProtobufEditor::EditorMode ProtobufEditor::editorMode() const {
+  return editorMode_;
+}
+
+void ProtobufEditor::setEditorMode(EditorMode mode) {
+  if (mode == editorMode_) {
+    return;
+  }
+  editorMode_ = mode;
+  // Only the active view is kept in sync with the message, so refresh the one we're switching to
+  if (editorMode_ == EditorMode::kTree) {
+    messageModel_->setMessage(document_->message());
+    stackedWidget_->setCurrentWidget(treeView_);
+    // Undoing past edits which weren't recorded could put fields back into states which no longer fit
+    editHistory_->clear();
+  } else {
+    messageModel_->setMessage(nullptr);
+    messageTypeWidget_->setMessage(document_->message());
+    stackedWidget_->setCurrentIndex(0);
+  }
+}
+
+bool ProtobufEditor::setMessageType(const pb::Message &prototype) {
+  if (isFileOperationRunning()) {
+    return false;
+  }
   // Get the descriptor of the message that we want to be able to edit. This descriptor is how the widget knows what UI elements to build
-  const pb::Descriptor *desc = proto::test::Test::GetDescriptor();
+  const pb::Descriptor *desc = prototype.GetDescriptor();
+
+  // The model must let go of the old message before it is freed
+  messageModel_->setMessage(nullptr);
 
   // Construct a widget to edit a protobuf message, pass the descriptor
-  protobuf_editor::MessageTypeWidget *w = new protobuf_editor::MessageTypeWidget(desc);
+  messageTypeWidget_ = new protobuf_editor::MessageTypeWidget(desc);
+
+  // Make this message editing widget the main widget of the scroll area. This deletes the widget for the previous type.
+  scrollArea_->setWidget(messageTypeWidget_);
+
+  // Allocate a message for the widget to reference, on the arena of a new document. The widget will always reference this, so it must outlive the widget
+  document_ = std::make_unique<protobuf_editor::MessageDocument>(prototype, documentOptions_);
+
+  // Rather than hearing about every keystroke, collect the edits and hear about them once the user pauses
+  messageTypeWidget_->setNotificationMode(protobuf_editor::ChangeNotifier::Mode::kBatched, kNotificationDebounceMilliseconds);
+
+  // Shared by every editor of this type, only the values of this message are read
+  searchIndex_ = std::make_unique<protobuf_editor::FieldSearchIndex>(desc);
+  searchIndex_->setMessage(document_->message());
+
+  // Sizes are computed once for the whole message, then only along the paths of edits
+  sizeProfile_->setMessage(document_->message());
+
+  // Record every edit, so that it can be undone
+  messageTypeWidget_->setEditHistory(editHistory_);
+  editHistory_->clear();
+
+  // When any edits are made in the widget, this signal will be emitted with the fields which changed
+  connect(messageTypeWidget_, &protobuf_editor::ProtobufFieldWidget::fieldsChanged, this, &ProtobufEditor::onFieldsChanged);
+
+  // Only the active view is kept in sync with the message
+  if (editorMode_ == EditorMode::kTree) {
+    messageModel_->setMessage(document_->message());
+  } else {
+    messageTypeWidget_->setMessage(document_->message());
+  }
+  updateSizes();
+  return true;
+}
+
+void ProtobufEditor::setDocumentOptions(const protobuf_editor::MessageDocumentOptions &options) {
+  documentOptions_ = options;
+}
 
-  // Make this message editing widget the main widget of the scroll area
-  scrollArea->setWidget(w);
-  layout->addWidget(scrollArea);
+const pb::Message* ProtobufEditor::message() const {
+  return document_->message();
+}
+
+bool ProtobufEditor::setMessage(std::unique_ptr<pb::Message> message) {
+  if (isFileOperationRunning()) {
+    return false;
+  }
+  if (message == nullptr || message->GetDescriptor() != document_->message()->GetDescriptor()) {
+    throw std::runtime_error("The message must be of the type being edited, use setMessageType to change the type");
+  }
+  setDocument(std::make_unique<protobuf_editor::MessageDocument>(std::move(message)));
+  return true;
+}
+
+bool ProtobufEditor::clearMessage() {
+  if (isFileOperationRunning()) {
+    return false;
+  }
+  // Nothing may look at the message while the arena is being reset
+  messageModel_->setMessage(nullptr);
+  document_->reset();
+  editHistory_->clear();
+  searchIndex_->setMessage(document_->message());
+  sizeProfile_->setMessage(document_->message());
+  showDocumentMessage();
+  updateSizes();
+  return true;
+}
+
+void ProtobufEditor::setDocument(std::unique_ptr<protobuf_editor::MessageDocument> document) {
+  // Keep the previous document alive until nothing refers to it anymore. After that, its arena frees the whole
+  //  message at once.
+  std::unique_ptr<protobuf_editor::MessageDocument> previousDocument = std::move(document_);
+  document_ = std::move(document);
+  // The recorded edits were made to a different message
+  editHistory_->clear();
+  searchIndex_->setMessage(document_->message());
+  sizeProfile_->setMessage(document_->message());
+  showDocumentMessage();
+  updateSizes();
+}
+
+void ProtobufEditor::showDocumentMessage() {
+  if (editorMode_ == EditorMode::kTree) {
+    messageModel_->setMessage(document_->message());
+  }
+  // Even while hidden, the widgets must not keep pointing at the previous message. Thanks to lazy expansion, this
+  //  only touches the fields which have been expanded.
+  messageTypeWidget_->setMessage(document_->message());
+}
 
-  // Allocate a message for the widget to reference on the heap. Do not allocate it, since the widget will always reference this
-  proto::test::Test *testMsg = new proto::test::Test;
-  w->setMessage(testMsg);
+bool ProtobufEditor::openFile(const QString &path) {
+  if (isFileOperationRunning()) {
+    return false;
+  }
+  // Loaded into a document of its own, so the message being shown is untouched unless the load succeeds
+  loadingDocument_ = std::make_unique<protobuf_editor::MessageDocument>(*document_->message(), documentOptions_);
+  startFileTask(protobuf_editor::MessageFileTask::load(path, protobuf_editor::messageFormatForPath(path), loadingDocument_->message(), this), true);
+  return true;
+}
+
+bool ProtobufEditor::saveFile(const QString &path) {
+  if (isFileOperationRunning()) {
+    return false;
+  }
+  startFileTask(protobuf_editor::MessageFileTask::save(path, protobuf_editor::messageFormatForPath(path), *document_->message(), this), false);
+  return true;
+}
+
+bool ProtobufEditor::isFileOperationRunning() const {
+  return fileTask_ != nullptr;
+}
+
+protobuf_editor::EditHistory* ProtobufEditor::editHistory() const {
+  return editHistory_;
+}
+
+bool ProtobufEditor::undo() {
+  if (isFileOperationRunning()) {
+    return false;
+  }
+  const std::optional<protobuf_editor::FieldPath> path = editHistory_->undo(document_->message());
+  if (!path) {
+    return false;
+  }
+  refreshAfterHistoryChange(*path);
+  return true;
+}
 
-  // When any edits are made in the widget, this signal will be emitted
-  connect(w, &protobuf_editor::ProtobufFieldWidget::messageUpdated, [testMsg]{
-    std::cout << "Message updated!" << std::endl;
-    std::cout << testMsg->DebugString() << std::endl;
+bool ProtobufEditor::redo() {
+  if (isFileOperationRunning()) {
+    return false;
+  }
+  const std::optional<protobuf_editor::FieldPath> path = editHistory_->redo(document_->message());
+  if (!path) {
+    return false;
+  }
+  refreshAfterHistoryChange(*path);
+  return true;
+}
+
+bool ProtobufEditor::revealField(const protobuf_editor::FieldPath &path) {
+  // Expanding the way to the field can set nested messages, which the worker may be reading
+  if (editorMode_ != EditorMode::kWidgets || isFileOperationRunning()) {
+    return false;
+  }
+  QPointer<protobuf_editor::ProtobufFieldWidget> fieldWidget = messageTypeWidget_->revealField(path);
+  if (fieldWidget == nullptr) {
+    return false;
+  }
+  // Widgets which were just built haven't been laid out yet, so wait for that before scrolling to it
+  QTimer::singleShot(0, this, [this, fieldWidget]{
+    if (fieldWidget != nullptr) {
+      scrollArea_->ensureWidgetVisible(fieldWidget);
+      fieldWidget->setFocus(Qt::OtherFocusReason);
+    }
   });
+  return true;
 }
+
+bool ProtobufEditor::sizesShown() const {
+  return sizesShown_;
+}
+
+void ProtobufEditor::setSizesShown(bool shown) {
+  if (shown == sizesShown_) {
+    return;
+  }
+  sizesShown_ = shown;
+  sizesAction_->setChecked(shown);
+  sizeProfilePanel_->setVisible(shown);
+  if (shown) {
+    sizeProfilePanel_->setSizeProfile(sizeProfile_.get());
+    messageTypeWidget_->showSizes(sizeProfile_.get(), protobuf_editor::FieldPath());
+  } else {
+    sizeProfilePanel_->setSizeProfile(nullptr);
+    messageTypeWidget_->showSizes(nullptr, protobuf_editor::FieldPath());
+  }
+}
+
+void ProtobufEditor::updateSizes() {
+  if (!sizesShown_) {
+    return;
+  }
+  // Only the sizes of the widgets which have been built are read
+  messageTypeWidget_->showSizes(sizeProfile_.get(), protobuf_editor::FieldPath());
+  sizeProfilePanel_->refresh();
+}
+
+void ProtobufEditor::updateSearchResults(const QString &query) {
+  QStringList paths;
+  for (const protobuf_editor::FieldSearchMatch &match : searchIndex_->search(query, kMaxSearchResults)) {
+    paths.append(QString::fromStdString(match.path.toString()));
+  }
+  searchResultsModel_->setStringList(paths);
+  if (!paths.isEmpty()) {
+    searchCompleter_->complete();
+  }
+}
+
+void ProtobufEditor::refreshAfterHistoryChange(const protobuf_editor::FieldPath &path) {
+  // Rather than setMessage, which would re-read every field which has been expanded
+  messageTypeWidget_->refreshFields({path});
+  onFieldsChanged({path});
+}
+
+void ProtobufEditor::startFileTask(protobuf_editor::MessageFileTask *task, bool loading) {
+  fileTask_ = task;
+  // While saving, the worker is reading the message, so it must not be edited. While loading, the edits would be lost.
+  //  Switching views, finding a field and picking one in the size panel all expand widgets, which can set nested
+  //  messages, so they're disabled too.
+  toolBar_->setEnabled(false);
+  stackedWidget_->setEnabled(false);
+  sizeProfilePanel_->setEnabled(false);
+  connect(task, &protobuf_editor::MessageFileTask::progressChanged, this, &ProtobufEditor::fileProgress);
+  connect(task, &protobuf_editor::MessageFileTask::finished, this, [this, task, loading](bool success){
+    if (loading) {
+      if (success) {
+        // The worker parsed straight into the new document, nothing needs to be copied
+        setDocument(std::move(loadingDocument_));
+      }
+      loadingDocument_.reset();
+    }
+    toolBar_->setEnabled(true);
+    stackedWidget_->setEnabled(true);
+    sizeProfilePanel_->setEnabled(true);
+    fileTask_ = nullptr;
+    emit fileOperationFinished(task->path(), success, task->errorString());
+    task->deleteLater();
+  });
+}
+
+void ProtobufEditor::onFieldsChanged(const std::vector<protobuf_editor::FieldPath> &paths) {
+  // Keep searching by value up to date, only re-reading what changed
+  searchIndex_->fieldsChanged(paths);
+  // Only the messages along the changed paths have their sizes recomputed
+  sizeProfile_->fieldsChanged(paths);
+  updateSizes();
+
+  // Only look at what changed, rather than printing the entire message, and only when someone is listening
+  if (!protobuf_editor::logEnabled(protobuf_editor::LogLevel::kDebug)) {
+    return;
+  }
+  protobuf_editor::logMessage(protobuf_editor::LogLevel::kDebug, QStringLiteral("Message updated!"));
+  for (const protobuf_editor::FieldPath &path : paths) {
+    std::string value;
+    const pb::Message *containingMessage = path.resolveContainingMessage(*document_->message());
+    const pb::FieldDescriptor *fieldDescriptor = path.back().fieldDescriptor;
+    if (containingMessage == nullptr) {
+      value = "(removed)";
+    } else if (fieldDescriptor->is_repeated() && path.back().index == -1) {
+      value = std::to_string(containingMessage->GetReflection()->FieldSize(*containingMessage, fieldDescriptor)) + " element(s)";
+    } else if (!fieldDescriptor->is_repeated() && fieldDescriptor->has_presence() && !containingMessage->GetReflection()->HasField(*containingMessage, fieldDescriptor)) {
+      value = "(not set)";
+    } else {
+      pb::TextFormat::PrintFieldValueToString(*containingMessage, fieldDescriptor, path.back().index, &value);
+    }
+    protobuf_editor::logMessage(protobuf_editor::LogLevel::kDebug, QString::fromStdString("  "+path.toString()+": "+value));
+  }
+}
\ No newline at end of file
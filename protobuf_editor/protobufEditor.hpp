@@ -1,13 +1,114 @@
 #ifndef PROTOBUFEDITOR_HPP_
 #define PROTOBUFEDITOR_HPP_
 
+#include "fieldPath.hpp"
+#include "messageDocument.hpp"
+
+#include <google/protobuf/message.h>
+
+#include <QAction>
+#include <QCompleter>
+#include <QLineEdit>
+#include <QScrollArea>
+#include <QStringListModel>
+#include <QStackedWidget>
+#include <QToolBar>
+#include <QTreeView>
 #include <QWidget>
 
+#include <memory>
+#include <vector>
+
+namespace protobuf_editor {
+class EditHistory;
+class FieldSearchIndex;
+class MessageFileTask;
+class MessageTypeWidget;
+class ProtobufMessageModel;
+class SizeProfile;
+class SizeProfilePanel;
+} // namespace protobuf_editor
+
 class ProtobufEditor : public QWidget {
   Q_OBJECT
 public:
+  enum class EditorMode {
+    // One widget per field, see MessageTypeWidget
+    kWidgets,
+    // A tree view over a ProtobufMessageModel, which scales to messages with a very large number of fields
+    kTree
+  };
   explicit ProtobufEditor(QWidget *parent = nullptr);
+  ~ProtobufEditor();
+  EditorMode editorMode() const;
+  void setEditorMode(EditorMode mode);
+  // How the arena of each new document allocates its memory. Applies from the next setMessageType or openFile on.
+  void setDocumentOptions(const protobuf_editor::MessageDocumentOptions &options);
+  // Replaces the message being edited with a new, empty message of the prototype's type, e.g. a type which was loaded
+  //  at runtime through a DynamicSchema. The prototype's descriptor pool must outlive the editor. Returns false while
+  //  a file operation is running.
+  bool setMessageType(const google::protobuf::Message &prototype);
+  const google::protobuf::Message* message() const;
+  // Takes ownership of a message of the type being edited and shows it. Nothing is copied. Returns false while a file
+  //  operation is running.
+  bool setMessage(std::unique_ptr<google::protobuf::Message> message);
+  // Throws the message away and starts over with an empty one. Everything in it is freed with one arena reset.
+  //  Returns false while a file operation is running.
+  bool clearMessage();
+  // Loads or saves the message on a worker thread, in the format given by the file's extension (see
+  //  messageFormatForPath). The editor is disabled until fileOperationFinished is emitted. Only one file operation can
+  //  run at a time, these return false if another one is still running.
+  bool openFile(const QString &path);
+  bool saveFile(const QString &path);
+  bool isFileOperationRunning() const;
+  // Edits made through the widgets. Cleared whenever the message is replaced or the tree view is shown, since edits
+  //  made in the tree view aren't recorded.
+  protobuf_editor::EditHistory* editHistory() const;
+  // Only re-read the field which the edit touched. Return false if there was nothing to undo or redo.
+  bool undo();
+  bool redo();
+  // Scrolls to and focuses the field's widget, expanding the nested messages along the way. Only in widget mode.
+  bool revealField(const protobuf_editor::FieldPath &path);
+  // Shows how many bytes each field takes up in the encoded message, next to the field's widget, and lists the
+  //  largest fields below the editor. Kept up to date as the message is edited.
+  bool sizesShown() const;
+  void setSizesShown(bool shown);
+private:
+  protobuf_editor::MessageDocumentOptions documentOptions_;
+  std::unique_ptr<protobuf_editor::MessageDocument> document_;
+  // The document which a file is being loaded into. It replaces document_ once the load succeeds.
+  std::unique_ptr<protobuf_editor::MessageDocument> loadingDocument_;
+  EditorMode editorMode_{EditorMode::kWidgets};
+  QToolBar *toolBar_{nullptr};
+  QStackedWidget *stackedWidget_{nullptr};
+  QScrollArea *scrollArea_{nullptr};
+  protobuf_editor::MessageTypeWidget *messageTypeWidget_{nullptr};
+  QTreeView *treeView_{nullptr};
+  protobuf_editor::ProtobufMessageModel *messageModel_{nullptr};
+  protobuf_editor::MessageFileTask *fileTask_{nullptr};
+  protobuf_editor::EditHistory *editHistory_{nullptr};
+  std::unique_ptr<protobuf_editor::FieldSearchIndex> searchIndex_;
+  QLineEdit *searchLineEdit_{nullptr};
+  QStringListModel *searchResultsModel_{nullptr};
+  QCompleter *searchCompleter_{nullptr};
+  std::unique_ptr<protobuf_editor::SizeProfile> sizeProfile_;
+  protobuf_editor::SizeProfilePanel *sizeProfilePanel_{nullptr};
+  QAction *sizesAction_{nullptr};
+  bool sizesShown_{false};
+  void onFieldsChanged(const std::vector<protobuf_editor::FieldPath> &paths);
+  void setDocument(std::unique_ptr<protobuf_editor::MessageDocument> document);
+  // Points the active view, and the widgets even while hidden, at the document's message
+  void showDocumentMessage();
+  // Re-reads the field which was undone or redone, and reports it like any other change
+  void refreshAfterHistoryChange(const protobuf_editor::FieldPath &path);
+  void updateSearchResults(const QString &query);
+  // Re-reads the sizes, if they're shown, after the message changed
+  void updateSizes();
+  void startFileTask(protobuf_editor::MessageFileTask *task, bool loading);
 signals:
+  // `bytesTotal` is 0 if it isn't known ahead of time
+  void fileProgress(qint64 bytesProcessed, qint64 bytesTotal);
+  void fileOperationFinished(const QString &path, bool success, const QString &errorString);
 };
 
 #endif // PROTOBUFEDITOR_HPP_
@@ -1,4 +1,9 @@
 #include "protobufFieldWidget.hpp"
+#include "editHistory.hpp"
+#include "instrumentation.hpp"
+#include "sizeProfile.hpp"
+
+#include <QLocale>
 
 namespace pb = google::protobuf;
 
@@ -12,23 +17,112 @@ ProtobufFieldWidget::ProtobufFieldWidget(const google::protobuf::FieldDescriptor
   } else {
     fieldIsOptional_ = fieldDescriptor_->has_optional_keyword();
   }
+  PROTOBUF_EDITOR_COUNT("widgets created", 1);
+  PROTOBUF_EDITOR_COUNT("widgets created for " + (fieldDescriptor_ != nullptr ? fieldDescriptor_->full_name() : std::string("the root message")), 1);
 }
 
 ProtobufFieldWidget::~ProtobufFieldWidget() {}
 
 void ProtobufFieldWidget::setMessage(pb::Message *currentMessage, pb::Message *parentMessage) {
+  readOnly_ = false;
+  mutableCurrentMessage_ = currentMessage;
+  mutableParentMessage_ = parentMessage;
+  displayMessage(currentMessage, parentMessage);
+}
+
+void ProtobufFieldWidget::setReadOnlyMessage(const pb::Message *currentMessage, const pb::Message *parentMessage) {
+  readOnly_ = true;
+  mutableCurrentMessage_ = nullptr;
+  mutableParentMessage_ = nullptr;
+  displayMessage(currentMessage, parentMessage);
+}
+
+void ProtobufFieldWidget::clearMessage() {
+  // Nested widgets keep their pointers, but they can't be edited while this one is disabled, and they're given
+  //  their messages again along with this one
+  setEnabled(false);
+  currentMessage_ = nullptr;
+  parentMessage_ = nullptr;
+  mutableCurrentMessage_ = nullptr;
+  mutableParentMessage_ = nullptr;
+}
+
+bool ProtobufFieldWidget::isReadOnly() const {
+  return readOnly_;
+}
+
+pb::Message* ProtobufFieldWidget::mutableCurrentMessage() const {
+  if (readOnly_) {
+    throw std::runtime_error("Tried to modify a message which is read-only");
+  }
+  return mutableCurrentMessage_;
+}
+
+pb::Message* ProtobufFieldWidget::mutableParentMessage() const {
+  if (readOnly_) {
+    throw std::runtime_error("Tried to modify a message which is read-only");
+  }
+  return mutableParentMessage_;
+}
+
+void ProtobufFieldWidget::displayMessage(const pb::Message *currentMessage, const pb::Message *parentMessage) {
   currentMessage_ = currentMessage;
   parentMessage_ = parentMessage;
 
-  setDataFromMessage();
+  {
+    // Nested widgets are given their messages from in here, so this times the whole subtree
+    PROTOBUF_EDITOR_TIME_SCOPE("setDataFromMessage " + (fieldDescriptor_ != nullptr ? fieldDescriptor_->full_name() : std::string("the root message")));
+    setDataFromMessage();
+  }
 
   setEnabled(true);
+
+  if (parentFieldWidget_ == nullptr) {
+    emit messageLoaded();
+  }
+}
+
+void ProtobufFieldWidget::setParentFieldWidget(ProtobufFieldWidget *parentFieldWidget) {
+  parentFieldWidget_ = parentFieldWidget;
+}
+
+void ProtobufFieldWidget::setRepeatedIndex(int index) {
+  repeatedIndex_ = index;
+}
+
+void ProtobufFieldWidget::setNotificationMode(ChangeNotifier::Mode mode, int debounceMilliseconds) {
+  changeNotifier()->setMode(mode, debounceMilliseconds);
+}
+
+void ProtobufFieldWidget::setEditHistory(EditHistory *editHistory) {
+  editHistory_ = editHistory;
+}
+
+void ProtobufFieldWidget::refreshFieldPath(const FieldPath &, size_t) {
+  setDataFromMessage();
 }
 
 void ProtobufFieldWidget::setDataFromMessage() {
   // Nothing to do
 }
 
+void ProtobufFieldWidget::showSizes(SizeProfile *sizeProfile, const FieldPath &path) {
+  sizeProfile_ = sizeProfile;
+  sizePath_ = path;
+  updateSizeOverlay();
+}
+
+void ProtobufFieldWidget::updateSizeOverlay() {
+  // Nothing to show
+}
+
+QString ProtobufFieldWidget::byteSizeText() const {
+  if (sizeProfile_ == nullptr) {
+    return QString();
+  }
+  return locale().formattedDataSize(static_cast<qint64>(sizeProfile_->fieldBytes(sizePath_)));
+}
+
 bool ProtobufFieldWidget::fieldIsOptional() const {
   return fieldIsOptional_;
 }
@@ -48,4 +142,49 @@ bool ProtobufFieldWidget::fieldIsSet() const {
   return parentMessage_->GetReflection()->HasField(*parentMessage_, fieldDescriptor_);
 }
 
+void ProtobufFieldWidget::beginFieldEdit(FieldPath path) {
+  qualifyFieldPath(path);
+  if (parentFieldWidget_ != nullptr) {
+    parentFieldWidget_->beginFieldEdit(std::move(path));
+    return;
+  }
+  if (editHistory_ != nullptr && currentMessage_ != nullptr) {
+    editHistory_->beginEdit(*currentMessage_, path);
+  }
+}
+
+void ProtobufFieldWidget::reportFieldChanged(FieldPath path) {
+  qualifyFieldPath(path);
+  if (parentFieldWidget_ != nullptr) {
+    // Hand the change to our parent with a direct call, rather than re-emitting a signal at every level
+    parentFieldWidget_->reportFieldChanged(std::move(path));
+    return;
+  }
+  if (editHistory_ != nullptr && currentMessage_ != nullptr) {
+    editHistory_->endEdit(*currentMessage_, path);
+  }
+  changeNotifier()->fieldChanged(path);
+}
+
+void ProtobufFieldWidget::qualifyFieldPath(FieldPath &path) {
+  if (fieldDescriptor_ != nullptr) {
+    path.prepend(fieldDescriptor_, repeatedIndex_);
+  }
+}
+
+ChangeNotifier* ProtobufFieldWidget::changeNotifier() {
+  // Only the root-level widget ever needs one of these, so it is created on first use
+  if (changeNotifier_ == nullptr) {
+    changeNotifier_ = new ChangeNotifier(this);
+    connect(changeNotifier_, &ChangeNotifier::fieldsChanged, [this](const std::vector<FieldPath> &paths){
+      PROTOBUF_EDITOR_COUNT("messageUpdated emitted", 1);
+      PROTOBUF_EDITOR_COUNT("messageUpdated receivers notified", receivers(SIGNAL(messageUpdated())));
+      PROTOBUF_EDITOR_COUNT("fieldsChanged paths", static_cast<int64_t>(paths.size()));
+      emit messageUpdated();
+      emit fieldsChanged(paths);
+    });
+  }
+  return changeNotifier_;
+}
+
 } // namespace protobuf_editor
\ No newline at end of file
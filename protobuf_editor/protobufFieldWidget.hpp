@@ -1,29 +1,92 @@
 #ifndef PROTOBUF_EDITOR_PROTOBUF_FIELD_WIDGET_HPP_
 #define PROTOBUF_EDITOR_PROTOBUF_FIELD_WIDGET_HPP_
 
+#include "changeNotifier.hpp"
+#include "fieldPath.hpp"
+
 #include <google/protobuf/message.h>
 
 #include <QWidget>
 
+#include <vector>
+
 namespace protobuf_editor {
 
+class EditHistory;
+class SizeProfile;
+
 class ProtobufFieldWidget : public QWidget {
   Q_OBJECT
 public:
   explicit ProtobufFieldWidget(const google::protobuf::FieldDescriptor *fieldDescriptor=nullptr, QWidget *parent=nullptr);
   void setMessage(google::protobuf::Message *currentMessage, google::protobuf::Message *parentMessage=nullptr);
+  // Displays a message without ever modifying it. Nested messages which are not present are shown using their
+  //  default instance rather than being created, and edits made in the UI are reverted.
+  void setReadOnlyMessage(const google::protobuf::Message *currentMessage, const google::protobuf::Message *parentMessage=nullptr);
+  bool isReadOnly() const;
+  // Forgets the message, for a widget which is hidden while the message it was showing may go away. It stays
+  //  disabled until it's given a message again.
+  void clearMessage();
+  // Changes are reported up through the parent field widget. The widget without a parent emits the signals below.
+  void setParentFieldWidget(ProtobufFieldWidget *parentFieldWidget);
+  // Set when this widget edits one element of a repeated field
+  void setRepeatedIndex(int index);
+  // Only applies to the root-level widget. By default, every change is reported as soon as it is made.
+  void setNotificationMode(ChangeNotifier::Mode mode, int debounceMilliseconds=0);
+  // Only applies to the root-level widget. Every edit made through the widgets is recorded in `editHistory`, which
+  //  must outlive the widget. Null to stop recording.
+  void setEditHistory(EditHistory *editHistory);
+  // Re-reads part of the message after it was modified from outside of this widget. `path.at(position)` names this
+  //  widget's field, anything after it names something below this field. By default, the whole field is re-read.
+  virtual void refreshFieldPath(const FieldPath &path, size_t position);
+  // Shows how many bytes this field, and every field below it which has a widget, contributes to the encoded
+  //  message. `path` names this widget's field relative to the message the profile is of. Widgets built later, when
+  //  a nested message is expanded, show their sizes too. Call again after the profile changed. Null to hide.
+  void showSizes(SizeProfile *sizeProfile, const FieldPath &path);
   virtual ~ProtobufFieldWidget() = 0;
 protected:
   const google::protobuf::FieldDescriptor* const fieldDescriptor_;
-  google::protobuf::Message *currentMessage_{nullptr};
-  google::protobuf::Message *parentMessage_{nullptr};
+  // For reading. Anything which writes to the message must go through mutableCurrentMessage/mutableParentMessage.
+  const google::protobuf::Message *currentMessage_{nullptr};
+  const google::protobuf::Message *parentMessage_{nullptr};
+  // These throw if the message is read-only
+  google::protobuf::Message* mutableCurrentMessage() const;
+  google::protobuf::Message* mutableParentMessage() const;
   virtual void setDataFromMessage();
+  // Null unless the sizes are shown, see showSizes
+  SizeProfile *sizeProfile_{nullptr};
+  FieldPath sizePath_;
+  virtual void updateSizeOverlay();
+  // The size of this field, for display. Empty if the sizes aren't shown.
+  QString byteSizeText() const;
   bool fieldIsOptional() const;
   bool fieldIsSet() const;
+  // To be called right before this widget modifies the message, with the same path which will be passed to
+  //  reportFieldChanged afterwards, so that the edit can be undone
+  void beginFieldEdit(FieldPath path=FieldPath());
+  // To be called after this widget has modified the message. `path` is relative to this widget's field.
+  void reportFieldChanged(FieldPath path=FieldPath());
+  // Turns a path which is relative to this widget's field into one relative to the message containing this field
+  virtual void qualifyFieldPath(FieldPath &path);
 private:
   bool fieldIsOptional_;
+  bool readOnly_{false};
+  google::protobuf::Message *mutableCurrentMessage_{nullptr};
+  google::protobuf::Message *mutableParentMessage_{nullptr};
+  ProtobufFieldWidget *parentFieldWidget_{nullptr};
+  int repeatedIndex_{-1};
+  ChangeNotifier *changeNotifier_{nullptr};
+  EditHistory *editHistory_{nullptr};
+  ChangeNotifier* changeNotifier();
+  void displayMessage(const google::protobuf::Message *currentMessage, const google::protobuf::Message *parentMessage);
 signals:
+  // Emitted by the root-level widget once it has finished displaying the message given to setMessage.
+  // Displaying a message never modifies it, so no messageUpdated or fieldsChanged signals are emitted while loading.
+  void messageLoaded();
+  // Emitted by the root-level widget once for every change, or once for every batch of changes
   void messageUpdated();
+  // Emitted alongside messageUpdated with the paths, relative to the root message, of the fields which changed
+  void fieldsChanged(const std::vector<protobuf_editor::FieldPath> &paths);
 };
 
 } // namespace protobuf_editor
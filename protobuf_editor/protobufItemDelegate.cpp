@@ -0,0 +1,67 @@
+#include "descriptorLayout.hpp"
+#include "fieldValue.hpp"
+#include "protobufItemDelegate.hpp"
+
+#include <QComboBox>
+#include <QLineEdit>
+
+namespace pb = google::protobuf;
+
+namespace {
+
+const pb::FieldDescriptor* fieldDescriptorOfIndex(const QModelIndex &index, int role) {
+  return index.data(role).value<const pb::FieldDescriptor*>();
+}
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+ProtobufItemDelegate::ProtobufItemDelegate(int fieldDescriptorRole, QObject *parent) : QStyledItemDelegate(parent), fieldDescriptorRole_(fieldDescriptorRole) {}
+
+QWidget* ProtobufItemDelegate::createEditor(QWidget *parent, const QStyleOptionViewItem &option, const QModelIndex &index) const {
+  const pb::FieldDescriptor *fieldDescriptor = fieldDescriptorOfIndex(index, fieldDescriptorRole_);
+  if (fieldDescriptor == nullptr || fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_BOOL) {
+    return QStyledItemDelegate::createEditor(parent, option, index);
+  }
+  if (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_ENUM) {
+    QComboBox *comboBox = new QComboBox(parent);
+    const FieldLayout &layout = fieldLayout(fieldDescriptor);
+    for (int enumValueIndex=0; enumValueIndex<static_cast<int>(layout.enumNumbers.size()); ++enumValueIndex) {
+      comboBox->addItem(layout.enumNames.at(enumValueIndex), layout.enumNumbers.at(enumValueIndex));
+    }
+    return comboBox;
+  }
+  // Numbers are edited as text, like in the BuiltInTypeWidget, so that the full range of every type can be entered
+  return new QLineEdit(parent);
+}
+
+void ProtobufItemDelegate::setEditorData(QWidget *editor, const QModelIndex &index) const {
+  const pb::FieldDescriptor *fieldDescriptor = fieldDescriptorOfIndex(index, fieldDescriptorRole_);
+  if (fieldDescriptor == nullptr || fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_BOOL) {
+    QStyledItemDelegate::setEditorData(editor, index);
+    return;
+  }
+  const QVariant value = index.data(Qt::EditRole);
+  if (auto *comboBox = qobject_cast<QComboBox*>(editor)) {
+    comboBox->setCurrentIndex(comboBox->findData(value));
+  } else if (auto *lineEdit = qobject_cast<QLineEdit*>(editor)) {
+    lineEdit->setText(value.toString());
+  }
+}
+
+void ProtobufItemDelegate::setModelData(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index) const {
+  const pb::FieldDescriptor *fieldDescriptor = fieldDescriptorOfIndex(index, fieldDescriptorRole_);
+  if (fieldDescriptor == nullptr || fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_BOOL) {
+    QStyledItemDelegate::setModelData(editor, model, index);
+    return;
+  }
+  if (auto *comboBox = qobject_cast<QComboBox*>(editor)) {
+    model->setData(index, comboBox->currentData(), Qt::EditRole);
+  } else if (auto *lineEdit = qobject_cast<QLineEdit*>(editor)) {
+    // If the text does not parse as the field's type, the model rejects it and keeps the previous value
+    model->setData(index, lineEdit->text(), Qt::EditRole);
+  }
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
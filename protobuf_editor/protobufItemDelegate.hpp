@@ -0,0 +1,24 @@
+#ifndef PROTOBUF_EDITOR_PROTOBUF_ITEM_DELEGATE_HPP_
+#define PROTOBUF_EDITOR_PROTOBUF_ITEM_DELEGATE_HPP_
+
+#include <QStyledItemDelegate>
+
+namespace protobuf_editor {
+
+// Creates editors for protobuf field values in item views. The model is expected to provide the field's descriptor
+//  through its FieldDescriptorRole. Enums are edited with a QComboBox of the enum's values, bools use Qt's default
+//  editor, and all other built-in types are edited as text.
+class ProtobufItemDelegate : public QStyledItemDelegate {
+  Q_OBJECT
+public:
+  explicit ProtobufItemDelegate(int fieldDescriptorRole, QObject *parent=nullptr);
+  QWidget* createEditor(QWidget *parent, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+  void setEditorData(QWidget *editor, const QModelIndex &index) const override;
+  void setModelData(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index) const override;
+private:
+  const int fieldDescriptorRole_;
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_PROTOBUF_ITEM_DELEGATE_HPP_
@@ -0,0 +1,363 @@
+#include "fieldValue.hpp"
+#include "protobufMessageModel.hpp"
+
+namespace pb = google::protobuf;
+
+namespace {
+
+// How many rows of a repeated field are created each time the view asks for more
+constexpr int kFetchBatchSize = 256;
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+struct ProtobufMessageModel::Node {
+  Node *parent{nullptr};
+  int row{0};
+  // The message which holds this node's field. For the root node, this is the message itself
+  pb::Message *containingMessage{nullptr};
+  // Null for the root node
+  const pb::FieldDescriptor *fieldDescriptor{nullptr};
+  // If this node is an element of a repeated field, this is its index in that field
+  int repeatedIndex{-1};
+  std::vector<std::unique_ptr<Node>> children;
+
+  bool isRepeatedField() const {
+    return fieldDescriptor != nullptr && fieldDescriptor->is_repeated() && repeatedIndex == -1;
+  }
+  bool isMessage() const {
+    return fieldDescriptor == nullptr || (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE && !isRepeatedField());
+  }
+  bool isOptional() const {
+    // Members of a oneof are only set while the oneof's case is them. Other message fields are treated as always set,
+    //  like the widgets do.
+    return fieldDescriptor != nullptr && repeatedIndex == -1 && (fieldDescriptor->has_optional_keyword() || fieldDescriptor->real_containing_oneof() != nullptr);
+  }
+  bool isSet() const {
+    if (!isOptional()) {
+      // Non-optional fields are always set
+      return true;
+    }
+    return containingMessage->GetReflection()->HasField(*containingMessage, fieldDescriptor);
+  }
+};
+
+ProtobufMessageModel::ProtobufMessageModel(QObject *parent) : QAbstractItemModel(parent) {
+  changeNotifier_ = new ChangeNotifier(this);
+  connect(changeNotifier_, &ChangeNotifier::fieldsChanged, [this](const std::vector<FieldPath> &paths){
+    emit messageUpdated();
+    emit fieldsChanged(paths);
+  });
+}
+
+ProtobufMessageModel::~ProtobufMessageModel() {}
+
+void ProtobufMessageModel::setMessage(pb::Message *message) {
+  beginResetModel();
+  message_ = message;
+  rootNode_.reset();
+  if (message_ != nullptr) {
+    rootNode_ = std::make_unique<Node>();
+    rootNode_->containingMessage = message_;
+    // The top-level fields are always shown, create them now rather than waiting for the view to fetch them
+    const int fieldCount = message_->GetDescriptor()->field_count();
+    for (int fieldIndex=0; fieldIndex<fieldCount; ++fieldIndex) {
+      auto child = std::make_unique<Node>();
+      child->parent = rootNode_.get();
+      child->row = fieldIndex;
+      child->containingMessage = message_;
+      child->fieldDescriptor = message_->GetDescriptor()->field(fieldIndex);
+      rootNode_->children.push_back(std::move(child));
+    }
+  }
+  endResetModel();
+}
+
+void ProtobufMessageModel::setNotificationMode(ChangeNotifier::Mode mode, int debounceMilliseconds) {
+  changeNotifier_->setMode(mode, debounceMilliseconds);
+}
+
+ProtobufMessageModel::Node* ProtobufMessageModel::nodeFromIndex(const QModelIndex &index) const {
+  if (!index.isValid()) {
+    return rootNode_.get();
+  }
+  return static_cast<Node*>(index.internalPointer());
+}
+
+pb::Message* ProtobufMessageModel::messageOfNode(const Node *node) const {
+  if (node->fieldDescriptor == nullptr) {
+    return node->containingMessage;
+  }
+  if (!node->isMessage() || !node->isSet()) {
+    return nullptr;
+  }
+  const pb::Reflection *reflection = node->containingMessage->GetReflection();
+  if (node->repeatedIndex != -1) {
+    return reflection->MutableRepeatedMessage(node->containingMessage, node->fieldDescriptor, node->repeatedIndex);
+  }
+  return reflection->MutableMessage(node->containingMessage, node->fieldDescriptor);
+}
+
+int ProtobufMessageModel::totalChildCount(const Node *node) const {
+  if (node->isRepeatedField()) {
+    return node->containingMessage->GetReflection()->FieldSize(*node->containingMessage, node->fieldDescriptor);
+  }
+  if (!node->isMessage() || !node->isSet()) {
+    return 0;
+  }
+  if (node->fieldDescriptor == nullptr) {
+    return node->containingMessage->GetDescriptor()->field_count();
+  }
+  // Use the descriptor rather than the message so that we don't need to materialize the nested message just to answer this
+  return node->fieldDescriptor->message_type()->field_count();
+}
+
+void ProtobufMessageModel::removeAllChildren(Node *node, const QModelIndex &index) {
+  if (node->children.empty()) {
+    return;
+  }
+  beginRemoveRows(index.siblingAtColumn(kFieldColumn), 0, static_cast<int>(node->children.size())-1);
+  node->children.clear();
+  endRemoveRows();
+}
+
+FieldPath ProtobufMessageModel::pathOfNode(const Node *node) const {
+  FieldPath path;
+  for (const Node *currentNode=node; currentNode->fieldDescriptor!=nullptr; currentNode=currentNode->parent) {
+    if (currentNode != node && currentNode->isRepeatedField()) {
+      // Already covered by the element below it, which has the same field and its index
+      continue;
+    }
+    path.prepend(currentNode->fieldDescriptor, currentNode->repeatedIndex);
+  }
+  return path;
+}
+
+QModelIndex ProtobufMessageModel::index(int row, int column, const QModelIndex &parent) const {
+  const Node *parentNode = nodeFromIndex(parent);
+  if (parentNode == nullptr || row < 0 || row >= static_cast<int>(parentNode->children.size()) || column < 0 || column >= kColumnCount) {
+    return {};
+  }
+  return createIndex(row, column, parentNode->children.at(row).get());
+}
+
+QModelIndex ProtobufMessageModel::parent(const QModelIndex &index) const {
+  if (!index.isValid()) {
+    return {};
+  }
+  const Node *parentNode = nodeFromIndex(index)->parent;
+  if (parentNode == nullptr || parentNode == rootNode_.get()) {
+    return {};
+  }
+  return createIndex(parentNode->row, kFieldColumn, const_cast<Node*>(parentNode));
+}
+
+int ProtobufMessageModel::rowCount(const QModelIndex &parent) const {
+  if (parent.column() > 0) {
+    return 0;
+  }
+  const Node *node = nodeFromIndex(parent);
+  if (node == nullptr) {
+    return 0;
+  }
+  return static_cast<int>(node->children.size());
+}
+
+int ProtobufMessageModel::columnCount(const QModelIndex &parent) const {
+  return kColumnCount;
+}
+
+bool ProtobufMessageModel::hasChildren(const QModelIndex &parent) const {
+  if (parent.column() > 0) {
+    return false;
+  }
+  const Node *node = nodeFromIndex(parent);
+  if (node == nullptr) {
+    return false;
+  }
+  return totalChildCount(node) > 0;
+}
+
+bool ProtobufMessageModel::canFetchMore(const QModelIndex &parent) const {
+  if (parent.column() > 0) {
+    return false;
+  }
+  const Node *node = nodeFromIndex(parent);
+  if (node == nullptr) {
+    return false;
+  }
+  return static_cast<int>(node->children.size()) < totalChildCount(node);
+}
+
+void ProtobufMessageModel::fetchMore(const QModelIndex &parent) {
+  Node *node = nodeFromIndex(parent);
+  if (node == nullptr) {
+    return;
+  }
+  const int firstRow = static_cast<int>(node->children.size());
+  const int count = std::min(totalChildCount(node) - firstRow, kFetchBatchSize);
+  if (count <= 0) {
+    return;
+  }
+
+  // Children of a repeated field are its elements, children of a message are its fields
+  pb::Message *message = (node->isRepeatedField() ? nullptr : messageOfNode(node));
+  beginInsertRows(parent, firstRow, firstRow+count-1);
+  for (int row=firstRow; row<firstRow+count; ++row) {
+    auto child = std::make_unique<Node>();
+    child->parent = node;
+    child->row = row;
+    if (node->isRepeatedField()) {
+      child->containingMessage = node->containingMessage;
+      child->fieldDescriptor = node->fieldDescriptor;
+      child->repeatedIndex = row;
+    } else {
+      child->containingMessage = message;
+      child->fieldDescriptor = message->GetDescriptor()->field(row);
+    }
+    node->children.push_back(std::move(child));
+  }
+  endInsertRows();
+}
+
+QVariant ProtobufMessageModel::data(const QModelIndex &index, int role) const {
+  if (!index.isValid()) {
+    return {};
+  }
+  const Node *node = nodeFromIndex(index);
+  const pb::FieldDescriptor *fieldDescriptor = node->fieldDescriptor;
+
+  if (role == FieldDescriptorRole) {
+    return QVariant::fromValue(fieldDescriptor);
+  }
+
+  switch (index.column()) {
+    case kFieldColumn: {
+      if (role == Qt::DisplayRole) {
+        if (node->repeatedIndex != -1) {
+          return QStringLiteral("[%1]").arg(node->repeatedIndex);
+        }
+        return QString::fromStdString(fieldDescriptor->name());
+      }
+      if (role == Qt::CheckStateRole && node->isOptional()) {
+        return node->isSet() ? Qt::Checked : Qt::Unchecked;
+      }
+      break;
+    }
+    case kValueColumn: {
+      if (role != Qt::DisplayRole && role != Qt::EditRole) {
+        break;
+      }
+      if (node->isRepeatedField()) {
+        return (role == Qt::DisplayRole ? tr("%n item(s)", "", totalChildCount(node)) : QVariant());
+      }
+      if (node->isMessage()) {
+        return (role == Qt::DisplayRole && !node->isSet() ? tr("(not set)") : QVariant());
+      }
+      const QVariant value = readFieldValue(*node->containingMessage, fieldDescriptor, node->repeatedIndex);
+      if (role == Qt::EditRole) {
+        return value;
+      }
+      return fieldValueToString(fieldDescriptor, value);
+    }
+    case kTypeColumn: {
+      if (role == Qt::DisplayRole && node->repeatedIndex == -1) {
+        return fieldTypeName(fieldDescriptor);
+      }
+      break;
+    }
+  }
+  return {};
+}
+
+bool ProtobufMessageModel::setData(const QModelIndex &index, const QVariant &value, int role) {
+  if (!index.isValid()) {
+    return false;
+  }
+  Node *node = nodeFromIndex(index);
+  const pb::Reflection *reflection = node->containingMessage->GetReflection();
+
+  const bool checking = (index.column() == kFieldColumn && role == Qt::CheckStateRole && node->isOptional());
+  const bool editing = (index.column() == kValueColumn && role == Qt::EditRole);
+  const bool checked = (checking && static_cast<Qt::CheckState>(value.toInt()) == Qt::Checked);
+
+  // Setting a member of a oneof clears whichever other member was set, nothing may keep referring into that one
+  const pb::FieldDescriptor *replacedMember = nullptr;
+  Node *replacedNode = nullptr;
+  const pb::OneofDescriptor *oneof = node->fieldDescriptor->real_containing_oneof();
+  if ((checked || editing) && oneof != nullptr && node->repeatedIndex == -1) {
+    replacedMember = reflection->GetOneofFieldDescriptor(*node->containingMessage, oneof);
+    if (replacedMember == node->fieldDescriptor) {
+      replacedMember = nullptr;
+    }
+    // The children of a message are its fields, in order, as far as they've been fetched
+    if (replacedMember != nullptr && replacedMember->index() < static_cast<int>(node->parent->children.size())) {
+      replacedNode = node->parent->children.at(replacedMember->index()).get();
+      removeAllChildren(replacedNode, createIndex(replacedNode->row, kFieldColumn, replacedNode));
+    }
+  }
+
+  if (checking) {
+    if (!checked) {
+      // Nodes below this one reference the nested message which is about to be destroyed
+      removeAllChildren(node, index);
+      reflection->ClearField(node->containingMessage, node->fieldDescriptor);
+    } else if (node->isMessage()) {
+      reflection->MutableMessage(node->containingMessage, node->fieldDescriptor);
+    } else {
+      writeDefaultFieldValue(node->containingMessage, node->fieldDescriptor);
+    }
+  } else if (editing) {
+    if (!writeFieldValue(node->containingMessage, node->fieldDescriptor, value, node->repeatedIndex)) {
+      return false;
+    }
+  } else {
+    return false;
+  }
+
+  emit dataChanged(index.siblingAtColumn(kFieldColumn), index.siblingAtColumn(kColumnCount-1));
+  changeNotifier_->fieldChanged(pathOfNode(node));
+  if (replacedMember != nullptr) {
+    if (replacedNode != nullptr) {
+      const QModelIndex replacedIndex = createIndex(replacedNode->row, kFieldColumn, replacedNode);
+      emit dataChanged(replacedIndex, replacedIndex.siblingAtColumn(kColumnCount-1));
+    }
+    FieldPath replacedPath = pathOfNode(node->parent);
+    replacedPath.append(replacedMember);
+    changeNotifier_->fieldChanged(replacedPath);
+  }
+  return true;
+}
+
+Qt::ItemFlags ProtobufMessageModel::flags(const QModelIndex &index) const {
+  if (!index.isValid()) {
+    return Qt::NoItemFlags;
+  }
+  Qt::ItemFlags result = Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+  const Node *node = nodeFromIndex(index);
+  if (index.column() == kFieldColumn && node->isOptional()) {
+    result |= Qt::ItemIsUserCheckable;
+  }
+  if (index.column() == kValueColumn && !node->isMessage() && !node->isRepeatedField()) {
+    result |= Qt::ItemIsEditable;
+  }
+  return result;
+}
+
+QVariant ProtobufMessageModel::headerData(int section, Qt::Orientation orientation, int role) const {
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+    return {};
+  }
+  switch (section) {
+    case kFieldColumn:
+      return tr("Field");
+    case kValueColumn:
+      return tr("Value");
+    case kTypeColumn:
+      return tr("Type");
+  }
+  return {};
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
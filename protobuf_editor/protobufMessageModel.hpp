@@ -0,0 +1,68 @@
+#ifndef PROTOBUF_EDITOR_PROTOBUF_MESSAGE_MODEL_HPP_
+#define PROTOBUF_EDITOR_PROTOBUF_MESSAGE_MODEL_HPP_
+
+#include "changeNotifier.hpp"
+#include "fieldPath.hpp"
+
+#include <google/protobuf/message.h>
+
+#include <QAbstractItemModel>
+
+#include <memory>
+#include <vector>
+
+namespace protobuf_editor {
+
+// Exposes a protobuf message as a tree model, reading and writing the message through its Reflection.
+// Rows are only created for the parts of the tree which a view has asked for, and repeated fields are fetched in
+//  batches, so a QTreeView over this model only pays for what is visible, regardless of the size of the message.
+class ProtobufMessageModel : public QAbstractItemModel {
+  Q_OBJECT
+public:
+  enum Column {
+    kFieldColumn = 0,
+    kValueColumn,
+    kTypeColumn,
+    kColumnCount
+  };
+  enum Role {
+    // The const google::protobuf::FieldDescriptor* of the field at an index
+    FieldDescriptorRole = Qt::UserRole + 1
+  };
+
+  explicit ProtobufMessageModel(QObject *parent=nullptr);
+  ~ProtobufMessageModel();
+  void setMessage(google::protobuf::Message *message);
+  // By default, every change is reported as soon as it is made
+  void setNotificationMode(ChangeNotifier::Mode mode, int debounceMilliseconds=0);
+
+  QModelIndex index(int row, int column, const QModelIndex &parent=QModelIndex()) const override;
+  QModelIndex parent(const QModelIndex &index) const override;
+  int rowCount(const QModelIndex &parent=QModelIndex()) const override;
+  int columnCount(const QModelIndex &parent=QModelIndex()) const override;
+  bool hasChildren(const QModelIndex &parent=QModelIndex()) const override;
+  bool canFetchMore(const QModelIndex &parent) const override;
+  void fetchMore(const QModelIndex &parent) override;
+  QVariant data(const QModelIndex &index, int role=Qt::DisplayRole) const override;
+  bool setData(const QModelIndex &index, const QVariant &value, int role=Qt::EditRole) override;
+  Qt::ItemFlags flags(const QModelIndex &index) const override;
+  QVariant headerData(int section, Qt::Orientation orientation, int role=Qt::DisplayRole) const override;
+private:
+  struct Node;
+  google::protobuf::Message *message_{nullptr};
+  std::unique_ptr<Node> rootNode_;
+  ChangeNotifier *changeNotifier_{nullptr};
+  Node* nodeFromIndex(const QModelIndex &index) const;
+  google::protobuf::Message* messageOfNode(const Node *node) const;
+  int totalChildCount(const Node *node) const;
+  void removeAllChildren(Node *node, const QModelIndex &index);
+  FieldPath pathOfNode(const Node *node) const;
+signals:
+  // Same as ProtobufFieldWidget::messageUpdated and ProtobufFieldWidget::fieldsChanged
+  void messageUpdated();
+  void fieldsChanged(const std::vector<protobuf_editor::FieldPath> &paths);
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_PROTOBUF_MESSAGE_MODEL_HPP_
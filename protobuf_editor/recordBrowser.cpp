@@ -0,0 +1,113 @@
+#include "recordBrowser.hpp"
+#include "messageTypeWidget.hpp"
+
+#include <QHBoxLayout>
+#include <QScrollArea>
+#include <QSignalBlocker>
+#include <QVBoxLayout>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace pb = google::protobuf;
+
+namespace protobuf_editor {
+
+RecordBrowser::RecordBrowser(std::unique_ptr<RecordLog> log, QWidget *parent) : QWidget(parent), log_(std::move(log)) {
+  if (log_ == nullptr) {
+    throw std::runtime_error("Record browser was constructed without a log");
+  }
+  buildWidget();
+  if (log_->recordCount() > 0) {
+    showRecord(0);
+  }
+}
+
+const RecordLog& RecordBrowser::log() const {
+  return *log_;
+}
+
+uint64_t RecordBrowser::currentIndex() const {
+  return currentIndex_;
+}
+
+RecordBrowser::~RecordBrowser() {
+  delete messageTypeWidget_;
+}
+
+void RecordBrowser::buildWidget() {
+  // Spin boxes and sliders only go up to INT_MAX. Records past that can only be reached through showRecord.
+  const int maximumIndex = static_cast<int>(std::min<uint64_t>(std::max<uint64_t>(log_->recordCount(), 1) - 1, std::numeric_limits<int>::max()));
+
+  indexSpinBox_ = new QSpinBox;
+  indexSpinBox_->setRange(0, maximumIndex);
+  indexSpinBox_->setEnabled(log_->recordCount() > 0);
+  // Typing a record number shouldn't decode every number on the way there
+  indexSpinBox_->setKeyboardTracking(false);
+
+  indexSlider_ = new QSlider(Qt::Horizontal);
+  indexSlider_->setRange(0, maximumIndex);
+  indexSlider_->setEnabled(log_->recordCount() > 0);
+
+  statusLabel_ = new QLabel;
+
+  connect(indexSpinBox_, QOverload<int>::of(&QSpinBox::valueChanged), [this](int value){
+    showRecord(static_cast<uint64_t>(value));
+  });
+  connect(indexSlider_, &QSlider::valueChanged, [this](int value){
+    showRecord(static_cast<uint64_t>(value));
+  });
+
+  QHBoxLayout *navigationLayout = new QHBoxLayout;
+  navigationLayout->addWidget(new QLabel(tr("Record")));
+  navigationLayout->addWidget(indexSpinBox_);
+  navigationLayout->addWidget(new QLabel(tr("of %1").arg(log_->recordCount())));
+  navigationLayout->addWidget(indexSlider_, 1);
+
+  // Records are only viewed, never modified, the file is mapped read-only
+  messageTypeWidget_ = new MessageTypeWidget(log_->descriptor());
+  QScrollArea *scrollArea = new QScrollArea;
+  scrollArea->setWidgetResizable(true);
+  scrollArea->setWidget(messageTypeWidget_);
+
+  QVBoxLayout *layout = new QVBoxLayout(this);
+  layout->addLayout(navigationLayout);
+  layout->addWidget(scrollArea, 1);
+  layout->addWidget(statusLabel_);
+}
+
+void RecordBrowser::showRecord(uint64_t index) {
+  if (index >= log_->recordCount()) {
+    return;
+  }
+  if (record_ != nullptr && index == currentIndex_) {
+    return;
+  }
+
+  // Keep the navigation widgets in step with whichever one was used, without them calling back into here
+  {
+    const QSignalBlocker spinBoxBlocker(indexSpinBox_);
+    const QSignalBlocker sliderBlocker(indexSlider_);
+    if (index <= static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+      indexSpinBox_->setValue(static_cast<int>(index));
+      indexSlider_->setValue(static_cast<int>(index));
+    }
+  }
+
+  std::shared_ptr<const pb::Message> record;
+  try {
+    record = log_->record(index);
+  } catch (const std::exception &ex) {
+    statusLabel_->setText(QString::fromStdString(ex.what()));
+    return;
+  }
+  currentIndex_ = index;
+  // The previous record must stay alive until the widget has moved on to the new one
+  messageTypeWidget_->setReadOnlyMessage(record.get());
+  record_ = std::move(record);
+  statusLabel_->setText(tr("%1 bytes").arg(log_->rawRecord(index).second));
+  emit recordShown(index);
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef PROTOBUF_EDITOR_RECORD_BROWSER_HPP_
+#define PROTOBUF_EDITOR_RECORD_BROWSER_HPP_
+
+#include "recordLog.hpp"
+
+#include <google/protobuf/message.h>
+
+#include <QLabel>
+#include <QSlider>
+#include <QSpinBox>
+#include <QWidget>
+
+#include <memory>
+
+namespace protobuf_editor {
+
+class MessageTypeWidget;
+
+// Steps through the records of a RecordLog, showing one at a time in a read-only MessageTypeWidget. Only the record
+//  being shown is decoded, so this works the same for a log of ten records as for one of ten million.
+class RecordBrowser : public QWidget {
+  Q_OBJECT
+public:
+  explicit RecordBrowser(std::unique_ptr<RecordLog> log, QWidget *parent=nullptr);
+  // Deletes the message widget before the record it points into
+  ~RecordBrowser();
+  const RecordLog& log() const;
+  uint64_t currentIndex() const;
+  // Does nothing if `index` is out of range
+  void showRecord(uint64_t index);
+private:
+  std::unique_ptr<RecordLog> log_;
+  // Held for as long as it's displayed, the log's cache may let go of it sooner. Child widgets are only deleted by
+  //  ~QWidget, after the members, so the destructor deletes the message widget first.
+  std::shared_ptr<const google::protobuf::Message> record_;
+  uint64_t currentIndex_{0};
+  QSpinBox *indexSpinBox_{nullptr};
+  QSlider *indexSlider_{nullptr};
+  QLabel *statusLabel_{nullptr};
+  MessageTypeWidget *messageTypeWidget_{nullptr};
+  void buildWidget();
+signals:
+  void recordShown(quint64 index);
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_RECORD_BROWSER_HPP_
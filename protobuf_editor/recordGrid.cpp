@@ -0,0 +1,80 @@
+#include "recordGrid.hpp"
+#include "recordGridModel.hpp"
+
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QVBoxLayout>
+
+#include <stdexcept>
+
+namespace {
+
+constexpr int kFilterDelayMilliseconds = 300;
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+RecordGrid::RecordGrid(std::unique_ptr<RecordLog> log, QWidget *parent) : QWidget(parent) {
+  if (log == nullptr) {
+    throw std::runtime_error("Record grid was constructed without a log");
+  }
+  model_ = new RecordGridModel(std::move(log), this);
+  buildWidget();
+}
+
+void RecordGrid::buildWidget() {
+  filterColumnComboBox_ = new QComboBox;
+  for (int column=0; column<model_->columnCount(); ++column) {
+    filterColumnComboBox_->addItem(model_->headerData(column, Qt::Horizontal).toString());
+  }
+  filterLineEdit_ = new QLineEdit;
+  filterLineEdit_->setPlaceholderText(tr("Filter..."));
+  filterLineEdit_->setClearButtonEnabled(true);
+  filterTimer_.setSingleShot(true);
+  filterTimer_.setInterval(kFilterDelayMilliseconds);
+  connect(&filterTimer_, &QTimer::timeout, this, &RecordGrid::applyFilter);
+  connect(filterLineEdit_, &QLineEdit::textChanged, &filterTimer_, QOverload<>::of(&QTimer::start));
+  connect(filterColumnComboBox_, QOverload<int>::of(&QComboBox::activated), this, &RecordGrid::applyFilter);
+
+  QHBoxLayout *filterLayout = new QHBoxLayout;
+  filterLayout->addWidget(new QLabel(tr("Filter by")));
+  filterLayout->addWidget(filterColumnComboBox_);
+  filterLayout->addWidget(filterLineEdit_, 1);
+
+  tableView_ = new QTableView;
+  tableView_->setModel(model_);
+  tableView_->setSelectionBehavior(QAbstractItemView::SelectRows);
+  tableView_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  // Fixed sizes, sizing rows or columns to their contents would decode every record
+  tableView_->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+  tableView_->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+  // Nothing is sorted until a header is clicked
+  tableView_->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+  tableView_->setSortingEnabled(true);
+
+  statusLabel_ = new QLabel;
+  connect(model_, &RecordGridModel::busyChanged, this, &RecordGrid::updateStatus);
+  connect(model_, &RecordGridModel::modelReset, this, &RecordGrid::updateStatus);
+
+  QVBoxLayout *layout = new QVBoxLayout(this);
+  layout->addLayout(filterLayout);
+  layout->addWidget(tableView_, 1);
+  layout->addWidget(statusLabel_);
+  updateStatus();
+}
+
+void RecordGrid::applyFilter() {
+  filterTimer_.stop();
+  model_->setFilter(filterColumnComboBox_->currentIndex(), filterLineEdit_->text());
+}
+
+void RecordGrid::updateStatus() {
+  QString status = tr("%1 of %2 records").arg(model_->rowCount()).arg(model_->log().recordCount());
+  if (model_->isBusy()) {
+    status += tr(", sorting and filtering...");
+  }
+  statusLabel_->setText(status);
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
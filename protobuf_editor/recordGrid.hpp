@@ -0,0 +1,42 @@
+#ifndef PROTOBUF_EDITOR_RECORD_GRID_HPP_
+#define PROTOBUF_EDITOR_RECORD_GRID_HPP_
+
+#include "recordLog.hpp"
+
+#include <QComboBox>
+#include <QLabel>
+#include <QLineEdit>
+#include <QTableView>
+#include <QTimer>
+#include <QWidget>
+
+#include <memory>
+
+namespace protobuf_editor {
+
+class RecordGridModel;
+
+// Shows the same fields across every record of a RecordLog as a spreadsheet, see RecordGridModel. Clicking a column
+//  header sorts by it, and the records can be filtered by the text of one column. Both happen in the background,
+//  the grid stays usable meanwhile.
+class RecordGrid : public QWidget {
+  Q_OBJECT
+public:
+  explicit RecordGrid(std::unique_ptr<RecordLog> log, QWidget *parent=nullptr);
+private:
+  RecordGridModel *model_{nullptr};
+  QTableView *tableView_{nullptr};
+  QComboBox *filterColumnComboBox_{nullptr};
+  QLineEdit *filterLineEdit_{nullptr};
+  // Waits for typing to pause before filtering, every filter looks at every record
+  QTimer filterTimer_;
+  QLabel *statusLabel_{nullptr};
+  void buildWidget();
+  void applyFilter();
+  void updateStatus();
+signals:
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_RECORD_GRID_HPP_
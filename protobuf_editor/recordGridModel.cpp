@@ -0,0 +1,401 @@
+#include "descriptorLayout.hpp"
+#include "fieldValue.hpp"
+#include "instrumentation.hpp"
+#include "recordGridModel.hpp"
+
+#include <QStringList>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+namespace pb = google::protobuf;
+
+namespace {
+
+// Recursive message types would otherwise have infinitely many columns
+constexpr int kMaxDepth = 6;
+constexpr size_t kMaxColumns = 2000;
+constexpr size_t kMaxCachedCellsPerColumn = 4096;
+// Repeated fields only show their first few elements
+constexpr int kMaxListedElements = 8;
+// Records are sorted and filtered in chunks of this many, one chunk per task
+constexpr uint64_t kChunkSize = 4096;
+
+// How a column's values compare when sorting
+enum class SortKind {
+  kSigned,
+  kUnsigned,
+  kFloatingPoint,
+  kText
+};
+
+struct SortKey {
+  uint64_t record{0};
+  // Records without a value come before all others
+  bool present{false};
+  qint64 signedValue{0};
+  quint64 unsignedValue{0};
+  double floatingPointValue{0};
+  QString text;
+};
+
+struct Chunk {
+  uint64_t begin{0};
+  uint64_t end{0};
+  // The records which passed the filter, in order
+  std::vector<SortKey> keys;
+};
+
+SortKind sortKind(const pb::FieldDescriptor *fieldDescriptor) {
+  if (fieldDescriptor->is_repeated()) {
+    // Repeated fields and maps sort by their number of elements
+    return SortKind::kUnsigned;
+  }
+  switch (fieldDescriptor->cpp_type()) {
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT32:
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT64:
+    case pb::FieldDescriptor::CppType::CPPTYPE_BOOL:
+    case pb::FieldDescriptor::CppType::CPPTYPE_ENUM:
+      return SortKind::kSigned;
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT32:
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT64:
+      return SortKind::kUnsigned;
+    case pb::FieldDescriptor::CppType::CPPTYPE_FLOAT:
+    case pb::FieldDescriptor::CppType::CPPTYPE_DOUBLE:
+      return SortKind::kFloatingPoint;
+    default:
+      return SortKind::kText;
+  }
+}
+
+void readSortKey(const pb::Message &record, const protobuf_editor::FieldPath &path, SortKind kind, SortKey *key) {
+  const pb::Message *containingMessage = path.resolveContainingMessage(record);
+  if (containingMessage == nullptr) {
+    return;
+  }
+  const pb::FieldDescriptor *fieldDescriptor = path.back().fieldDescriptor;
+  const pb::Reflection *reflection = containingMessage->GetReflection();
+  if (fieldDescriptor->is_repeated()) {
+    key->present = true;
+    key->unsignedValue = static_cast<quint64>(reflection->FieldSize(*containingMessage, fieldDescriptor));
+    return;
+  }
+  if (fieldDescriptor->has_presence() && !reflection->HasField(*containingMessage, fieldDescriptor)) {
+    return;
+  }
+  key->present = true;
+  const QVariant value = protobuf_editor::readFieldValue(*containingMessage, fieldDescriptor);
+  switch (kind) {
+    case SortKind::kSigned:
+      key->signedValue = value.toLongLong();
+      break;
+    case SortKind::kUnsigned:
+      key->unsignedValue = value.toULongLong();
+      break;
+    case SortKind::kFloatingPoint:
+      key->floatingPointValue = value.toDouble();
+      break;
+    case SortKind::kText:
+      key->text = value.toString();
+      break;
+  }
+}
+
+bool keyLessThan(const SortKey &lhs, const SortKey &rhs, SortKind kind) {
+  if (lhs.present != rhs.present) {
+    return !lhs.present;
+  }
+  switch (kind) {
+    case SortKind::kSigned:
+      return lhs.signedValue < rhs.signedValue;
+    case SortKind::kUnsigned:
+      return lhs.unsignedValue < rhs.unsignedValue;
+    case SortKind::kFloatingPoint: {
+      // NaN compares false with everything, which isn't an ordering the sort can use. It goes after every number.
+      const bool lhsIsNan = std::isnan(lhs.floatingPointValue);
+      const bool rhsIsNan = std::isnan(rhs.floatingPointValue);
+      if (lhsIsNan || rhsIsNan) {
+        return !lhsIsNan;
+      }
+      return lhs.floatingPointValue < rhs.floatingPointValue;
+    }
+    case SortKind::kText:
+      return lhs.text < rhs.text;
+  }
+  return false;
+}
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+RecordGridModel::RecordGridModel(std::unique_ptr<RecordLog> log, QObject *parent) : QAbstractTableModel(parent), log_(std::move(log)) {
+  if (log_ == nullptr) {
+    throw std::runtime_error("Record grid model was constructed without a log");
+  }
+  addColumns(log_->descriptor(), FieldPath(), 0);
+  arrangementPool_.setMaxThreadCount(1);
+  connect(&arrangementWatcher_, &QFutureWatcher<std::vector<uint64_t>>::finished, this, &RecordGridModel::finishArrangement);
+}
+
+RecordGridModel::~RecordGridModel() {
+  // The arrangement reads the log, which is about to go away
+  if (arrangementCancelled_ != nullptr) {
+    *arrangementCancelled_ = true;
+  }
+  arrangementPool_.waitForDone();
+}
+
+const RecordLog& RecordGridModel::log() const {
+  return *log_;
+}
+
+void RecordGridModel::addColumns(const pb::Descriptor *descriptor, const FieldPath &prefix, int depth) {
+  // The same walk MessageTypeWidget does, using the same shared layouts
+  for (const FieldLayout &fieldLayout : messageLayout(descriptor).fields) {
+    if (columns_.size() >= kMaxColumns) {
+      return;
+    }
+    if (fieldLayout.kind == FieldLayout::Kind::kSkipped) {
+      continue;
+    }
+    const pb::FieldDescriptor *fieldDescriptor = fieldLayout.fieldDescriptor;
+    FieldPath path = prefix;
+    path.append(fieldDescriptor);
+    if (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE && !fieldDescriptor->is_repeated()) {
+      // A single nested message, or a oneof member which is one, is flattened into its fields
+      if (depth+1 < kMaxDepth) {
+        addColumns(fieldDescriptor->message_type(), path, depth+1);
+      }
+      continue;
+    }
+    Column column;
+    column.header = QString::fromStdString(path.toString());
+    column.path = std::move(path);
+    columns_.push_back(std::move(column));
+  }
+}
+
+int RecordGridModel::rowCount(const QModelIndex &parent) const {
+  if (parent.isValid()) {
+    return 0;
+  }
+  if (arranged_) {
+    return static_cast<int>(rows_.size());
+  }
+  // Views can only show INT_MAX rows
+  return static_cast<int>(std::min<uint64_t>(log_->recordCount(), std::numeric_limits<int>::max()));
+}
+
+int RecordGridModel::columnCount(const QModelIndex &parent) const {
+  if (parent.isValid()) {
+    return 0;
+  }
+  return static_cast<int>(columns_.size());
+}
+
+uint64_t RecordGridModel::recordIndex(int row) const {
+  return (arranged_ ? rows_.at(row) : static_cast<uint64_t>(row));
+}
+
+const FieldPath& RecordGridModel::columnPath(int column) const {
+  return columns_.at(column).path;
+}
+
+bool RecordGridModel::isBusy() const {
+  return busy_;
+}
+
+QString RecordGridModel::cellText(const pb::Message &record, const FieldPath &path) {
+  const pb::Message *containingMessage = path.resolveContainingMessage(record);
+  if (containingMessage == nullptr) {
+    return QString();
+  }
+  const pb::FieldDescriptor *fieldDescriptor = path.back().fieldDescriptor;
+  const pb::Reflection *reflection = containingMessage->GetReflection();
+  if (fieldDescriptor->is_repeated()) {
+    const int size = reflection->FieldSize(*containingMessage, fieldDescriptor);
+    if (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE) {
+      return tr("%n element(s)", "", size);
+    }
+    QStringList elements;
+    for (int elementIndex=0; elementIndex<std::min(size, kMaxListedElements); ++elementIndex) {
+      elements.append(fieldValueToString(fieldDescriptor, readFieldValue(*containingMessage, fieldDescriptor, elementIndex)));
+    }
+    if (size > kMaxListedElements) {
+      elements.append(QStringLiteral("..."));
+    }
+    return QStringLiteral("[%1]").arg(elements.join(QStringLiteral(", ")));
+  }
+  if (fieldDescriptor->has_presence() && !reflection->HasField(*containingMessage, fieldDescriptor)) {
+    return QString();
+  }
+  return fieldValueToString(fieldDescriptor, readFieldValue(*containingMessage, fieldDescriptor));
+}
+
+QVariant RecordGridModel::data(const QModelIndex &index, int role) const {
+  if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::ToolTipRole)) {
+    return {};
+  }
+  const Column &column = columns_.at(index.column());
+  const uint64_t record = recordIndex(index.row());
+  auto cached = column.cells.find(record);
+  if (cached != column.cells.end()) {
+    return cached->second;
+  }
+  // The log keeps the most recent records decoded, so the other columns of this row don't decode it again
+  QString text;
+  try {
+    text = cellText(*log_->record(record), column.path);
+  } catch (const std::exception &) {
+    text = tr("[invalid record]");
+  }
+  if (column.cells.size() >= kMaxCachedCellsPerColumn) {
+    column.cells.clear();
+  }
+  column.cells.emplace(record, text);
+  return text;
+}
+
+QVariant RecordGridModel::headerData(int section, Qt::Orientation orientation, int role) const {
+  if (role != Qt::DisplayRole) {
+    return QAbstractTableModel::headerData(section, orientation, role);
+  }
+  if (orientation == Qt::Horizontal) {
+    return columns_.at(section).header;
+  }
+  return QString::number(recordIndex(section));
+}
+
+void RecordGridModel::sort(int column, Qt::SortOrder order) {
+  arrangement_.sortColumn = column;
+  arrangement_.sortOrder = order;
+  startArrangement();
+}
+
+void RecordGridModel::setFilter(int column, const QString &text) {
+  arrangement_.filterColumn = (text.isEmpty() ? -1 : column);
+  arrangement_.filterText = text;
+  startArrangement();
+}
+
+void RecordGridModel::startArrangement() {
+  if (arrangementCancelled_ != nullptr) {
+    // Whatever is running is out of date
+    *arrangementCancelled_ = true;
+    arrangementCancelled_.reset();
+  }
+  const bool sorted = (arrangement_.sortColumn >= 0 && arrangement_.sortColumn < columnCount());
+  const bool filtered = (arrangement_.filterColumn >= 0 && arrangement_.filterColumn < columnCount());
+  if (!sorted && !filtered) {
+    // Back to the log's own order, which needs no work
+    arrangementWatcher_.setFuture(QFuture<std::vector<uint64_t>>());
+    beginResetModel();
+    rows_.clear();
+    rows_.shrink_to_fit();
+    arranged_ = false;
+    endResetModel();
+    if (busy_) {
+      busy_ = false;
+      emit busyChanged(false);
+    }
+    return;
+  }
+
+  auto cancelled = std::make_shared<std::atomic<bool>>(false);
+  arrangementCancelled_ = cancelled;
+  const FieldPath sortPath = (sorted ? columns_.at(arrangement_.sortColumn).path : FieldPath());
+  const FieldPath filterPath = (filtered ? columns_.at(arrangement_.filterColumn).path : FieldPath());
+  const RecordLog *log = log_.get();
+  const Arrangement arrangement = arrangement_;
+  arrangementWatcher_.setFuture(QtConcurrent::run(&arrangementPool_, [log, arrangement, sortPath, filterPath, cancelled]{
+    return arrange(*log, arrangement, sortPath, filterPath, *cancelled);
+  }));
+  if (!busy_) {
+    busy_ = true;
+    emit busyChanged(true);
+  }
+}
+
+void RecordGridModel::finishArrangement() {
+  if (arrangementCancelled_ == nullptr || *arrangementCancelled_) {
+    return;
+  }
+  arrangementCancelled_.reset();
+  beginResetModel();
+  rows_ = arrangementWatcher_.result();
+  arranged_ = true;
+  endResetModel();
+  busy_ = false;
+  emit busyChanged(false);
+}
+
+std::vector<uint64_t> RecordGridModel::arrange(const RecordLog &log, const Arrangement &arrangement, const FieldPath &sortPath, const FieldPath &filterPath, const std::atomic<bool> &cancelled) {
+  PROTOBUF_EDITOR_TIME_SCOPE("RecordGridModel::arrange");
+  const SortKind kind = (sortPath.empty() ? SortKind::kSigned : sortKind(sortPath.back().fieldDescriptor));
+  std::vector<Chunk> chunks;
+  for (uint64_t begin=0; begin<log.recordCount(); begin+=kChunkSize) {
+    Chunk chunk;
+    chunk.begin = begin;
+    chunk.end = std::min(begin+kChunkSize, log.recordCount());
+    chunks.push_back(std::move(chunk));
+  }
+
+  // Decoding is where the time goes, spread it over every core. Each chunk only reads the log's mapped file.
+  QtConcurrent::blockingMap(chunks, [&](Chunk &chunk){
+    std::unique_ptr<pb::Message> record(log.prototype().New());
+    chunk.keys.reserve(chunk.end-chunk.begin);
+    for (uint64_t recordIndex=chunk.begin; recordIndex<chunk.end; ++recordIndex) {
+      if (cancelled) {
+        return;
+      }
+      // Exceptions can't leave a QtConcurrent task, and a record which can't be read shouldn't stop the rest
+      bool valid = false;
+      try {
+        const auto [recordData, recordSize] = log.rawRecord(recordIndex);
+        valid = record->ParseFromArray(recordData, static_cast<int>(recordSize));
+      } catch (const std::exception &) {
+      }
+      if (!valid) {
+        // Shown as invalid, treated as having no values
+        record->Clear();
+      }
+      if (!filterPath.empty() && !cellText(*record, filterPath).contains(arrangement.filterText, Qt::CaseInsensitive)) {
+        continue;
+      }
+      SortKey key;
+      key.record = recordIndex;
+      if (!sortPath.empty()) {
+        readSortKey(*record, sortPath, kind, &key);
+      }
+      chunk.keys.push_back(std::move(key));
+    }
+  });
+  if (cancelled) {
+    return {};
+  }
+
+  std::vector<SortKey> keys;
+  for (Chunk &chunk : chunks) {
+    std::move(chunk.keys.begin(), chunk.keys.end(), std::back_inserter(keys));
+    chunk.keys = std::vector<SortKey>();
+  }
+  if (!sortPath.empty()) {
+    // Stable, so that equal values stay in the log's order
+    const bool descending = (arrangement.sortOrder == Qt::DescendingOrder);
+    std::stable_sort(keys.begin(), keys.end(), [kind, descending](const SortKey &lhs, const SortKey &rhs){
+      return descending ? keyLessThan(rhs, lhs, kind) : keyLessThan(lhs, rhs, kind);
+    });
+  }
+  std::vector<uint64_t> rows;
+  rows.reserve(std::min<size_t>(keys.size(), std::numeric_limits<int>::max()));
+  for (size_t keyIndex=0; keyIndex<keys.size() && keyIndex<static_cast<size_t>(std::numeric_limits<int>::max()); ++keyIndex) {
+    rows.push_back(keys[keyIndex].record);
+  }
+  return rows;
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
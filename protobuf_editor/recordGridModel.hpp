@@ -0,0 +1,85 @@
+#ifndef PROTOBUF_EDITOR_RECORD_GRID_MODEL_HPP_
+#define PROTOBUF_EDITOR_RECORD_GRID_MODEL_HPP_
+
+#include "fieldPath.hpp"
+#include "recordLog.hpp"
+
+#include <google/protobuf/message.h>
+
+#include <QAbstractTableModel>
+#include <QFutureWatcher>
+#include <QThreadPool>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace protobuf_editor {
+
+// A table of the records of a RecordLog, one row per record and one column per field. Nested messages are flattened
+//  into a column for each of their fields, so every column holds a single value. Repeated fields and maps get one
+//  column, showing their elements or how many there are.
+// Cells are only decoded and formatted when the view asks for them, which is only ever for the rows which are
+//  visible, and are cached per column. Sorting and filtering have to look at every record, so they run on worker
+//  threads, which decode records straight from the log's mapped file. The rows are rearranged once they're done.
+class RecordGridModel : public QAbstractTableModel {
+  Q_OBJECT
+public:
+  explicit RecordGridModel(std::unique_ptr<RecordLog> log, QObject *parent=nullptr);
+  ~RecordGridModel();
+  const RecordLog& log() const;
+
+  int rowCount(const QModelIndex &parent=QModelIndex()) const override;
+  int columnCount(const QModelIndex &parent=QModelIndex()) const override;
+  QVariant data(const QModelIndex &index, int role=Qt::DisplayRole) const override;
+  // Rows are labelled with the index of their record in the log, which stays the same when sorting
+  QVariant headerData(int section, Qt::Orientation orientation, int role=Qt::DisplayRole) const override;
+  // -1 to go back to the order of the log
+  void sort(int column, Qt::SortOrder order=Qt::AscendingOrder) override;
+
+  // Only shows the records whose `column` contains `text`, ignoring case. An empty text shows every record.
+  void setFilter(int column, const QString &text);
+  const FieldPath& columnPath(int column) const;
+  uint64_t recordIndex(int row) const;
+  // Whether a sort or filter is running
+  bool isBusy() const;
+private:
+  struct Column {
+    FieldPath path;
+    QString header;
+    // Formatted cells, by record index. Dropped as a whole once it's full, refilling the visible rows is cheap.
+    mutable std::unordered_map<uint64_t, QString> cells;
+  };
+  struct Arrangement {
+    int sortColumn{-1};
+    Qt::SortOrder sortOrder{Qt::AscendingOrder};
+    int filterColumn{-1};
+    QString filterText;
+  };
+  const std::unique_ptr<RecordLog> log_;
+  std::vector<Column> columns_;
+  Arrangement arrangement_;
+  // The record shown in each row. Only used while sorted or filtered, otherwise row and record are the same.
+  std::vector<uint64_t> rows_;
+  bool arranged_{false};
+  // Runs one arrangement at a time, which spreads its work over the global pool
+  QThreadPool arrangementPool_;
+  QFutureWatcher<std::vector<uint64_t>> arrangementWatcher_;
+  // Set to stop the arrangement which is running, once a newer one replaces it
+  std::shared_ptr<std::atomic<bool>> arrangementCancelled_;
+  bool busy_{false};
+  void addColumns(const google::protobuf::Descriptor *descriptor, const FieldPath &prefix, int depth);
+  void startArrangement();
+  void finishArrangement();
+  // Runs on a worker thread. Paths are empty for no sort or no filter.
+  static std::vector<uint64_t> arrange(const RecordLog &log, const Arrangement &arrangement, const FieldPath &sortPath, const FieldPath &filterPath, const std::atomic<bool> &cancelled);
+  static QString cellText(const google::protobuf::Message &record, const FieldPath &path);
+signals:
+  void busyChanged(bool busy);
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_RECORD_GRID_MODEL_HPP_
@@ -0,0 +1,207 @@
+#include "recordLog.hpp"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace pb = google::protobuf;
+
+namespace {
+
+constexpr quint32 kSidecarMagic = 0x50424c49; // "PBLI"
+constexpr quint32 kSidecarVersion = 1;
+
+// Reads the varint size prefix of a record. Returns the number of bytes it took up, or 0 if it runs past `end` or is
+//  longer than a 32 bit varint can be.
+int readSizePrefix(const uchar *position, const uchar *end, uint32_t *size) {
+  uint32_t result = 0;
+  for (int byteIndex=0; byteIndex<5; ++byteIndex) {
+    if (position+byteIndex >= end) {
+      return 0;
+    }
+    const uchar byte = position[byteIndex];
+    result |= static_cast<uint32_t>(byte & 0x7f) << (7*byteIndex);
+    if ((byte & 0x80) == 0) {
+      *size = result;
+      return byteIndex+1;
+    }
+  }
+  return 0;
+}
+
+qint64 modificationTime(const QString &path) {
+  return QFileInfo(path).lastModified().toMSecsSinceEpoch();
+}
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+RecordLog::RecordLog(const QString &path, const pb::Message &prototype, size_t cacheCapacity) : file_(path), prototype_(prototype.New()), cacheCapacity_(std::max<size_t>(cacheCapacity, 1)) {
+  if (!file_.open(QIODevice::ReadOnly)) {
+    throw std::runtime_error("Failed to open \""+path.toStdString()+"\": "+file_.errorString().toStdString());
+  }
+  size_ = static_cast<uint64_t>(file_.size());
+  if (size_ > 0) {
+    // Only the pages which are touched are read, and they can be dropped again by the OS at any time since they're
+    //  backed by the file. On 32 bit systems, files which don't fit in the address space fail to map.
+    data_ = file_.map(0, file_.size());
+    if (data_ == nullptr) {
+      throw std::runtime_error("Failed to map \""+path.toStdString()+"\": "+file_.errorString().toStdString());
+    }
+  }
+  indexLoadedFromSidecar_ = readSidecarIndex();
+  if (!indexLoadedFromSidecar_) {
+    buildIndex();
+    writeSidecarIndex();
+  }
+}
+
+QString RecordLog::path() const {
+  return file_.fileName();
+}
+
+const pb::Descriptor* RecordLog::descriptor() const {
+  return prototype_->GetDescriptor();
+}
+
+const pb::Message& RecordLog::prototype() const {
+  return *prototype_;
+}
+
+uint64_t RecordLog::recordCount() const {
+  return recordCount_;
+}
+
+bool RecordLog::indexLoadedFromSidecar() const {
+  return indexLoadedFromSidecar_;
+}
+
+void RecordLog::buildIndex() {
+  checkpoints_.clear();
+  recordCount_ = 0;
+  const uchar *end = data_+size_;
+  uint64_t offset = 0;
+  while (offset < size_) {
+    uint32_t recordSize;
+    const int prefixLength = readSizePrefix(data_+offset, end, &recordSize);
+    if (prefixLength == 0 || recordSize > size_-offset-prefixLength) {
+      // Truncated, there are no more complete records
+      break;
+    }
+    if (recordCount_ % kIndexStride == 0) {
+      checkpoints_.push_back(offset);
+    }
+    ++recordCount_;
+    offset += prefixLength + recordSize;
+  }
+}
+
+std::pair<const uchar*, size_t> RecordLog::rawRecord(uint64_t index) const {
+  if (index >= recordCount_) {
+    throw std::runtime_error("Record "+std::to_string(index)+" is out of range, there are "+std::to_string(recordCount_)+" records");
+  }
+  // Start at the closest checkpoint before the record, and skip forward over the records in between
+  const uchar *end = data_+size_;
+  uint64_t offset = checkpoints_.at(index / kIndexStride);
+  for (uint64_t skip=index % kIndexStride; ; --skip) {
+    uint32_t recordSize;
+    const int prefixLength = readSizePrefix(data_+offset, end, &recordSize);
+    // The index may be stale, a record must never be handed out if it runs past the end of the mapping
+    if (prefixLength == 0 || recordSize > static_cast<uint64_t>(end-(data_+offset+prefixLength))) {
+      throw std::runtime_error("\""+path().toStdString()+"\" changed since it was indexed");
+    }
+    if (skip == 0) {
+      return {data_+offset+prefixLength, recordSize};
+    }
+    offset += prefixLength + recordSize;
+  }
+}
+
+std::shared_ptr<const pb::Message> RecordLog::record(uint64_t index) {
+  auto cached = cacheIndex_.find(index);
+  if (cached != cacheIndex_.end()) {
+    // Now the most recently used
+    cache_.splice(cache_.begin(), cache_, cached->second);
+    return cached->second->second;
+  }
+
+  const auto [recordData, recordSize] = rawRecord(index);
+  std::shared_ptr<pb::Message> message(prototype_->New());
+  if (!message->ParseFromArray(recordData, static_cast<int>(recordSize))) {
+    throw std::runtime_error("Record "+std::to_string(index)+" is not a valid "+message->GetTypeName()+" message");
+  }
+
+  cache_.emplace_front(index, message);
+  cacheIndex_[index] = cache_.begin();
+  if (cache_.size() > cacheCapacity_) {
+    cacheIndex_.erase(cache_.back().first);
+    cache_.pop_back();
+  }
+  return message;
+}
+
+QString RecordLog::sidecarPath() const {
+  return path()+".idx";
+}
+
+bool RecordLog::readSidecarIndex() {
+  QFile sidecar(sidecarPath());
+  if (!sidecar.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+  QDataStream stream(&sidecar);
+  quint32 magic, version, stride;
+  quint64 fileSize, recordCount, checkpointCount;
+  qint64 fileModificationTime;
+  stream >> magic >> version >> stride >> fileSize >> fileModificationTime >> recordCount >> checkpointCount;
+  // Only usable if it was made for exactly this file, as it is now
+  if (stream.status() != QDataStream::Ok || magic != kSidecarMagic || version != kSidecarVersion || stride != kIndexStride) {
+    return false;
+  }
+  if (fileSize != size_ || fileModificationTime != modificationTime(path())) {
+    return false;
+  }
+  // Every record takes up at least one byte, anything else is a corrupt sidecar
+  if (recordCount > size_ || checkpointCount != (recordCount+kIndexStride-1)/kIndexStride) {
+    return false;
+  }
+  std::vector<uint64_t> checkpoints(checkpointCount);
+  for (uint64_t &checkpoint : checkpoints) {
+    quint64 offset;
+    stream >> offset;
+    if (offset >= size_) {
+      return false;
+    }
+    checkpoint = offset;
+  }
+  if (stream.status() != QDataStream::Ok) {
+    return false;
+  }
+  checkpoints_ = std::move(checkpoints);
+  recordCount_ = recordCount;
+  return true;
+}
+
+void RecordLog::writeSidecarIndex() const {
+  // Only an optimization for the next time the file is opened, so failing to write it is fine
+  QSaveFile sidecar(sidecarPath());
+  if (!sidecar.open(QIODevice::WriteOnly)) {
+    return;
+  }
+  QDataStream stream(&sidecar);
+  stream << kSidecarMagic << kSidecarVersion << kIndexStride << static_cast<quint64>(size_) << modificationTime(path()) << static_cast<quint64>(recordCount_) << static_cast<quint64>(checkpoints_.size());
+  for (const uint64_t checkpoint : checkpoints_) {
+    stream << static_cast<quint64>(checkpoint);
+  }
+  if (stream.status() == QDataStream::Ok) {
+    sidecar.commit();
+  }
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef PROTOBUF_EDITOR_RECORD_LOG_HPP_
+#define PROTOBUF_EDITOR_RECORD_LOG_HPP_
+
+#include <google/protobuf/message.h>
+
+#include <QFile>
+#include <QString>
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace protobuf_editor {
+
+// Random access to a file of length-delimited messages, each one a varint size followed by that many bytes, as
+//  written by SerializeDelimitedToOstream or Java's writeDelimitedTo.
+// The file is memory-mapped, and indexed in a single sequential pass when opened. The index only keeps the offset of
+//  every kIndexStride-th record, and finding any other record skips over at most kIndexStride-1 size prefixes, so it
+//  stays small for files with hundreds of millions of records. The index is saved next to the file as "<file>.idx",
+//  and reused on the next open as long as the file hasn't changed. Only the records which are asked for are decoded,
+//  and the most recently used ones are kept decoded.
+// Not thread-safe.
+class RecordLog {
+public:
+  static constexpr uint32_t kIndexStride = 64;
+
+  // Records are decoded as messages of the prototype's type. Throws if the file can't be opened or mapped. A truncated record at the end of the file, e.g. one which is still
+  //  being written, is not counted.
+  RecordLog(const QString &path, const google::protobuf::Message &prototype, size_t cacheCapacity=64);
+  QString path() const;
+  const google::protobuf::Descriptor* descriptor() const;
+  // An empty message of the log's type
+  const google::protobuf::Message& prototype() const;
+  uint64_t recordCount() const;
+  // Decodes the record, or returns it from the cache. Throws if `index` is out of range or the record can't be parsed.
+  //  The record stays valid for as long as the caller holds on to it, even once it has left the cache.
+  std::shared_ptr<const google::protobuf::Message> record(uint64_t index);
+  // The encoded bytes of the record, without its size prefix. Only valid for the lifetime of the log. Unlike the rest
+  //  of the log, this only reads, so it may be called from several threads at once.
+  std::pair<const uchar*, size_t> rawRecord(uint64_t index) const;
+  bool indexLoadedFromSidecar() const;
+private:
+  QFile file_;
+  // An empty message of the log's type, records are decoded into copies of it
+  const std::unique_ptr<const google::protobuf::Message> prototype_;
+  const uchar *data_{nullptr};
+  uint64_t size_{0};
+  uint64_t recordCount_{0};
+  // The offset of records 0, kIndexStride, 2*kIndexStride, ...
+  std::vector<uint64_t> checkpoints_;
+  bool indexLoadedFromSidecar_{false};
+  // Most recently used first
+  const size_t cacheCapacity_;
+  std::list<std::pair<uint64_t, std::shared_ptr<const google::protobuf::Message>>> cache_;
+  std::unordered_map<uint64_t, decltype(cache_)::iterator> cacheIndex_;
+
+  void buildIndex();
+  bool readSidecarIndex();
+  void writeSidecarIndex() const;
+  QString sidecarPath() const;
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_RECORD_LOG_HPP_
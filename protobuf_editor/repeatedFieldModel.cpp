@@ -0,0 +1,174 @@
+#include "fieldValue.hpp"
+#include "repeatedFieldModel.hpp"
+
+namespace pb = google::protobuf;
+
+namespace {
+
+// Nested messages are summarized in the list, and edited in a separate widget. Don't show too much of them.
+constexpr int kMaxSummaryLength = 200;
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+RepeatedFieldModel::RepeatedFieldModel(const pb::FieldDescriptor *fieldDescriptor, QObject *parent) : QAbstractListModel(parent), fieldDescriptor_(fieldDescriptor) {
+  if (!fieldDescriptor_->is_repeated()) {
+    throw std::runtime_error("Repeated field model was constructed with a field which is not repeated");
+  }
+}
+
+void RepeatedFieldModel::setMessage(pb::Message *message) {
+  beginResetModel();
+  message_ = message;
+  mutableMessage_ = message;
+  endResetModel();
+}
+
+void RepeatedFieldModel::setReadOnlyMessage(const pb::Message *message) {
+  beginResetModel();
+  message_ = message;
+  mutableMessage_ = nullptr;
+  endResetModel();
+}
+
+pb::Message* RepeatedFieldModel::mutableMessage() const {
+  if (mutableMessage_ == nullptr) {
+    throw std::runtime_error("Modifying a repeated field, but there is no message or it is read-only");
+  }
+  return mutableMessage_;
+}
+
+int RepeatedFieldModel::rowCount(const QModelIndex &parent) const {
+  if (parent.isValid() || message_ == nullptr) {
+    return 0;
+  }
+  return message_->GetReflection()->FieldSize(*message_, fieldDescriptor_);
+}
+
+QVariant RepeatedFieldModel::data(const QModelIndex &index, int role) const {
+  if (!index.isValid() || message_ == nullptr) {
+    return {};
+  }
+  if (role == FieldDescriptorRole) {
+    return QVariant::fromValue(fieldDescriptor_);
+  }
+  if (role != Qt::DisplayRole && role != Qt::EditRole) {
+    return {};
+  }
+
+  if (fieldDescriptor_->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE) {
+    if (role == Qt::EditRole) {
+      return {};
+    }
+    const pb::Message &element = message_->GetReflection()->GetRepeatedMessage(*message_, fieldDescriptor_, index.row());
+    QString summary = QString::fromStdString(element.ShortDebugString());
+    if (summary.size() > kMaxSummaryLength) {
+      summary = summary.left(kMaxSummaryLength) + QStringLiteral("...");
+    }
+    return QStringLiteral("[%1] {%2}").arg(index.row()).arg(summary);
+  }
+
+  const QVariant value = readFieldValue(*message_, fieldDescriptor_, index.row());
+  if (role == Qt::EditRole) {
+    return value;
+  }
+  return QStringLiteral("[%1] %2").arg(index.row()).arg(fieldValueToString(fieldDescriptor_, value));
+}
+
+bool RepeatedFieldModel::setData(const QModelIndex &index, const QVariant &value, int role) {
+  if (!index.isValid() || mutableMessage_ == nullptr || role != Qt::EditRole) {
+    return false;
+  }
+  emit aboutToChangeField(index.row());
+  if (!writeFieldValue(mutableMessage(), fieldDescriptor_, value, index.row())) {
+    return false;
+  }
+  // Only this one element changed, the view does not need to re-read any other rows
+  emit dataChanged(index, index);
+  emit fieldChanged(index.row());
+  return true;
+}
+
+Qt::ItemFlags RepeatedFieldModel::flags(const QModelIndex &index) const {
+  Qt::ItemFlags result = QAbstractListModel::flags(index);
+  if (index.isValid() && mutableMessage_ != nullptr && fieldDescriptor_->cpp_type() != pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE) {
+    result |= Qt::ItemIsEditable;
+  }
+  return result;
+}
+
+void RepeatedFieldModel::appendElement() {
+  pb::Message *message = mutableMessage();
+  const int row = rowCount();
+  emit aboutToChangeField(-1);
+  beginInsertRows(QModelIndex(), row, row);
+  appendDefaultFieldValue(message, fieldDescriptor_);
+  endInsertRows();
+  emit fieldChanged(-1);
+}
+
+void RepeatedFieldModel::insertElement(int row) {
+  pb::Message *message = mutableMessage();
+  const int lastRow = rowCount();
+  if (row < 0 || row > lastRow) {
+    throw std::runtime_error("Inserting into a repeated field at an invalid index");
+  }
+  emit aboutToChangeField(-1);
+  beginInsertRows(QModelIndex(), row, row);
+  // Reflection can only append, so append and then move the new element into place
+  appendDefaultFieldValue(message, fieldDescriptor_);
+  bubbleElement(lastRow, row);
+  endInsertRows();
+  emit fieldChanged(-1);
+}
+
+void RepeatedFieldModel::removeElement(int row) {
+  pb::Message *message = mutableMessage();
+  const int lastRow = rowCount()-1;
+  if (row < 0 || row > lastRow) {
+    throw std::runtime_error("Removing from a repeated field at an invalid index");
+  }
+  emit aboutToChangeField(-1);
+  beginRemoveRows(QModelIndex(), row, row);
+  // Reflection can only remove the last element, so first move the element to the end, preserving the order of the others
+  bubbleElement(row, lastRow);
+  message->GetReflection()->RemoveLast(message, fieldDescriptor_);
+  endRemoveRows();
+  emit fieldChanged(-1);
+}
+
+void RepeatedFieldModel::moveElement(int fromRow, int toRow) {
+  // Throws before anything is changed if read-only
+  mutableMessage();
+  const int size = rowCount();
+  if (fromRow < 0 || fromRow >= size || toRow < 0 || toRow >= size) {
+    throw std::runtime_error("Moving within a repeated field with an invalid index");
+  }
+  if (fromRow == toRow) {
+    return;
+  }
+  emit aboutToChangeField(-1);
+  // Qt expects the destination to be the row which the element will be placed before, as if it were still in the list
+  beginMoveRows(QModelIndex(), fromRow, fromRow, QModelIndex(), (toRow > fromRow ? toRow+1 : toRow));
+  bubbleElement(fromRow, toRow);
+  endMoveRows();
+  emit fieldChanged(-1);
+}
+
+void RepeatedFieldModel::elementChanged(int row) {
+  const QModelIndex changedIndex = index(row);
+  emit dataChanged(changedIndex, changedIndex);
+}
+
+void RepeatedFieldModel::bubbleElement(int fromRow, int toRow) {
+  // Swapping elements is cheap, even for messages, since only pointers are swapped
+  pb::Message *message = mutableMessage();
+  const pb::Reflection *reflection = message->GetReflection();
+  const int step = (toRow > fromRow ? 1 : -1);
+  for (int row=fromRow; row!=toRow; row+=step) {
+    reflection->SwapElements(message, fieldDescriptor_, row, row+step);
+  }
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
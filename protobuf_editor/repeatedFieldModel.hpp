@@ -0,0 +1,54 @@
+#ifndef PROTOBUF_EDITOR_REPEATED_FIELD_MODEL_HPP_
+#define PROTOBUF_EDITOR_REPEATED_FIELD_MODEL_HPP_
+
+#include <google/protobuf/message.h>
+
+#include <QAbstractListModel>
+
+namespace protobuf_editor {
+
+// A list model over the elements of one repeated field of a message. Elements are read on demand through
+//  Reflection::GetRepeated*, so a view only reads the rows that are visible, and structural edits are reported as
+//  row insertions/removals/moves rather than a reset.
+class RepeatedFieldModel : public QAbstractListModel {
+  Q_OBJECT
+public:
+  enum Role {
+    // The const google::protobuf::FieldDescriptor* of the repeated field
+    FieldDescriptorRole = Qt::UserRole + 1
+  };
+
+  explicit RepeatedFieldModel(const google::protobuf::FieldDescriptor *fieldDescriptor, QObject *parent=nullptr);
+  // `message` is the message which contains the repeated field
+  void setMessage(google::protobuf::Message *message);
+  // Elements can be viewed but not edited
+  void setReadOnlyMessage(const google::protobuf::Message *message);
+
+  int rowCount(const QModelIndex &parent=QModelIndex()) const override;
+  QVariant data(const QModelIndex &index, int role=Qt::DisplayRole) const override;
+  bool setData(const QModelIndex &index, const QVariant &value, int role=Qt::EditRole) override;
+  Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+  void appendElement();
+  void insertElement(int row);
+  void removeElement(int row);
+  void moveElement(int fromRow, int toRow);
+  // To be called when an element was modified through something other than this model, e.g. a nested message editor
+  void elementChanged(int row);
+private:
+  const google::protobuf::FieldDescriptor* const fieldDescriptor_;
+  const google::protobuf::Message *message_{nullptr};
+  // Null when read-only
+  google::protobuf::Message *mutableMessage_{nullptr};
+  google::protobuf::Message* mutableMessage() const;
+  void bubbleElement(int fromRow, int toRow);
+signals:
+  // Emitted right before the message is modified, with the same row which fieldChanged will be emitted with
+  void aboutToChangeField(int row);
+  // `row` is the element which was edited, or -1 if the structure of the field changed
+  void fieldChanged(int row);
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_REPEATED_FIELD_MODEL_HPP_
@@ -0,0 +1,306 @@
+#include "descriptorLayout.hpp"
+#include "fieldValue.hpp"
+#include "instrumentation.hpp"
+#include "messageTypeWidget.hpp"
+#include "numericStatsPanel.hpp"
+#include "protobufItemDelegate.hpp"
+#include "repeatedFieldModel.hpp"
+#include "repeatedFieldWidget.hpp"
+
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+
+#include <algorithm>
+
+namespace pb = google::protobuf;
+
+namespace {
+
+// The list scrolls on its own rather than growing with the number of elements
+constexpr int kListViewHeight = 200;
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+RepeatedFieldWidget::RepeatedFieldWidget(const pb::FieldDescriptor *fieldDescriptor, QWidget *parent) : ProtobufFieldWidget(fieldDescriptor, parent) {
+  buildWidget();
+}
+
+void RepeatedFieldWidget::buildWidget() {
+  if (!fieldDescriptor_->is_repeated()) {
+    throw std::runtime_error("Repeated field widget was constructed with a field which is not repeated");
+  }
+
+  if (fieldDescriptor_->is_map()) {
+    throw std::runtime_error("Previous logic should prevent us from receiving a map-type");
+  }
+
+  QVBoxLayout *overallLayout = new QVBoxLayout(this);
+  overallLayout->setContentsMargins(0,0,0,0);
+  groupBox_ = new QGroupBox(fieldLayout(fieldDescriptor_).label);
+  overallLayout->addWidget(groupBox_);
+  QVBoxLayout *groupBoxLayout = new QVBoxLayout(groupBox_);
+
+  // A row of buttons for changing the structure of the list
+  QHBoxLayout *buttonLayout = new QHBoxLayout;
+  auto createButton = [this, buttonLayout](const QString &text) {
+    QToolButton *button = new QToolButton;
+    button->setText(text);
+    buttonLayout->addWidget(button);
+    return button;
+  };
+  appendButton_ = createButton(tr("Append"));
+  insertButton_ = createButton(tr("Insert"));
+  removeButton_ = createButton(tr("Remove"));
+  moveUpButton_ = createButton(tr("Move Up"));
+  moveDownButton_ = createButton(tr("Move Down"));
+  if (NumericStats::supports(fieldDescriptor_)) {
+    statsButton_ = createButton(tr("Statistics"));
+    statsButton_->setCheckable(true);
+  }
+  buttonLayout->addStretch();
+  sizeLabel_ = new QLabel;
+  buttonLayout->addWidget(sizeLabel_);
+  groupBoxLayout->addLayout(buttonLayout);
+
+  model_ = new RepeatedFieldModel(fieldDescriptor_, this);
+  listView_ = new QListView;
+  // Every row has the same height, this lets the view skip measuring rows which are not visible
+  listView_->setUniformItemSizes(true);
+  listView_->setLayoutMode(QListView::Batched);
+  listView_->setFixedHeight(kListViewHeight);
+  listView_->setItemDelegate(new ProtobufItemDelegate(RepeatedFieldModel::FieldDescriptorRole, listView_));
+  listView_->setModel(model_);
+  groupBoxLayout->addWidget(listView_);
+
+  if (statsButton_ != nullptr) {
+    // Nothing is computed until the statistics are shown
+    stats_ = std::make_unique<NumericStats>(fieldDescriptor_);
+    statsPanel_ = new NumericStatsPanel;
+    statsPanel_->setVisible(false);
+    groupBoxLayout->addWidget(statsPanel_);
+    connect(statsButton_, &QToolButton::toggled, [this](bool checked){
+      statsPanel_->setVisible(checked);
+      updateStats();
+    });
+  }
+
+  connect(model_, &RepeatedFieldModel::aboutToChangeField, [this](int row){
+    if (statsShown() && row != -1) {
+      previousValue_ = readFieldValue(*currentMessage_, fieldDescriptor_, row).toDouble();
+    }
+    beginFieldEdit(FieldPath(fieldDescriptor_, row));
+  });
+  connect(model_, &RepeatedFieldModel::fieldChanged, [this](int row){
+    updateControls();
+    updateStatsAfterEdit(row);
+    reportFieldChanged(FieldPath(fieldDescriptor_, row));
+  });
+
+  connect(appendButton_, &QToolButton::clicked, [this]{
+    model_->appendElement();
+    setCurrentRow(model_->rowCount()-1);
+  });
+  connect(insertButton_, &QToolButton::clicked, [this]{
+    const int row = std::max(currentRow(), 0);
+    model_->insertElement(row);
+    setCurrentRow(row);
+  });
+  connect(removeButton_, &QToolButton::clicked, [this]{
+    const int row = currentRow();
+    if (row == -1) {
+      return;
+    }
+    // Make sure that nothing is referencing the element which is about to be removed
+    setCurrentRow(-1);
+    model_->removeElement(row);
+    setCurrentRow(std::min(row, model_->rowCount()-1));
+  });
+  connect(moveUpButton_, &QToolButton::clicked, [this]{
+    const int row = currentRow();
+    if (row <= 0) {
+      return;
+    }
+    model_->moveElement(row, row-1);
+    setCurrentRow(row-1);
+    // The selected element moved along with the selection, but its index changed
+    updateElementWidget();
+  });
+  connect(moveDownButton_, &QToolButton::clicked, [this]{
+    const int row = currentRow();
+    if (row == -1 || row+1 >= model_->rowCount()) {
+      return;
+    }
+    model_->moveElement(row, row+1);
+    setCurrentRow(row+1);
+    updateElementWidget();
+  });
+
+  if (fieldDescriptor_->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE) {
+    // There is only ever one widget for editing a nested message, it is given whichever element is selected
+    elementWidget_ = new MessageTypeWidget(fieldDescriptor_->message_type(), fieldDescriptor_);
+    elementWidget_->setVisible(false);
+    elementWidget_->setParentFieldWidget(this);
+    groupBoxLayout->addWidget(elementWidget_);
+  }
+
+  connect(listView_->selectionModel(), &QItemSelectionModel::currentChanged, [this]{
+    updateElementWidget();
+    updateControls();
+  });
+
+  updateControls();
+}
+
+void RepeatedFieldWidget::setDataFromMessage() {
+  if (currentMessage_ == nullptr) {
+    throw std::runtime_error("Setting data from message, but message is null");
+  }
+  // Resetting the model is cheap, the view will only read the rows which are visible
+  setCurrentRow(-1);
+  if (isReadOnly()) {
+    model_->setReadOnlyMessage(currentMessage_);
+  } else {
+    model_->setMessage(mutableCurrentMessage());
+  }
+  updateControls();
+  updateStats();
+}
+
+void RepeatedFieldWidget::refreshFieldPath(const FieldPath &path, size_t position) {
+  const int row = path.at(position).index;
+  if (row == -1 || currentMessage_ == nullptr || row >= model_->rowCount()) {
+    // Elements may have been added or removed, start over
+    setDataFromMessage();
+    return;
+  }
+  // A single element changed, only that row needs to be redrawn
+  model_->elementChanged(row);
+  // The element's previous value is already gone
+  updateStats();
+  if (elementWidget_ != nullptr && row == currentRow()) {
+    if (position+1 < path.size()) {
+      elementWidget_->refreshFieldPath(path, position);
+    } else {
+      updateElementWidget();
+    }
+  }
+}
+
+ProtobufFieldWidget* RepeatedFieldWidget::revealElement(const FieldPath &path, size_t position) {
+  const int row = path.at(position).index;
+  if (row == -1 || row >= model_->rowCount()) {
+    // The whole field, or an element which doesn't exist (anymore)
+    return this;
+  }
+  // Selecting the row gives the element widget its message
+  setCurrentRow(row);
+  if (elementWidget_ == nullptr || position+1 == path.size()) {
+    return this;
+  }
+  return elementWidget_->revealField(path, position+1);
+}
+
+void RepeatedFieldWidget::qualifyFieldPath(FieldPath &path) {
+  // Paths which reach us, either from our own model or from the element widget, already start with this field and
+  //  the index of the element, so there is nothing to add
+  if (path.size() > 1) {
+    // Something inside of a nested message changed, only the summary of that one element needs to be redrawn
+    model_->elementChanged(path.front().index);
+  }
+}
+
+int RepeatedFieldWidget::currentRow() const {
+  const QModelIndex current = listView_->currentIndex();
+  return (current.isValid() ? current.row() : -1);
+}
+
+void RepeatedFieldWidget::setCurrentRow(int row) {
+  if (row < 0) {
+    listView_->setCurrentIndex(QModelIndex());
+    return;
+  }
+  const QModelIndex index = model_->index(row);
+  listView_->setCurrentIndex(index);
+  listView_->scrollTo(index);
+}
+
+void RepeatedFieldWidget::updateElementWidget() {
+  if (elementWidget_ == nullptr) {
+    return;
+  }
+  const int row = currentRow();
+  if (row == -1 || currentMessage_ == nullptr) {
+    elementWidget_->setVisible(false);
+    return;
+  }
+  elementWidget_->setRepeatedIndex(row);
+  const pb::Reflection *reflection = currentMessage_->GetReflection();
+  if (isReadOnly()) {
+    elementWidget_->setReadOnlyMessage(&reflection->GetRepeatedMessage(*currentMessage_, fieldDescriptor_, row), currentMessage_);
+  } else {
+    pb::Message *element = reflection->MutableRepeatedMessage(mutableCurrentMessage(), fieldDescriptor_, row);
+    elementWidget_->setMessage(element, mutableCurrentMessage());
+  }
+  showElementSizes();
+  elementWidget_->setVisible(true);
+}
+
+void RepeatedFieldWidget::updateSizeOverlay() {
+  updateControls();
+  showElementSizes();
+}
+
+void RepeatedFieldWidget::showElementSizes() {
+  const int row = currentRow();
+  if (elementWidget_ == nullptr || row == -1) {
+    return;
+  }
+  FieldPath elementPath = sizePath_;
+  elementPath.append(fieldDescriptor_, row);
+  elementWidget_->showSizes(sizeProfile_, elementPath);
+}
+
+bool RepeatedFieldWidget::statsShown() const {
+  return (statsButton_ != nullptr && statsButton_->isChecked());
+}
+
+void RepeatedFieldWidget::updateStats() {
+  if (!statsShown() || currentMessage_ == nullptr) {
+    return;
+  }
+  PROTOBUF_EDITOR_TIME_SCOPE("statistics " + fieldDescriptor_->full_name());
+  stats_->compute(*currentMessage_);
+  statsPanel_->setStats(*stats_);
+}
+
+void RepeatedFieldWidget::updateStatsAfterEdit(int row) {
+  if (!statsShown() || currentMessage_ == nullptr) {
+    return;
+  }
+  // Editing one element usually only needs its old and new value, anything else needs a pass over every element
+  if (row == -1 || !stats_->replaceValue(previousValue_, readFieldValue(*currentMessage_, fieldDescriptor_, row).toDouble())) {
+    updateStats();
+    return;
+  }
+  statsPanel_->setStats(*stats_);
+}
+
+void RepeatedFieldWidget::updateControls() {
+  const int size = model_->rowCount();
+  const int row = currentRow();
+  const bool editable = !isReadOnly();
+  if (sizeProfile_ == nullptr) {
+    sizeLabel_->setText(tr("%n element(s)", "", size));
+  } else {
+    sizeLabel_->setText(tr("%n element(s), %1", "", size).arg(byteSizeText()));
+  }
+  appendButton_->setEnabled(editable);
+  insertButton_->setEnabled(editable);
+  removeButton_->setEnabled(editable && row != -1);
+  moveUpButton_->setEnabled(editable && row > 0);
+  moveDownButton_->setEnabled(editable && row != -1 && row+1 < size);
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
@@ -0,0 +1,67 @@
+#ifndef PROTOBUF_EDITOR_REPEATED_FIELD_WIDGET_HPP_
+#define PROTOBUF_EDITOR_REPEATED_FIELD_WIDGET_HPP_
+
+#include "numericStats.hpp"
+#include "protobufFieldWidget.hpp"
+
+#include <google/protobuf/message.h>
+
+#include <QGroupBox>
+#include <QLabel>
+#include <QListView>
+#include <QToolButton>
+
+#include <memory>
+
+namespace protobuf_editor {
+
+class MessageTypeWidget;
+class NumericStatsPanel;
+class RepeatedFieldModel;
+
+// A widget for editing a repeated field. The elements are shown in a QListView, so only the visible elements are
+//  ever read or drawn, no matter how many there are. Built-in types are edited in place. For repeated messages, a
+//  single MessageTypeWidget below the list edits whichever element is selected. Numeric fields can also show
+//  statistics of all of their elements, which are kept up to date while shown.
+class RepeatedFieldWidget : public ProtobufFieldWidget {
+  Q_OBJECT
+public:
+  explicit RepeatedFieldWidget(const google::protobuf::FieldDescriptor *fieldDescriptor, QWidget *parent=nullptr);
+  void refreshFieldPath(const FieldPath &path, size_t position) override;
+  // Selects the element which `path` indexes at `position`, and for repeated messages, goes on to reveal the rest of
+  //  the path in the element widget. Returns the widget which is closest to the field.
+  ProtobufFieldWidget* revealElement(const FieldPath &path, size_t position);
+private:
+  RepeatedFieldModel *model_{nullptr};
+  QGroupBox *groupBox_{nullptr};
+  QListView *listView_{nullptr};
+  QLabel *sizeLabel_{nullptr};
+  QToolButton *appendButton_{nullptr};
+  QToolButton *insertButton_{nullptr};
+  QToolButton *removeButton_{nullptr};
+  QToolButton *moveUpButton_{nullptr};
+  QToolButton *moveDownButton_{nullptr};
+  MessageTypeWidget *elementWidget_{nullptr};
+  // Only for numeric fields
+  QToolButton *statsButton_{nullptr};
+  NumericStatsPanel *statsPanel_{nullptr};
+  std::unique_ptr<NumericStats> stats_;
+  // The value of the element which is being edited, from right before the edit
+  double previousValue_{0};
+  void buildWidget();
+  void setDataFromMessage() override;
+  void qualifyFieldPath(FieldPath &path) override;
+  int currentRow() const;
+  void setCurrentRow(int row);
+  void updateControls();
+  void updateElementWidget();
+  void updateSizeOverlay() override;
+  void showElementSizes();
+  bool statsShown() const;
+  void updateStats();
+  void updateStatsAfterEdit(int row);
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_REPEATED_FIELD_WIDGET_HPP_
@@ -0,0 +1,211 @@
+#include "sizeProfile.hpp"
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format.h>
+
+#include <algorithm>
+
+namespace pb = google::protobuf;
+
+namespace {
+
+// The bytes which precede an element of a message field: its tag and, unless it's a group, its length
+size_t messageElementOverhead(const pb::FieldDescriptor *fieldDescriptor, size_t byteSize) {
+  // For groups, this counts both the start and end tags
+  const size_t tagSize = pb::internal::WireFormat::TagSize(fieldDescriptor->number(), fieldDescriptor->type());
+  if (fieldDescriptor->type() == pb::FieldDescriptor::Type::TYPE_GROUP) {
+    return tagSize;
+  }
+  return tagSize + pb::io::CodedOutputStream::VarintSize64(byteSize);
+}
+
+// Orders the heap so that the smallest of the largest fields found so far is on top
+bool largerField(const protobuf_editor::FieldSize &lhs, const protobuf_editor::FieldSize &rhs) {
+  if (lhs.bytes != rhs.bytes) {
+    return lhs.bytes > rhs.bytes;
+  }
+  return lhs.path < rhs.path;
+}
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+void SizeProfile::setMessage(const pb::Message *message) {
+  message_ = message;
+  root_ = Node();
+}
+
+void SizeProfile::fieldsChanged(const std::vector<FieldPath> &paths) {
+  for (const FieldPath &path : paths) {
+    invalidate(path);
+  }
+}
+
+void SizeProfile::invalidate(const FieldPath &path) {
+  // Every message along the path has to list its fields again, but the siblings of the path keep their sizes
+  Node *node = &root_;
+  node->valid = false;
+  for (size_t position=0; position<path.size(); ++position) {
+    const FieldPath::Element &element = path.at(position);
+    auto childrenIt = node->children.find(element.fieldDescriptor);
+    if (childrenIt == node->children.end()) {
+      // Nothing cached below here
+      return;
+    }
+    std::vector<std::unique_ptr<Node>> &children = childrenIt->second;
+    const size_t childIndex = (element.index == -1 ? 0 : static_cast<size_t>(element.index));
+    if (position+1 == path.size()) {
+      // The field itself changed, e.g. an element was inserted or a nested message was replaced, so whatever was
+      //  cached for it may no longer line up with the message
+      if (element.index == -1) {
+        node->children.erase(childrenIt);
+      } else if (childIndex < children.size()) {
+        children[childIndex].reset();
+      }
+      return;
+    }
+    if (childIndex >= children.size() || children[childIndex] == nullptr) {
+      return;
+    }
+    node = children[childIndex].get();
+    node->valid = false;
+  }
+}
+
+size_t SizeProfile::totalBytes() {
+  if (message_ == nullptr) {
+    return 0;
+  }
+  return messageBytes(*message_, root_);
+}
+
+size_t SizeProfile::fieldBytes(const FieldPath &path) {
+  if (message_ == nullptr || path.empty()) {
+    return totalBytes();
+  }
+  const pb::Message *message = message_;
+  Node *node = &root_;
+  for (size_t position=0; position<path.size(); ++position) {
+    messageBytes(*message, *node);
+    const FieldPath::Element &element = path.at(position);
+    const pb::FieldDescriptor *fieldDescriptor = element.fieldDescriptor;
+    auto fieldBytesIt = node->fieldBytes.find(fieldDescriptor);
+    if (fieldBytesIt == node->fieldBytes.end()) {
+      // Not set
+      return 0;
+    }
+    const bool isMessage = (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE);
+    if (element.index == -1 && position+1 == path.size()) {
+      return fieldBytesIt->second;
+    }
+    if (!isMessage) {
+      return fieldBytesIt->second;
+    }
+    // Into a nested message, which messageBytes has already computed
+    const pb::Reflection *reflection = message->GetReflection();
+    const size_t childIndex = (element.index == -1 ? 0 : static_cast<size_t>(element.index));
+    const std::vector<std::unique_ptr<Node>> &children = node->children.at(fieldDescriptor);
+    if (childIndex >= children.size()) {
+      return 0;
+    }
+    message = (element.index == -1 ? &reflection->GetMessage(*message, fieldDescriptor) : &reflection->GetRepeatedMessage(*message, fieldDescriptor, element.index));
+    node = children[childIndex].get();
+    if (position+1 == path.size()) {
+      const size_t byteSize = messageBytes(*message, *node);
+      return messageElementOverhead(fieldDescriptor, byteSize) + byteSize;
+    }
+  }
+  return 0;
+}
+
+size_t SizeProfile::messageBytes(const pb::Message &message, Node &node) {
+  if (node.valid) {
+    return node.byteSize;
+  }
+  const pb::Reflection *reflection = message.GetReflection();
+  std::vector<const pb::FieldDescriptor*> fields;
+  reflection->ListFields(message, &fields);
+
+  node.fieldBytes.clear();
+  size_t total = 0;
+  for (const pb::FieldDescriptor *fieldDescriptor : fields) {
+    size_t bytes = 0;
+    if (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE) {
+      // Nested messages which haven't changed return their cached size straight away
+      std::vector<std::unique_ptr<Node>> &children = node.children[fieldDescriptor];
+      const int count = (fieldDescriptor->is_repeated() ? reflection->FieldSize(message, fieldDescriptor) : 1);
+      children.resize(count);
+      for (int index=0; index<count; ++index) {
+        if (children[index] == nullptr) {
+          children[index] = std::make_unique<Node>();
+        }
+        const pb::Message &nested = (fieldDescriptor->is_repeated() ? reflection->GetRepeatedMessage(message, fieldDescriptor, index) : reflection->GetMessage(message, fieldDescriptor));
+        const size_t byteSize = messageBytes(nested, *children[index]);
+        bytes += messageElementOverhead(fieldDescriptor, byteSize) + byteSize;
+      }
+    } else {
+      bytes = pb::internal::WireFormat::FieldByteSize(fieldDescriptor, message);
+    }
+    node.fieldBytes.emplace(fieldDescriptor, bytes);
+    total += bytes;
+  }
+  // Drop the nodes of nested messages which were cleared
+  for (auto it=node.children.begin(); it!=node.children.end();) {
+    if (node.fieldBytes.find(it->first) == node.fieldBytes.end()) {
+      it = node.children.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  total += pb::internal::WireFormat::ComputeUnknownFieldsSize(reflection->GetUnknownFields(message));
+
+  node.byteSize = total;
+  node.valid = true;
+  return total;
+}
+
+std::vector<FieldSize> SizeProfile::heaviestFields(size_t maxCount) {
+  std::vector<FieldSize> heap;
+  if (message_ == nullptr || maxCount == 0) {
+    return heap;
+  }
+  messageBytes(*message_, root_);
+  FieldPath prefix;
+  collectHeaviestFields(root_, prefix, maxCount, heap);
+  std::sort_heap(heap.begin(), heap.end(), largerField);
+  return heap;
+}
+
+void SizeProfile::collectHeaviestFields(const Node &node, FieldPath &prefix, size_t maxCount, std::vector<FieldSize> &heap) const {
+  for (const auto &[fieldDescriptor, bytes] : node.fieldBytes) {
+    // Only build the path of fields which make it into the heap
+    if (heap.size() < maxCount || bytes > heap.front().bytes) {
+      FieldSize fieldSize{prefix, bytes};
+      fieldSize.path.append(fieldDescriptor);
+      heap.push_back(std::move(fieldSize));
+      std::push_heap(heap.begin(), heap.end(), largerField);
+      if (heap.size() > maxCount) {
+        std::pop_heap(heap.begin(), heap.end(), largerField);
+        heap.pop_back();
+      }
+    }
+  }
+  for (const auto &[fieldDescriptor, children] : node.children) {
+    for (size_t index=0; index<children.size(); ++index) {
+      if (children[index] == nullptr) {
+        continue;
+      }
+      // A nested message is never larger than the field holding it, so if that didn't make it in, nothing below will
+      if (heap.size() >= maxCount && node.fieldBytes.at(fieldDescriptor) <= heap.front().bytes) {
+        break;
+      }
+      // FieldPath has no pop_back, so copy the prefix on the way down
+      FieldPath childPrefix = prefix;
+      childPrefix.append(fieldDescriptor, fieldDescriptor->is_repeated() ? static_cast<int>(index) : -1);
+      collectHeaviestFields(*children[index], childPrefix, maxCount, heap);
+    }
+  }
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
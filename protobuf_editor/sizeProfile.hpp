@@ -0,0 +1,57 @@
+#ifndef PROTOBUF_EDITOR_SIZE_PROFILE_HPP_
+#define PROTOBUF_EDITOR_SIZE_PROFILE_HPP_
+
+#include "fieldPath.hpp"
+
+#include <google/protobuf/message.h>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace protobuf_editor {
+
+struct FieldSize {
+  FieldPath path;
+  size_t bytes{0};
+};
+
+// Works out how many bytes each field contributes to a message's wire format encoding, including tags and length
+//  prefixes. The sizes of every nested message are computed once, bottom-up, and cached. After an edit, only the
+//  messages along the edited path are recomputed, and of those only their own fields are listed again, so keeping
+//  the sizes up to date while typing costs about as much as the depth of the edited field, not the message's size.
+// Sizes are computed as they're asked for.
+class SizeProfile {
+public:
+  // The message must outlive the profile, or be replaced first. Null to profile nothing.
+  void setMessage(const google::protobuf::Message *message);
+  // To be called with the paths of fields which changed, see ProtobufFieldWidget::fieldsChanged
+  void fieldsChanged(const std::vector<FieldPath> &paths);
+  // The size of the whole message, the same as its ByteSizeLong
+  size_t totalBytes();
+  // The bytes the field contributes to the message containing it, 0 if it isn't set. An element of a repeated
+  //  message field is the bytes of that element. An element of any other repeated field is the whole field.
+  size_t fieldBytes(const FieldPath &path);
+  // The largest fields anywhere in the message, largest first. Elements of repeated fields aren't listed themselves,
+  //  their fields are.
+  std::vector<FieldSize> heaviestFields(size_t maxCount);
+private:
+  struct Node {
+    bool valid{false};
+    // The size of the message, without the tag and length which precede it in its parent
+    size_t byteSize{0};
+    // Only the fields which are set
+    std::unordered_map<const google::protobuf::FieldDescriptor*, size_t> fieldBytes;
+    // The nodes of nested messages, one per element of repeated fields. Null until computed.
+    std::unordered_map<const google::protobuf::FieldDescriptor*, std::vector<std::unique_ptr<Node>>> children;
+  };
+  const google::protobuf::Message *message_{nullptr};
+  Node root_;
+  size_t messageBytes(const google::protobuf::Message &message, Node &node);
+  void invalidate(const FieldPath &path);
+  void collectHeaviestFields(const Node &node, FieldPath &prefix, size_t maxCount, std::vector<FieldSize> &heap) const;
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_SIZE_PROFILE_HPP_
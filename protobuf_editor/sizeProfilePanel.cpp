@@ -0,0 +1,85 @@
+#include "sizeProfilePanel.hpp"
+#include "sizeProfile.hpp"
+
+#include <QHeaderView>
+#include <QLocale>
+#include <QVBoxLayout>
+
+namespace {
+
+enum Column {
+  kFieldColumn = 0,
+  kBytesColumn,
+  kShareColumn,
+  kColumnCount
+};
+
+// Holds the index of the row's path
+constexpr int kPathIndexRole = Qt::UserRole;
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+SizeProfilePanel::SizeProfilePanel(QWidget *parent) : QWidget(parent) {
+  buildWidget();
+}
+
+void SizeProfilePanel::buildWidget() {
+  treeWidget_ = new QTreeWidget;
+  treeWidget_->setColumnCount(kColumnCount);
+  treeWidget_->setHeaderLabels({tr("Field"), tr("Bytes"), tr("Share (%)")});
+  treeWidget_->setRootIsDecorated(false);
+  treeWidget_->setUniformRowHeights(true);
+  treeWidget_->header()->setSectionResizeMode(kFieldColumn, QHeaderView::Stretch);
+  treeWidget_->setSortingEnabled(true);
+  treeWidget_->sortByColumn(kBytesColumn, Qt::DescendingOrder);
+  connect(treeWidget_, &QTreeWidget::itemActivated, [this](QTreeWidgetItem *item){
+    const size_t pathIndex = item->data(kFieldColumn, kPathIndexRole).toULongLong();
+    if (pathIndex < paths_.size()) {
+      emit fieldActivated(paths_[pathIndex]);
+    }
+  });
+
+  totalLabel_ = new QLabel;
+
+  QVBoxLayout *layout = new QVBoxLayout(this);
+  layout->setContentsMargins(0,0,0,0);
+  layout->addWidget(treeWidget_, 1);
+  layout->addWidget(totalLabel_);
+}
+
+void SizeProfilePanel::setSizeProfile(SizeProfile *sizeProfile) {
+  sizeProfile_ = sizeProfile;
+  refresh();
+}
+
+void SizeProfilePanel::refresh() {
+  // Inserting into a sorted view re-sorts on every row
+  treeWidget_->setSortingEnabled(false);
+  treeWidget_->clear();
+  paths_.clear();
+  if (sizeProfile_ == nullptr) {
+    totalLabel_->clear();
+    treeWidget_->setSortingEnabled(true);
+    return;
+  }
+
+  const size_t totalBytes = sizeProfile_->totalBytes();
+  for (FieldSize &fieldSize : sizeProfile_->heaviestFields(kMaxFields)) {
+    QTreeWidgetItem *item = new QTreeWidgetItem(treeWidget_);
+    item->setText(kFieldColumn, QString::fromStdString(fieldSize.path.toString()));
+    item->setData(kFieldColumn, kPathIndexRole, static_cast<qulonglong>(paths_.size()));
+    // Stored as numbers, so that they sort as numbers
+    item->setData(kBytesColumn, Qt::DisplayRole, static_cast<qulonglong>(fieldSize.bytes));
+    const double share = (totalBytes == 0 ? 0.0 : 100.0 * static_cast<double>(fieldSize.bytes) / static_cast<double>(totalBytes));
+    item->setData(kShareColumn, Qt::DisplayRole, qRound(share * 10.0) / 10.0);
+    item->setTextAlignment(kBytesColumn, Qt::AlignRight | Qt::AlignVCenter);
+    item->setTextAlignment(kShareColumn, Qt::AlignRight | Qt::AlignVCenter);
+    paths_.push_back(std::move(fieldSize.path));
+  }
+  treeWidget_->setSortingEnabled(true);
+  totalLabel_->setText(tr("Encoded size: %1").arg(locale().formattedDataSize(static_cast<qint64>(totalBytes))));
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef PROTOBUF_EDITOR_SIZE_PROFILE_PANEL_HPP_
+#define PROTOBUF_EDITOR_SIZE_PROFILE_PANEL_HPP_
+
+#include "fieldPath.hpp"
+
+#include <QLabel>
+#include <QTreeWidget>
+#include <QWidget>
+
+#include <vector>
+
+namespace protobuf_editor {
+
+class SizeProfile;
+
+// Lists the fields which take up the most bytes of the encoded message, anywhere in it, with their share of the
+//  whole. The list can be sorted by any column. Activating a row emits fieldActivated with the field's path.
+class SizeProfilePanel : public QWidget {
+  Q_OBJECT
+public:
+  static constexpr size_t kMaxFields = 100;
+
+  explicit SizeProfilePanel(QWidget *parent=nullptr);
+  // The profile must outlive the panel, or be replaced first. Null to show nothing.
+  void setSizeProfile(SizeProfile *sizeProfile);
+  // Reads the sizes again, after the profile's message changed
+  void refresh();
+private:
+  SizeProfile *sizeProfile_{nullptr};
+  // Parallel to the rows, which are tagged with their index here so that sorting doesn't lose track of them
+  std::vector<FieldPath> paths_;
+  QTreeWidget *treeWidget_{nullptr};
+  QLabel *totalLabel_{nullptr};
+  void buildWidget();
+signals:
+  void fieldActivated(const protobuf_editor::FieldPath &path);
+};
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_SIZE_PROFILE_PANEL_HPP_
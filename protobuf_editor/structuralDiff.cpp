@@ -0,0 +1,446 @@
+#include "structuralDiff.hpp"
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/unknown_field_set.h>
+#include <google/protobuf/util/field_comparator.h>
+#include <google/protobuf/util/message_differencer.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace pb = google::protobuf;
+
+namespace {
+
+using protobuf_editor::FieldDifference;
+using protobuf_editor::FieldPath;
+
+template<typename T>
+std::string bytesOf(T value) {
+  std::string bytes(sizeof(T), '\0');
+  std::memcpy(&bytes[0], &value, sizeof(T));
+  return bytes;
+}
+
+template<typename T>
+std::string floatingPointBytes(T value) {
+  // Values which compare equal must have the same bytes: every NaN is the same NaN, and -0 is 0
+  if (std::isnan(value)) {
+    value = std::numeric_limits<T>::quiet_NaN();
+  } else if (value == 0) {
+    value = 0;
+  }
+  return bytesOf(value);
+}
+
+// Two values are equal exactly when their keys are. Only used for scalars and for the key fields of alignByKey, whole
+//  elements are compared through their hashes instead. Messages are serialized deterministically, so that maps don't
+//  make equal messages look different.
+std::string elementKey(const pb::Message &message, const pb::FieldDescriptor *fieldDescriptor, int index) {
+  const pb::Reflection *reflection = message.GetReflection();
+  const bool repeated = (index != -1);
+  switch (fieldDescriptor->cpp_type()) {
+    case pb::FieldDescriptor::CppType::CPPTYPE_STRING:
+      return repeated ? reflection->GetRepeatedString(message, fieldDescriptor, index) : reflection->GetString(message, fieldDescriptor);
+    case pb::FieldDescriptor::CppType::CPPTYPE_FLOAT:
+      return floatingPointBytes(repeated ? reflection->GetRepeatedFloat(message, fieldDescriptor, index) : reflection->GetFloat(message, fieldDescriptor));
+    case pb::FieldDescriptor::CppType::CPPTYPE_DOUBLE:
+      return floatingPointBytes(repeated ? reflection->GetRepeatedDouble(message, fieldDescriptor, index) : reflection->GetDouble(message, fieldDescriptor));
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT32:
+      return bytesOf(repeated ? reflection->GetRepeatedInt32(message, fieldDescriptor, index) : reflection->GetInt32(message, fieldDescriptor));
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT32:
+      return bytesOf(repeated ? reflection->GetRepeatedUInt32(message, fieldDescriptor, index) : reflection->GetUInt32(message, fieldDescriptor));
+    case pb::FieldDescriptor::CppType::CPPTYPE_INT64:
+      return bytesOf(repeated ? reflection->GetRepeatedInt64(message, fieldDescriptor, index) : reflection->GetInt64(message, fieldDescriptor));
+    case pb::FieldDescriptor::CppType::CPPTYPE_UINT64:
+      return bytesOf(repeated ? reflection->GetRepeatedUInt64(message, fieldDescriptor, index) : reflection->GetUInt64(message, fieldDescriptor));
+    case pb::FieldDescriptor::CppType::CPPTYPE_BOOL:
+      return bytesOf(repeated ? reflection->GetRepeatedBool(message, fieldDescriptor, index) : reflection->GetBool(message, fieldDescriptor));
+    case pb::FieldDescriptor::CppType::CPPTYPE_ENUM:
+      return bytesOf(repeated ? reflection->GetRepeatedEnumValue(message, fieldDescriptor, index) : reflection->GetEnumValue(message, fieldDescriptor));
+    case pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE: {
+      const pb::Message &nested = repeated ? reflection->GetRepeatedMessage(message, fieldDescriptor, index) : reflection->GetMessage(message, fieldDescriptor);
+      std::string bytes;
+      {
+        pb::io::StringOutputStream stringStream(&bytes);
+        pb::io::CodedOutputStream codedStream(&stringStream);
+        codedStream.SetSerializationDeterministic(true);
+        nested.SerializePartialToCodedStream(&codedStream);
+      }
+      return bytes;
+    }
+  }
+  throw std::runtime_error("Unknown type of field \""+fieldDescriptor->full_name()+"\"");
+}
+
+uint64_t mixHash(uint64_t value) {
+  // The finalizer of splitmix64
+  value ^= value >> 30;
+  value *= 0xbf58476d1ce4e5b9ULL;
+  value ^= value >> 27;
+  value *= 0x94d049bb133111ebULL;
+  value ^= value >> 31;
+  return value;
+}
+
+uint64_t combineHash(uint64_t hash, uint64_t value) {
+  return mixHash(hash ^ (mixHash(value) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2)));
+}
+
+// The elements of a repeated field on both sides, numbered so that two elements have the same number exactly when
+//  they're equal. Aligning then only compares numbers.
+struct ElementClasses {
+  std::vector<uint32_t> lhs;
+  std::vector<uint32_t> rhs;
+
+  bool equal(int lhsIndex, int rhsIndex) const {
+    return lhs[lhsIndex] == rhs[rhsIndex];
+  }
+  int lhsSize() const {
+    return static_cast<int>(lhs.size());
+  }
+  int rhsSize() const {
+    return static_cast<int>(rhs.size());
+  }
+};
+
+class Differ {
+public:
+  Differ(const protobuf_editor::StructuralDiffOptions &options, std::vector<FieldDifference> &result) : options_(options), result_(result) {
+    for (const auto &[fieldDescriptor, keyField] : options_.keyFields) {
+      if (fieldDescriptor == nullptr || keyField == nullptr) {
+        throw std::runtime_error("Key fields for a structural diff can't be null");
+      }
+      if (!fieldDescriptor->is_repeated() || fieldDescriptor->cpp_type() != pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE) {
+        throw std::runtime_error("Elements of \""+fieldDescriptor->full_name()+"\" can't be matched by key, it is not a repeated message field");
+      }
+      if (keyField->containing_type() != fieldDescriptor->message_type() || keyField->is_repeated()) {
+        throw std::runtime_error("\""+keyField->full_name()+"\" can't be the key of \""+fieldDescriptor->full_name()+"\", it is not a singular field of "+fieldDescriptor->message_type()->full_name());
+      }
+    }
+    // Values which compare equal as keys are also equal here: every NaN is the same, and -0 is 0
+    fieldComparator_.set_treat_nan_as_equal(true);
+    differencer_.set_field_comparator(&fieldComparator_);
+  }
+
+  void diffMessages(const pb::Message &lhs, const pb::Message &rhs, const FieldPath &lhsPrefix, const FieldPath &rhsPrefix) {
+    // Only look at the fields which are present in at least one of the messages. Both lists are sorted by field number.
+    std::vector<const pb::FieldDescriptor*> lhsFields, rhsFields;
+    lhs.GetReflection()->ListFields(lhs, &lhsFields);
+    rhs.GetReflection()->ListFields(rhs, &rhsFields);
+    auto lhsIt = lhsFields.begin();
+    auto rhsIt = rhsFields.begin();
+    while (lhsIt != lhsFields.end() || rhsIt != rhsFields.end()) {
+      const pb::FieldDescriptor *fieldDescriptor;
+      if (rhsIt == rhsFields.end() || (lhsIt != lhsFields.end() && (*lhsIt)->number() < (*rhsIt)->number())) {
+        fieldDescriptor = *lhsIt++;
+      } else if (lhsIt == lhsFields.end() || (*rhsIt)->number() < (*lhsIt)->number()) {
+        fieldDescriptor = *rhsIt++;
+      } else {
+        fieldDescriptor = *lhsIt;
+        ++lhsIt;
+        ++rhsIt;
+      }
+      diffField(lhs, rhs, fieldDescriptor, lhsPrefix, rhsPrefix);
+    }
+  }
+
+private:
+  const protobuf_editor::StructuralDiffOptions &options_;
+  std::vector<FieldDifference> &result_;
+  // Computed bottom-up, once for every message in either tree
+  std::unordered_map<const pb::Message*, uint64_t> messageHashes_;
+  // Only confirms equality when hashes match, which mostly happens for elements which are equal
+  pb::util::DefaultFieldComparator fieldComparator_;
+  pb::util::MessageDifferencer differencer_;
+
+  uint64_t messageHash(const pb::Message &message) {
+    auto cached = messageHashes_.find(&message);
+    if (cached != messageHashes_.end()) {
+      return cached->second;
+    }
+    const pb::Reflection *reflection = message.GetReflection();
+    std::vector<const pb::FieldDescriptor*> fields;
+    reflection->ListFields(message, &fields);
+    uint64_t hash = 0;
+    for (const pb::FieldDescriptor *fieldDescriptor : fields) {
+      hash = combineHash(hash, static_cast<uint64_t>(fieldDescriptor->number()));
+      if (!fieldDescriptor->is_repeated()) {
+        hash = combineHash(hash, elementHash(message, fieldDescriptor, -1));
+        continue;
+      }
+      const int size = reflection->FieldSize(message, fieldDescriptor);
+      hash = combineHash(hash, static_cast<uint64_t>(size));
+      if (fieldDescriptor->is_map()) {
+        // The entries of equal maps can be in any order
+        uint64_t entriesHash = 0;
+        for (int index=0; index<size; ++index) {
+          entriesHash += mixHash(elementHash(message, fieldDescriptor, index));
+        }
+        hash = combineHash(hash, entriesHash);
+      } else {
+        for (int index=0; index<size; ++index) {
+          hash = combineHash(hash, elementHash(message, fieldDescriptor, index));
+        }
+      }
+    }
+    const pb::UnknownFieldSet &unknownFields = reflection->GetUnknownFields(message);
+    if (!unknownFields.empty()) {
+      std::string bytes;
+      unknownFields.SerializeToString(&bytes);
+      hash = combineHash(hash, std::hash<std::string>()(bytes));
+    }
+    messageHashes_.emplace(&message, hash);
+    return hash;
+  }
+
+  uint64_t elementHash(const pb::Message &message, const pb::FieldDescriptor *fieldDescriptor, int index) {
+    if (fieldDescriptor->cpp_type() != pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE) {
+      return std::hash<std::string>()(elementKey(message, fieldDescriptor, index));
+    }
+    const pb::Reflection *reflection = message.GetReflection();
+    return messageHash(index == -1 ? reflection->GetMessage(message, fieldDescriptor) : reflection->GetRepeatedMessage(message, fieldDescriptor, index));
+  }
+
+  bool elementsEqual(const pb::Message &lhs, int lhsIndex, const pb::Message &rhs, int rhsIndex, const pb::FieldDescriptor *fieldDescriptor) {
+    if (fieldDescriptor->cpp_type() != pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE) {
+      return elementKey(lhs, fieldDescriptor, lhsIndex) == elementKey(rhs, fieldDescriptor, rhsIndex);
+    }
+    return differencer_.Compare(lhs.GetReflection()->GetRepeatedMessage(lhs, fieldDescriptor, lhsIndex), rhs.GetReflection()->GetRepeatedMessage(rhs, fieldDescriptor, rhsIndex));
+  }
+
+  ElementClasses classifyElements(const pb::Message &lhs, const pb::Message &rhs, const pb::FieldDescriptor *fieldDescriptor) {
+    struct Representative {
+      const pb::Message *message;
+      int index;
+      uint32_t elementClass;
+    };
+    // The first element of each class, by hash. Every other element is compared with the ones which have the same
+    //  hash, usually one, and equal to it.
+    std::unordered_multimap<uint64_t, Representative> representatives;
+    uint32_t classCount = 0;
+    auto classOf = [&](const pb::Message &message, int index) {
+      const uint64_t hash = elementHash(message, fieldDescriptor, index);
+      auto [begin, end] = representatives.equal_range(hash);
+      for (auto it=begin; it!=end; ++it) {
+        if (elementsEqual(*it->second.message, it->second.index, message, index, fieldDescriptor)) {
+          return it->second.elementClass;
+        }
+      }
+      representatives.emplace(hash, Representative{&message, index, classCount});
+      return classCount++;
+    };
+    ElementClasses classes;
+    const int lhsSize = lhs.GetReflection()->FieldSize(lhs, fieldDescriptor);
+    const int rhsSize = rhs.GetReflection()->FieldSize(rhs, fieldDescriptor);
+    classes.lhs.reserve(lhsSize);
+    classes.rhs.reserve(rhsSize);
+    for (int index=0; index<lhsSize; ++index) {
+      classes.lhs.push_back(classOf(lhs, index));
+    }
+    for (int index=0; index<rhsSize; ++index) {
+      classes.rhs.push_back(classOf(rhs, index));
+    }
+    return classes;
+  }
+
+  void report(FieldDifference::Kind kind, const FieldPath &lhsPrefix, int lhsIndex, const FieldPath &rhsPrefix, int rhsIndex, const pb::FieldDescriptor *fieldDescriptor) {
+    FieldDifference difference;
+    difference.kind = kind;
+    difference.lhsPath = lhsPrefix;
+    difference.lhsPath.append(fieldDescriptor, lhsIndex);
+    difference.rhsPath = rhsPrefix;
+    difference.rhsPath.append(fieldDescriptor, rhsIndex);
+    result_.push_back(std::move(difference));
+  }
+
+  void diffField(const pb::Message &lhs, const pb::Message &rhs, const pb::FieldDescriptor *fieldDescriptor, const FieldPath &lhsPrefix, const FieldPath &rhsPrefix) {
+    const bool isMessage = (fieldDescriptor->cpp_type() == pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE);
+    if (fieldDescriptor->is_repeated()) {
+      diffRepeatedField(lhs, rhs, fieldDescriptor, lhsPrefix, rhsPrefix);
+      return;
+    }
+    const bool lhsHasField = !fieldDescriptor->has_presence() || lhs.GetReflection()->HasField(lhs, fieldDescriptor);
+    const bool rhsHasField = !fieldDescriptor->has_presence() || rhs.GetReflection()->HasField(rhs, fieldDescriptor);
+    if (lhsHasField != rhsHasField) {
+      // Set on one side only, the whole field differs
+      report(FieldDifference::Kind::kChanged, lhsPrefix, -1, rhsPrefix, -1, fieldDescriptor);
+      return;
+    }
+    if (isMessage) {
+      FieldPath lhsNestedPrefix = lhsPrefix;
+      lhsNestedPrefix.append(fieldDescriptor);
+      FieldPath rhsNestedPrefix = rhsPrefix;
+      rhsNestedPrefix.append(fieldDescriptor);
+      diffMessages(lhs.GetReflection()->GetMessage(lhs, fieldDescriptor), rhs.GetReflection()->GetMessage(rhs, fieldDescriptor), lhsNestedPrefix, rhsNestedPrefix);
+      return;
+    }
+    if (elementKey(lhs, fieldDescriptor, -1) != elementKey(rhs, fieldDescriptor, -1)) {
+      report(FieldDifference::Kind::kChanged, lhsPrefix, -1, rhsPrefix, -1, fieldDescriptor);
+    }
+  }
+
+  // Two elements which were aligned with each other, but aren't necessarily equal
+  void diffElements(const pb::Message &lhs, int lhsIndex, const pb::Message &rhs, int rhsIndex, const pb::FieldDescriptor *fieldDescriptor, const FieldPath &lhsPrefix, const FieldPath &rhsPrefix) {
+    if (fieldDescriptor->cpp_type() != pb::FieldDescriptor::CppType::CPPTYPE_MESSAGE) {
+      report(FieldDifference::Kind::kChanged, lhsPrefix, lhsIndex, rhsPrefix, rhsIndex, fieldDescriptor);
+      return;
+    }
+    FieldPath lhsElementPrefix = lhsPrefix;
+    lhsElementPrefix.append(fieldDescriptor, lhsIndex);
+    FieldPath rhsElementPrefix = rhsPrefix;
+    rhsElementPrefix.append(fieldDescriptor, rhsIndex);
+    const size_t differenceCount = result_.size();
+    diffMessages(lhs.GetReflection()->GetRepeatedMessage(lhs, fieldDescriptor, lhsIndex), rhs.GetReflection()->GetRepeatedMessage(rhs, fieldDescriptor, rhsIndex), lhsElementPrefix, rhsElementPrefix);
+    if (result_.size() == differenceCount) {
+      // The elements differ but no field does, e.g. unknown fields. Still show that something's different.
+      report(FieldDifference::Kind::kChanged, lhsPrefix, lhsIndex, rhsPrefix, rhsIndex, fieldDescriptor);
+    }
+  }
+
+  void diffRepeatedField(const pb::Message &lhs, const pb::Message &rhs, const pb::FieldDescriptor *fieldDescriptor, const FieldPath &lhsPrefix, const FieldPath &rhsPrefix) {
+    const pb::FieldDescriptor *keyField = nullptr;
+    if (fieldDescriptor->is_map()) {
+      keyField = fieldDescriptor->message_type()->map_key();
+    } else {
+      auto keyFieldIt = options_.keyFields.find(fieldDescriptor);
+      if (keyFieldIt != options_.keyFields.end()) {
+        keyField = keyFieldIt->second;
+      }
+    }
+
+    const ElementClasses classes = classifyElements(lhs, rhs, fieldDescriptor);
+    if (keyField != nullptr) {
+      alignByKey(lhs, rhs, fieldDescriptor, keyField, classes, lhsPrefix, rhsPrefix);
+      return;
+    }
+
+    // Most edits leave the ends alone, and these are matched in linear time
+    int begin = 0;
+    while (begin < classes.lhsSize() && begin < classes.rhsSize() && classes.equal(begin, begin)) {
+      ++begin;
+    }
+    int lhsEnd = classes.lhsSize();
+    int rhsEnd = classes.rhsSize();
+    while (lhsEnd > begin && rhsEnd > begin && classes.equal(lhsEnd-1, rhsEnd-1)) {
+      --lhsEnd;
+      --rhsEnd;
+    }
+    const size_t cellCount = static_cast<size_t>(lhsEnd-begin) * static_cast<size_t>(rhsEnd-begin);
+    if (cellCount > options_.lcsCellLimit) {
+      alignByPosition(lhs, rhs, fieldDescriptor, classes, begin, lhsEnd, rhsEnd, lhsPrefix, rhsPrefix);
+    } else {
+      alignByLcs(lhs, rhs, fieldDescriptor, classes, begin, lhsEnd, rhsEnd, lhsPrefix, rhsPrefix);
+    }
+  }
+
+  void alignByKey(const pb::Message &lhs, const pb::Message &rhs, const pb::FieldDescriptor *fieldDescriptor, const pb::FieldDescriptor *keyField, const ElementClasses &classes, const FieldPath &lhsPrefix, const FieldPath &rhsPrefix) {
+    const pb::Reflection *lhsReflection = lhs.GetReflection();
+    const pb::Reflection *rhsReflection = rhs.GetReflection();
+    // If a key appears more than once, the first element with it is the one which is matched
+    std::unordered_map<std::string, int> rhsIndexByKey;
+    for (int rhsIndex=classes.rhsSize()-1; rhsIndex>=0; --rhsIndex) {
+      rhsIndexByKey[elementKey(rhsReflection->GetRepeatedMessage(rhs, fieldDescriptor, rhsIndex), keyField, -1)] = rhsIndex;
+    }
+    std::vector<bool> rhsMatched(classes.rhsSize(), false);
+    for (int lhsIndex=0; lhsIndex<classes.lhsSize(); ++lhsIndex) {
+      auto match = rhsIndexByKey.find(elementKey(lhsReflection->GetRepeatedMessage(lhs, fieldDescriptor, lhsIndex), keyField, -1));
+      if (match == rhsIndexByKey.end() || rhsMatched.at(match->second)) {
+        report(FieldDifference::Kind::kRemoved, lhsPrefix, lhsIndex, rhsPrefix, -1, fieldDescriptor);
+        continue;
+      }
+      const int rhsIndex = match->second;
+      rhsMatched.at(rhsIndex) = true;
+      if (!classes.equal(lhsIndex, rhsIndex)) {
+        diffElements(lhs, lhsIndex, rhs, rhsIndex, fieldDescriptor, lhsPrefix, rhsPrefix);
+      }
+    }
+    for (int rhsIndex=0; rhsIndex<classes.rhsSize(); ++rhsIndex) {
+      if (!rhsMatched.at(rhsIndex)) {
+        report(FieldDifference::Kind::kAdded, lhsPrefix, -1, rhsPrefix, rhsIndex, fieldDescriptor);
+      }
+    }
+  }
+
+  void alignByPosition(const pb::Message &lhs, const pb::Message &rhs, const pb::FieldDescriptor *fieldDescriptor, const ElementClasses &classes, int begin, int lhsEnd, int rhsEnd, const FieldPath &lhsPrefix, const FieldPath &rhsPrefix) {
+    reportRun(lhs, rhs, fieldDescriptor, classes, begin, lhsEnd, begin, rhsEnd, lhsPrefix, rhsPrefix);
+  }
+
+  void alignByLcs(const pb::Message &lhs, const pb::Message &rhs, const pb::FieldDescriptor *fieldDescriptor, const ElementClasses &classes, int begin, int lhsEnd, int rhsEnd, const FieldPath &lhsPrefix, const FieldPath &rhsPrefix) {
+    const int lhsCount = lhsEnd-begin;
+    const int rhsCount = rhsEnd-begin;
+    if (lhsCount == 0 || rhsCount == 0) {
+      reportRun(lhs, rhs, fieldDescriptor, classes, begin, lhsEnd, begin, rhsEnd, lhsPrefix, rhsPrefix);
+      return;
+    }
+    // lengths[i][j] is the length of the LCS of the elements from begin+i and begin+j onwards
+    const int width = rhsCount+1;
+    std::vector<uint32_t> lengths(static_cast<size_t>(lhsCount+1) * width, 0);
+    for (int i=lhsCount-1; i>=0; --i) {
+      for (int j=rhsCount-1; j>=0; --j) {
+        uint32_t &length = lengths[static_cast<size_t>(i)*width + j];
+        if (classes.equal(begin+i, begin+j)) {
+          length = lengths[static_cast<size_t>(i+1)*width + j+1] + 1;
+        } else {
+          length = std::max(lengths[static_cast<size_t>(i+1)*width + j], lengths[static_cast<size_t>(i)*width + j+1]);
+        }
+      }
+    }
+    // Walk the common elements, the runs in between are what changed
+    int i = 0, j = 0;
+    int runLhsBegin = 0, runRhsBegin = 0;
+    while (i < lhsCount && j < rhsCount) {
+      if (classes.equal(begin+i, begin+j)) {
+        reportRun(lhs, rhs, fieldDescriptor, classes, begin+runLhsBegin, begin+i, begin+runRhsBegin, begin+j, lhsPrefix, rhsPrefix);
+        ++i;
+        ++j;
+        runLhsBegin = i;
+        runRhsBegin = j;
+      } else if (lengths[static_cast<size_t>(i+1)*width + j] >= lengths[static_cast<size_t>(i)*width + j+1]) {
+        ++i;
+      } else {
+        ++j;
+      }
+    }
+    reportRun(lhs, rhs, fieldDescriptor, classes, begin+runLhsBegin, lhsEnd, begin+runRhsBegin, rhsEnd, lhsPrefix, rhsPrefix);
+  }
+
+  // Elements [lhsBegin, lhsEnd) were replaced by [rhsBegin, rhsEnd). As many as there are on both sides are compared
+  //  in pairs, since that's usually an element which was edited, and the rest were removed or added.
+  void reportRun(const pb::Message &lhs, const pb::Message &rhs, const pb::FieldDescriptor *fieldDescriptor, const ElementClasses &classes, int lhsBegin, int lhsEnd, int rhsBegin, int rhsEnd, const FieldPath &lhsPrefix, const FieldPath &rhsPrefix) {
+    const int pairCount = std::min(lhsEnd-lhsBegin, rhsEnd-rhsBegin);
+    for (int offset=0; offset<pairCount; ++offset) {
+      if (!classes.equal(lhsBegin+offset, rhsBegin+offset)) {
+        diffElements(lhs, lhsBegin+offset, rhs, rhsBegin+offset, fieldDescriptor, lhsPrefix, rhsPrefix);
+      }
+    }
+    for (int lhsIndex=lhsBegin+pairCount; lhsIndex<lhsEnd; ++lhsIndex) {
+      report(FieldDifference::Kind::kRemoved, lhsPrefix, lhsIndex, rhsPrefix, -1, fieldDescriptor);
+    }
+    for (int rhsIndex=rhsBegin+pairCount; rhsIndex<rhsEnd; ++rhsIndex) {
+      report(FieldDifference::Kind::kAdded, lhsPrefix, -1, rhsPrefix, rhsIndex, fieldDescriptor);
+    }
+  }
+};
+
+} // anonymous namespace
+
+namespace protobuf_editor {
+
+std::vector<FieldDifference> structuralDiff(const pb::Message &lhs, const pb::Message &rhs, const StructuralDiffOptions &options) {
+  if (lhs.GetDescriptor() != rhs.GetDescriptor()) {
+    throw std::runtime_error("Cannot diff messages of different types");
+  }
+  std::vector<FieldDifference> result;
+  Differ(options, result).diffMessages(lhs, rhs, FieldPath(), FieldPath());
+  return result;
+}
+
+} // namespace protobuf_editor
\ No newline at end of file
@@ -0,0 +1,49 @@
+#ifndef PROTOBUF_EDITOR_STRUCTURAL_DIFF_HPP_
+#define PROTOBUF_EDITOR_STRUCTURAL_DIFF_HPP_
+
+#include "fieldPath.hpp"
+
+#include <google/protobuf/message.h>
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace protobuf_editor {
+
+struct StructuralDiffOptions {
+  // Repeated message fields whose elements are matched up by the value of one of their fields, e.g. an id, rather
+  //  than by position. Map fields are always matched by their key. The key must be a singular field of the element
+  //  type, otherwise structuralDiff throws.
+  std::unordered_map<const google::protobuf::FieldDescriptor*, const google::protobuf::FieldDescriptor*> keyFields;
+  // Other repeated fields are aligned with a longest common subsequence, so that an element inserted near the front
+  //  doesn't make every element after it differ. Past this many pairs of elements (the size of one side times the
+  //  size of the other, after removing the common prefix and suffix), elements are matched by position instead.
+  size_t lcsCellLimit{4000000};
+};
+
+struct FieldDifference {
+  enum class Kind {
+    // The field, or element, is on both sides with different values
+    kChanged,
+    // An element which is only on the right
+    kAdded,
+    // An element which is only on the left
+    kRemoved
+  };
+  Kind kind{Kind::kChanged};
+  // Where the field is in each message. An element may be at a different index on each side. On the side which
+  //  doesn't have the element, the path names the repeated field itself.
+  FieldPath lhsPath;
+  FieldPath rhsPath;
+};
+
+// Compares two messages of the same type, and returns the smallest fields which differ, in the order of their field
+//  numbers. Unlike diffMessages, the elements of repeated fields are aligned first, so that inserting or removing
+//  one element only reports that element. Nested messages, including the elements which were aligned with each
+//  other, are compared field by field.
+std::vector<FieldDifference> structuralDiff(const google::protobuf::Message &lhs, const google::protobuf::Message &rhs, const StructuralDiffOptions &options=StructuralDiffOptions());
+
+} // namespace protobuf_editor
+
+#endif // PROTOBUF_EDITOR_STRUCTURAL_DIFF_HPP_